@@ -29,15 +29,33 @@
 #define SAVE_EXTENSION_TAG "save_extension"
 #define SAVE_FREQ_TAG "save_freq"
 #define CHECKPOINT_FREQ_TAG "checkpoint_freq"
+#define SAVE_HYPER_TAG "save_hyper"
 #define VERBOSE_TAG "verbose"
 #define BURNING_TAG "burnin"
 #define NSAMPLES_TAG "nsamples"
+#define AUTO_BURNIN_TAG "auto_burnin"
+#define MAX_RHAT_TAG "max_rhat"
+#define TARGET_ESS_TAG "target_ess"
+#define COARSE_BURNIN_TAG "coarse_burnin"
+#define COARSE_FRACTION_TAG "coarse_fraction"
 #define NUM_LATENT_TAG "num_latent"
 #define NUM_THREADS_TAG "num_threads"
+#define NUM_CHAINS_TAG "num_chains"
+#define CV_FOLDS_TAG "cv_folds"
+#define WARM_START_TAG "warm_start"
+#define PIPELINE_TAG "pipeline"
+#define PIPELINE_THREADS_TAG "pipeline_threads"
+#define PRUNE_LATENTS_TAG "prune_latents"
+#define DATA_PARALLEL_TAG "data_parallel"
 #define RANDOM_SEED_SET_TAG "random_seed_set"
 #define RANDOM_SEED_TAG "random_seed"
 #define CSV_STATUS_TAG "csv_status"
 #define INIT_MODEL_TAG "init_model"
+#define ALS_SWEEPS_TAG "als_sweeps"
+#define ALS_REG_TAG "als_reg"
+#define SAMPLER_TAG "sampler"
+#define SGLD_BATCH_SIZE_TAG "sgld_batch_size"
+#define SGLD_STEP_TAG "sgld_step"
 #define CLASSIFY_TAG "classify"
 #define THRESHOLD_TAG "threshold"
 
@@ -92,6 +110,8 @@ ModelInitTypes smurff::stringToModelInitType(std::string name)
       return ModelInitTypes::random;
    else if (name == MODEL_INIT_NAME_ZERO)
       return ModelInitTypes::zero;
+   else if (name == MODEL_INIT_NAME_ALS)
+      return ModelInitTypes::als;
    else
    {
       THROWERROR("Invalid model init type " + name);
@@ -106,6 +126,8 @@ std::string smurff::modelInitTypeToString(ModelInitTypes type)
          return MODEL_INIT_NAME_RANDOM;
       case ModelInitTypes::zero:
          return MODEL_INIT_NAME_ZERO;
+      case ModelInitTypes::als:
+         return MODEL_INIT_NAME_ALS;
       default:
       {
          THROWERROR("Invalid model init type");
@@ -113,12 +135,51 @@ std::string smurff::modelInitTypeToString(ModelInitTypes type)
    }
 }
 
+SamplerTypes smurff::stringToSamplerType(std::string name)
+{
+   if(name == SAMPLER_NAME_GIBBS)
+      return SamplerTypes::gibbs;
+   else if (name == SAMPLER_NAME_SGLD)
+      return SamplerTypes::sgld;
+   else
+   {
+      THROWERROR("Invalid sampler type " + name);
+   }
+}
+
+std::string smurff::samplerTypeToString(SamplerTypes type)
+{
+   switch(type)
+   {
+      case SamplerTypes::gibbs:
+         return SAMPLER_NAME_GIBBS;
+      case SamplerTypes::sgld:
+         return SAMPLER_NAME_SGLD;
+      default:
+      {
+         THROWERROR("Invalid sampler type");
+      }
+   }
+}
+
 //config
 int Config::BURNIN_DEFAULT_VALUE = 200;
 int Config::NSAMPLES_DEFAULT_VALUE = 800;
 int Config::NUM_LATENT_DEFAULT_VALUE = 96;
 int Config::NUM_THREADS_DEFAULT_VALUE = 0; // as many as you want
+int Config::PIPELINE_THREADS_DEFAULT_VALUE = 0; // half of the threads
+int Config::NUM_CHAINS_DEFAULT_VALUE = 1;
+int Config::CV_FOLDS_DEFAULT_VALUE = 0;
+double Config::MAX_RHAT_DEFAULT_VALUE = 1.05;
+double Config::TARGET_ESS_DEFAULT_VALUE = 0.0;
+int Config::COARSE_BURNIN_DEFAULT_VALUE = 0;
+double Config::COARSE_FRACTION_DEFAULT_VALUE = 0.1;
 ModelInitTypes Config::INIT_MODEL_DEFAULT_VALUE = ModelInitTypes::zero;
+int Config::ALS_SWEEPS_DEFAULT_VALUE = 5;
+double Config::ALS_REG_DEFAULT_VALUE = 10.0; // same as the initial Lambda of NormalPrior
+SamplerTypes Config::SAMPLER_DEFAULT_VALUE = SamplerTypes::gibbs;
+int Config::SGLD_BATCH_SIZE_DEFAULT_VALUE = 32;
+double Config::SGLD_STEP_DEFAULT_VALUE = 0.5;
 const char* Config::SAVE_PREFIX_DEFAULT_VALUE = "save";
 const char* Config::SAVE_EXTENSION_DEFAULT_VALUE = ".ddm";
 int Config::SAVE_FREQ_DEFAULT_VALUE = 0;
@@ -132,11 +193,18 @@ int Config::RANDOM_SEED_DEFAULT_VALUE = 0;
 Config::Config()
 {
    m_model_init_type = Config::INIT_MODEL_DEFAULT_VALUE;
+   m_als_sweeps = Config::ALS_SWEEPS_DEFAULT_VALUE;
+   m_als_reg = Config::ALS_REG_DEFAULT_VALUE;
+
+   m_sampler_type = Config::SAMPLER_DEFAULT_VALUE;
+   m_sgld_batch_size = Config::SGLD_BATCH_SIZE_DEFAULT_VALUE;
+   m_sgld_step = Config::SGLD_STEP_DEFAULT_VALUE;
 
    m_save_prefix = Config::SAVE_PREFIX_DEFAULT_VALUE;
    m_save_extension = Config::SAVE_EXTENSION_DEFAULT_VALUE;
    m_save_freq = Config::SAVE_FREQ_DEFAULT_VALUE;
    m_checkpoint_freq = Config::CHECKPOINT_FREQ_DEFAULT_VALUE;
+   m_save_hyper = false;
 
    m_random_seed_set = false;
    m_random_seed = Config::RANDOM_SEED_DEFAULT_VALUE;
@@ -145,8 +213,19 @@ Config::Config()
    m_csv_status = Config::STATUS_DEFAULT_VALUE;
    m_burnin = Config::BURNIN_DEFAULT_VALUE;
    m_nsamples = Config::NSAMPLES_DEFAULT_VALUE;
+   m_auto_burnin = false;
+   m_max_rhat = Config::MAX_RHAT_DEFAULT_VALUE;
+   m_target_ess = Config::TARGET_ESS_DEFAULT_VALUE;
+   m_coarse_burnin = Config::COARSE_BURNIN_DEFAULT_VALUE;
+   m_coarse_fraction = Config::COARSE_FRACTION_DEFAULT_VALUE;
    m_num_latent = Config::NUM_LATENT_DEFAULT_VALUE;
    m_num_threads = Config::NUM_THREADS_DEFAULT_VALUE;
+   m_num_chains = Config::NUM_CHAINS_DEFAULT_VALUE;
+   m_cv_folds = Config::CV_FOLDS_DEFAULT_VALUE;
+   m_pipeline = false;
+   m_pipeline_threads = Config::PIPELINE_THREADS_DEFAULT_VALUE;
+   m_prune_latents = false;
+   m_data_parallel = false;
 
    m_threshold = Config::THRESHOLD_DEFAULT_VALUE;
    m_classify = false;
@@ -202,6 +281,93 @@ bool Config::validate() const
       THROWERROR("Train and test data should have the same dimensions");
    }
 
+   if (m_pipeline_threads < 0)
+   {
+      THROWERROR("Number of pipeline threads should not be negative");
+   }
+
+   if (m_pipeline && m_data_parallel)
+   {
+      THROWERROR("Pipelined prior updates do not support data-parallel sampling");
+   }
+
+   if (m_num_chains < 1)
+   {
+      THROWERROR("Number of chains should be at least 1");
+   }
+
+   if (m_num_chains > 1 && (m_checkpoint_freq || m_data_parallel))
+   {
+      THROWERROR("Multiple chains do not support checkpointing or data-parallel sampling");
+   }
+
+   if (m_cv_folds < 0 || m_cv_folds == 1 || m_cv_folds > 255)
+   {
+      THROWERROR("Number of cross-validation folds should be between 2 and 255");
+   }
+
+   if (m_cv_folds)
+   {
+      if (m_test)
+         THROWERROR("Cross-validation holds out its own test data, do not set a test matrix");
+
+      if (m_num_chains > 1 || m_save_freq || m_checkpoint_freq || m_data_parallel)
+         THROWERROR("Cross-validation does not support multiple chains, saving or data-parallel sampling");
+
+      if (m_train->getNModes() != 2 || !m_auxData.empty())
+         THROWERROR("Cross-validation is only supported for a single train matrix");
+
+      if (m_train->isDense() || !m_train->isScarce())
+         THROWERROR("Cross-validation needs a sparse train matrix with missing values (scarce)");
+   }
+
+   if (m_max_rhat <= 1.0 || m_target_ess < 0.0)
+   {
+      THROWERROR("Maximal split-Rhat should be above 1 and the target ESS should not be negative");
+   }
+
+   if ((m_auto_burnin || m_target_ess > 0.0) && (m_checkpoint_freq || m_cv_folds))
+   {
+      THROWERROR("Automatic burnin and target ESS do not support checkpointing or cross-validation");
+   }
+
+   if (m_coarse_burnin < 0 || m_coarse_burnin > m_burnin || m_coarse_fraction <= 0.0 || m_coarse_fraction > 1.0)
+   {
+      THROWERROR("Coarse burnin should be between 0 and burnin iterations, on a fraction in (0, 1] of the train data");
+   }
+
+   if (m_coarse_burnin)
+   {
+      if (m_train->getNModes() != 2 || !m_auxData.empty() || m_train->isDense() || !m_train->isScarce())
+         THROWERROR("Coarse burnin is only supported for a single sparse train matrix with missing values (scarce)");
+
+      if (m_cv_folds || m_data_parallel)
+         THROWERROR("Coarse burnin does not support cross-validation or data-parallel sampling");
+   }
+
+   if (m_sampler_type == SamplerTypes::sgld)
+   {
+      if (m_sgld_batch_size < 1 || m_sgld_step <= 0.0 || m_sgld_step > 1.0)
+         THROWERROR("SGLD needs a minibatch of at least one entry and a step size in (0, 1]");
+
+      if (m_train->getNModes() != 2 || !m_auxData.empty() || m_train->isDense() || !m_train->isScarce())
+         THROWERROR("SGLD is only supported for a single sparse train matrix with missing values (scarce)");
+
+      if (m_cv_folds || m_coarse_burnin || m_data_parallel || m_pipeline)
+         THROWERROR("SGLD does not support cross-validation, coarse burnin, data-parallel or pipelined sampling");
+
+      for (auto pt : m_prior_types)
+      {
+         if (pt != PriorTypes::normal && pt != PriorTypes::normalone && pt != PriorTypes::default_prior)
+            THROWERROR("SGLD only supports the normal and normalone priors, not " + priorTypeToString(pt));
+      }
+   }
+
+   if (m_model_init_type == ModelInitTypes::als && (m_als_sweeps < 1 || m_als_reg <= 0.0))
+   {
+      THROWERROR("ALS init needs at least one sweep and a positive regularization");
+   }
+
    if(getPriorTypes().size() != m_train->getNModes())
    {
       THROWERROR("Number of priors should equal to number of dimensions in train data");
@@ -230,12 +396,58 @@ bool Config::validate() const
           const auto& sideInfo = configItem->getSideInfo();
           THROWERROR_ASSERT(sideInfo);
 
-          if (sideInfo->getDims()[0] != m_train->getDims()[mode])
+          // a row-partitioned side info may only hold the rows of this process
+          if (configItem->getNRow() != m_train->getDims()[mode])
           {
               std::stringstream ss;
               ss << "Side info should have the same number of rows as size of dimension " << mode << " in train data";
               THROWERROR(ss.str());
           }
+
+          if (configItem->getHashBuckets() < 0)
+              THROWERROR("Number of hash buckets for side info can not be negative");
+
+          if (configItem->getHashBuckets() > 0)
+          {
+              if (sideInfo->isDense())
+                  THROWERROR("Feature hashing is only supported for sparse side info");
+
+              if (configItem->getCompressed() || configItem->getBitPacked())
+                  THROWERROR("Hashed side info has signed values and can not be compressed or bit-packed");
+          }
+
+          if (configItem->getProjectionRank() < 0)
+              THROWERROR("Projection rank for side info can not be negative");
+
+          if (configItem->getProjectionRank() > 0)
+          {
+              if (!sideInfo->isDense() || configItems.size() != 1)
+                  THROWERROR("Low-rank projection is only supported for a single dense side info");
+
+              if (getPriorTypes().at(mode) == PriorTypes::macauone)
+                  THROWERROR("Low-rank projection is not supported by the macauone prior");
+          }
+
+          if (configItem->getSinglePrecision())
+          {
+              if (!sideInfo->isDense() || configItem->getBitPacked())
+                  THROWERROR("Single precision is only supported for dense side info");
+
+              if (configItem->getProjectionRank() > 0)
+                  THROWERROR("Low-rank projection of single precision side info is not supported");
+          }
+
+          if (configItem->getPartitionRows())
+          {
+              if (configItems.size() != 1 || getPriorTypes().at(mode) != PriorTypes::macau)
+                  THROWERROR("Row-partitioned side info is only supported for a single side info of a macau prior");
+
+              if (configItem->getProjectionRank() > 0 || configItem->getAutotune())
+                  THROWERROR("Row-partitioned side info only supports the BlockCG solver without projection");
+
+              if (getDataParallel())
+                  THROWERROR("Row-partitioned side info can not be combined with data-parallel sampling");
+          }
       }
    }
 
@@ -297,6 +509,7 @@ bool Config::validate() const
          case PriorTypes::spikeandslab:
          case PriorTypes::default_prior:
             THROWERROR_ASSERT_MSG(!hasSideInfo(i), priorTypeToString(pt) + " prior in dimension " + std::to_string(i) + " cannot have side info");
+            THROWERROR_ASSERT_MSG(pt != PriorTypes::spikeandslab || !getDataParallel(), "spikeandslab prior does not support data-parallel sampling");
             break;
          case PriorTypes::macau:
          case PriorTypes::macauone:
@@ -356,18 +569,36 @@ void Config::save(std::string fname) const
    ini.appendItem(GLOBAL_SECTION_TAG, SAVE_EXTENSION_TAG, m_save_extension);
    ini.appendItem(GLOBAL_SECTION_TAG, SAVE_FREQ_TAG, std::to_string(m_save_freq));
    ini.appendItem(GLOBAL_SECTION_TAG, CHECKPOINT_FREQ_TAG, std::to_string(m_checkpoint_freq));
+   ini.appendItem(GLOBAL_SECTION_TAG, SAVE_HYPER_TAG, std::to_string(m_save_hyper));
 
    //general data
    ini.appendComment("general");
    ini.appendItem(GLOBAL_SECTION_TAG, VERBOSE_TAG, std::to_string(m_verbose));
    ini.appendItem(GLOBAL_SECTION_TAG, BURNING_TAG, std::to_string(m_burnin));
    ini.appendItem(GLOBAL_SECTION_TAG, NSAMPLES_TAG, std::to_string(m_nsamples));
+   ini.appendItem(GLOBAL_SECTION_TAG, AUTO_BURNIN_TAG, std::to_string(m_auto_burnin));
+   ini.appendItem(GLOBAL_SECTION_TAG, MAX_RHAT_TAG, std::to_string(m_max_rhat));
+   ini.appendItem(GLOBAL_SECTION_TAG, TARGET_ESS_TAG, std::to_string(m_target_ess));
+   ini.appendItem(GLOBAL_SECTION_TAG, COARSE_BURNIN_TAG, std::to_string(m_coarse_burnin));
+   ini.appendItem(GLOBAL_SECTION_TAG, COARSE_FRACTION_TAG, std::to_string(m_coarse_fraction));
    ini.appendItem(GLOBAL_SECTION_TAG, NUM_LATENT_TAG, std::to_string(m_num_latent));
    ini.appendItem(GLOBAL_SECTION_TAG, NUM_THREADS_TAG, std::to_string(m_num_threads));
+   ini.appendItem(GLOBAL_SECTION_TAG, NUM_CHAINS_TAG, std::to_string(m_num_chains));
+   ini.appendItem(GLOBAL_SECTION_TAG, CV_FOLDS_TAG, std::to_string(m_cv_folds));
+   ini.appendItem(GLOBAL_SECTION_TAG, WARM_START_TAG, m_warm_start);
+   ini.appendItem(GLOBAL_SECTION_TAG, PIPELINE_TAG, std::to_string(m_pipeline));
+   ini.appendItem(GLOBAL_SECTION_TAG, PIPELINE_THREADS_TAG, std::to_string(m_pipeline_threads));
+   ini.appendItem(GLOBAL_SECTION_TAG, PRUNE_LATENTS_TAG, std::to_string(m_prune_latents));
+   ini.appendItem(GLOBAL_SECTION_TAG, DATA_PARALLEL_TAG, std::to_string(m_data_parallel));
    ini.appendItem(GLOBAL_SECTION_TAG, RANDOM_SEED_SET_TAG, std::to_string(m_random_seed_set));
    ini.appendItem(GLOBAL_SECTION_TAG, RANDOM_SEED_TAG, std::to_string(m_random_seed));
    ini.appendItem(GLOBAL_SECTION_TAG, CSV_STATUS_TAG, m_csv_status);
    ini.appendItem(GLOBAL_SECTION_TAG, INIT_MODEL_TAG, modelInitTypeToString(m_model_init_type));
+   ini.appendItem(GLOBAL_SECTION_TAG, ALS_SWEEPS_TAG, std::to_string(m_als_sweeps));
+   ini.appendItem(GLOBAL_SECTION_TAG, ALS_REG_TAG, std::to_string(m_als_reg));
+   ini.appendItem(GLOBAL_SECTION_TAG, SAMPLER_TAG, samplerTypeToString(m_sampler_type));
+   ini.appendItem(GLOBAL_SECTION_TAG, SGLD_BATCH_SIZE_TAG, std::to_string(m_sgld_batch_size));
+   ini.appendItem(GLOBAL_SECTION_TAG, SGLD_STEP_TAG, std::to_string(m_sgld_step));
 
    //probit prior data
    ini.appendComment("binary classification");
@@ -465,17 +696,35 @@ bool Config::restore(std::string fname)
    m_save_extension = reader.get(GLOBAL_SECTION_TAG, SAVE_EXTENSION_TAG, Config::SAVE_EXTENSION_DEFAULT_VALUE);
    m_save_freq = reader.getInteger(GLOBAL_SECTION_TAG, SAVE_FREQ_TAG, Config::SAVE_FREQ_DEFAULT_VALUE);
    m_checkpoint_freq = reader.getInteger(GLOBAL_SECTION_TAG, CHECKPOINT_FREQ_TAG, Config::CHECKPOINT_FREQ_DEFAULT_VALUE);
+   m_save_hyper = reader.getBoolean(GLOBAL_SECTION_TAG, SAVE_HYPER_TAG, false);
 
    //restore general data
    m_verbose = reader.getInteger(GLOBAL_SECTION_TAG, VERBOSE_TAG, Config::VERBOSE_DEFAULT_VALUE);
    m_burnin = reader.getInteger(GLOBAL_SECTION_TAG, BURNING_TAG, Config::BURNIN_DEFAULT_VALUE);
    m_nsamples = reader.getInteger(GLOBAL_SECTION_TAG, NSAMPLES_TAG, Config::NSAMPLES_DEFAULT_VALUE);
+   m_auto_burnin = reader.getBoolean(GLOBAL_SECTION_TAG, AUTO_BURNIN_TAG, false);
+   m_max_rhat = reader.getReal(GLOBAL_SECTION_TAG, MAX_RHAT_TAG, Config::MAX_RHAT_DEFAULT_VALUE);
+   m_target_ess = reader.getReal(GLOBAL_SECTION_TAG, TARGET_ESS_TAG, Config::TARGET_ESS_DEFAULT_VALUE);
+   m_coarse_burnin = reader.getInteger(GLOBAL_SECTION_TAG, COARSE_BURNIN_TAG, Config::COARSE_BURNIN_DEFAULT_VALUE);
+   m_coarse_fraction = reader.getReal(GLOBAL_SECTION_TAG, COARSE_FRACTION_TAG, Config::COARSE_FRACTION_DEFAULT_VALUE);
    m_num_latent = reader.getInteger(GLOBAL_SECTION_TAG, NUM_LATENT_TAG, Config::NUM_LATENT_DEFAULT_VALUE);
    m_num_threads = reader.getInteger(GLOBAL_SECTION_TAG, NUM_THREADS_TAG, Config::NUM_THREADS_DEFAULT_VALUE);
+   m_num_chains = reader.getInteger(GLOBAL_SECTION_TAG, NUM_CHAINS_TAG, Config::NUM_CHAINS_DEFAULT_VALUE);
+   m_cv_folds = reader.getInteger(GLOBAL_SECTION_TAG, CV_FOLDS_TAG, Config::CV_FOLDS_DEFAULT_VALUE);
+   m_warm_start = reader.get(GLOBAL_SECTION_TAG, WARM_START_TAG, std::string());
+   m_pipeline = reader.getBoolean(GLOBAL_SECTION_TAG, PIPELINE_TAG, false);
+   m_pipeline_threads = reader.getInteger(GLOBAL_SECTION_TAG, PIPELINE_THREADS_TAG, Config::PIPELINE_THREADS_DEFAULT_VALUE);
+   m_prune_latents = reader.getBoolean(GLOBAL_SECTION_TAG, PRUNE_LATENTS_TAG, false);
+   m_data_parallel = reader.getBoolean(GLOBAL_SECTION_TAG, DATA_PARALLEL_TAG, false);
    m_random_seed_set = reader.getBoolean(GLOBAL_SECTION_TAG, RANDOM_SEED_SET_TAG,  false);
    m_random_seed = reader.getInteger(GLOBAL_SECTION_TAG, RANDOM_SEED_TAG, Config::RANDOM_SEED_DEFAULT_VALUE);
    m_csv_status = reader.get(GLOBAL_SECTION_TAG, CSV_STATUS_TAG, Config::STATUS_DEFAULT_VALUE);
    m_model_init_type = stringToModelInitType(reader.get(GLOBAL_SECTION_TAG, INIT_MODEL_TAG, modelInitTypeToString(Config::INIT_MODEL_DEFAULT_VALUE)));
+   m_als_sweeps = reader.getInteger(GLOBAL_SECTION_TAG, ALS_SWEEPS_TAG, Config::ALS_SWEEPS_DEFAULT_VALUE);
+   m_als_reg = reader.getReal(GLOBAL_SECTION_TAG, ALS_REG_TAG, Config::ALS_REG_DEFAULT_VALUE);
+   m_sampler_type = stringToSamplerType(reader.get(GLOBAL_SECTION_TAG, SAMPLER_TAG, samplerTypeToString(Config::SAMPLER_DEFAULT_VALUE)));
+   m_sgld_batch_size = reader.getInteger(GLOBAL_SECTION_TAG, SGLD_BATCH_SIZE_TAG, Config::SGLD_BATCH_SIZE_DEFAULT_VALUE);
+   m_sgld_step = reader.getReal(GLOBAL_SECTION_TAG, SGLD_STEP_TAG, Config::SGLD_STEP_DEFAULT_VALUE);
 
    //restore probit prior data
    m_classify = reader.getBoolean(GLOBAL_SECTION_TAG, CLASSIFY_TAG,  false);
@@ -18,6 +18,10 @@
 
 #define MODEL_INIT_NAME_RANDOM "random"
 #define MODEL_INIT_NAME_ZERO "zero"
+#define MODEL_INIT_NAME_ALS "als"
+
+#define SAMPLER_NAME_GIBBS "gibbs"
+#define SAMPLER_NAME_SGLD "sgld"
 
 namespace smurff {
 
@@ -35,7 +39,14 @@ enum class PriorTypes
 enum class ModelInitTypes
 {
    random,
-   zero
+   zero,
+   als
+};
+
+enum class SamplerTypes
+{
+   gibbs,
+   sgld
 };
 
 PriorTypes stringToPriorType(std::string name);
@@ -46,6 +57,10 @@ ModelInitTypes stringToModelInitType(std::string name);
 
 std::string modelInitTypeToString(ModelInitTypes type);
 
+SamplerTypes stringToSamplerType(std::string name);
+
+std::string samplerTypeToString(SamplerTypes type);
+
 struct Config
 {
 public:
@@ -55,7 +70,19 @@ public:
    static int NSAMPLES_DEFAULT_VALUE;
    static int NUM_LATENT_DEFAULT_VALUE;
    static int NUM_THREADS_DEFAULT_VALUE;
+   static int PIPELINE_THREADS_DEFAULT_VALUE;
+   static int NUM_CHAINS_DEFAULT_VALUE;
+   static int CV_FOLDS_DEFAULT_VALUE;
+   static double MAX_RHAT_DEFAULT_VALUE;
+   static double TARGET_ESS_DEFAULT_VALUE;
+   static int COARSE_BURNIN_DEFAULT_VALUE;
+   static double COARSE_FRACTION_DEFAULT_VALUE;
    static ModelInitTypes INIT_MODEL_DEFAULT_VALUE;
+   static int ALS_SWEEPS_DEFAULT_VALUE;
+   static double ALS_REG_DEFAULT_VALUE;
+   static SamplerTypes SAMPLER_DEFAULT_VALUE;
+   static int SGLD_BATCH_SIZE_DEFAULT_VALUE;
+   static double SGLD_STEP_DEFAULT_VALUE;
    static const char* SAVE_PREFIX_DEFAULT_VALUE;
    static const char* SAVE_EXTENSION_DEFAULT_VALUE;
    static int SAVE_FREQ_DEFAULT_VALUE;
@@ -82,12 +109,20 @@ private:
 
    //-- init model
    ModelInitTypes m_model_init_type;
+   int m_als_sweeps; //alternating least squares sweeps of the als init
+   double m_als_reg; //ridge regularization of the als init
+
+   //-- sampler
+   SamplerTypes m_sampler_type;
+   int m_sgld_batch_size; //sgld: entries of a column in its minibatch
+   double m_sgld_step; //sgld: step size, relative to the inverse of the diagonal of the posterior precision
 
    //-- save
    std::string m_save_prefix;
    std::string m_save_extension;
    int m_save_freq;
    int m_checkpoint_freq;
+   bool m_save_hyper; //save mu and Lambda of the normal priors with every sample, to fold in new entities
 
    //-- general
    bool m_random_seed_set;
@@ -96,8 +131,20 @@ private:
    std::string m_csv_status;
    int m_burnin;
    int m_nsamples;
+   bool m_auto_burnin; //end burnin once split-Rhat of the diagnostics is below m_max_rhat, m_burnin is the maximum
+   double m_max_rhat;
+   double m_target_ess; //stop sampling once the diagnostics reach this ESS, m_nsamples is the maximum, 0 = off
+   int m_coarse_burnin; //first burnin iterations on a subsample of the train data, 0 = off
+   double m_coarse_fraction; //fraction of the train entries in that subsample
    int m_num_latent;
    int m_num_threads; 
+   int m_num_chains; //independent chains sampled in one process
+   int m_cv_folds; //k-fold cross-validation over the train data, 0 = off
+   std::string m_warm_start; //root file of a previous run to start from, empty = off
+   bool m_pipeline;
+   int m_pipeline_threads; //pipeline: threads of the link matrix updates, taken from the sampling, 0 = half of them
+   bool m_prune_latents;
+   bool m_data_parallel; //mpi: every rank samples its own slice of the columns of each mode, rank 0 updates the hyperparameters and the noise
 
 
    //-- binary classification
@@ -157,6 +204,11 @@ public:
 
    const std::map<int, std::vector<std::shared_ptr<SideInfoConfig> > >& addSideInfoConfig(int mode, std::shared_ptr<SideInfoConfig> c);
 
+   void setSideInfoConfigs(int mode, const std::vector<std::shared_ptr<SideInfoConfig> >& values)
+   {
+      m_sideInfoConfigs[mode] = values;
+   }
+
    bool hasSideInfo(int mode) const
    {
        return m_sideInfoConfigs.find(mode) != m_sideInfoConfigs.end();
@@ -215,6 +267,66 @@ public:
       m_model_init_type = stringToModelInitType(value);
    }
 
+   SamplerTypes getSamplerType() const
+   {
+      return m_sampler_type;
+   }
+
+   void setSamplerType(SamplerTypes value)
+   {
+      m_sampler_type = value;
+   }
+
+   std::string getSamplerTypeAsString() const
+   {
+      return samplerTypeToString(m_sampler_type);
+   }
+
+   void setSamplerType(std::string value)
+   {
+      m_sampler_type = stringToSamplerType(value);
+   }
+
+   int getSgldBatchSize() const
+   {
+      return m_sgld_batch_size;
+   }
+
+   void setSgldBatchSize(int value)
+   {
+      m_sgld_batch_size = value;
+   }
+
+   double getSgldStep() const
+   {
+      return m_sgld_step;
+   }
+
+   void setSgldStep(double value)
+   {
+      m_sgld_step = value;
+   }
+
+   int getAlsSweeps() const
+   {
+      return m_als_sweeps;
+   }
+
+   void setAlsSweeps(int value)
+   {
+      m_als_sweeps = value;
+   }
+
+   double getAlsReg() const
+   {
+      return m_als_reg;
+   }
+
+   void setAlsReg(double value)
+   {
+      m_als_reg = value;
+   }
+
    std::string getSavePrefix() const
    {
       return m_save_prefix;
@@ -255,6 +367,16 @@ public:
       m_checkpoint_freq = value;
    }
 
+   bool getSaveHyper() const
+   {
+      return m_save_hyper;
+   }
+
+   void setSaveHyper(bool value)
+   {
+      m_save_hyper = value;
+   }
+
    bool getRandomSeedSet() const
    {
       return m_random_seed_set;
@@ -313,6 +435,62 @@ public:
       m_nsamples = value;
    }
 
+   bool getAutoBurnin() const
+   {
+      return m_auto_burnin;
+   }
+
+   void setAutoBurnin(bool value)
+   {
+      m_auto_burnin = value;
+   }
+
+   double getMaxRhat() const
+   {
+      return m_max_rhat;
+   }
+
+   void setMaxRhat(double value)
+   {
+      m_max_rhat = value;
+   }
+
+   double getTargetEss() const
+   {
+      return m_target_ess;
+   }
+
+   void setTargetEss(double value)
+   {
+      m_target_ess = value;
+   }
+
+   //the convergence diagnostics are only recorded when the automatic modes or the csv status use them
+   bool getRecordDiagnostics() const
+   {
+      return m_auto_burnin || m_target_ess > 0 || !m_csv_status.empty();
+   }
+
+   int getCoarseBurnin() const
+   {
+      return m_coarse_burnin;
+   }
+
+   void setCoarseBurnin(int value)
+   {
+      m_coarse_burnin = value;
+   }
+
+   double getCoarseFraction() const
+   {
+      return m_coarse_fraction;
+   }
+
+   void setCoarseFraction(double value)
+   {
+      m_coarse_fraction = value;
+   }
+
    int getNumLatent() const
    {
       return m_num_latent;
@@ -352,6 +530,76 @@ public:
    {
        m_num_threads = value;
    }
+
+   int getNumChains() const
+   {
+       return m_num_chains;
+   }
+
+   void setNumChains(int value)
+   {
+       m_num_chains = value;
+   }
+
+   int getCVFolds() const
+   {
+       return m_cv_folds;
+   }
+
+   void setCVFolds(int value)
+   {
+       m_cv_folds = value;
+   }
+
+   std::string getWarmStart() const
+   {
+       return m_warm_start;
+   }
+
+   void setWarmStart(std::string value)
+   {
+       m_warm_start = value;
+   }
+
+   bool getPipeline() const
+   {
+       return m_pipeline;
+   }
+
+   void setPipeline(bool value)
+   {
+       m_pipeline = value;
+   }
+
+   int getPipelineThreads() const
+   {
+       return m_pipeline_threads;
+   }
+
+   void setPipelineThreads(int value)
+   {
+       m_pipeline_threads = value;
+   }
+
+   bool getDataParallel() const
+   {
+       return m_data_parallel;
+   }
+
+   void setDataParallel(bool value)
+   {
+       m_data_parallel = value;
+   }
+
+   bool getPruneLatents() const
+   {
+       return m_prune_latents;
+   }
+
+   void setPruneLatents(bool value)
+   {
+       m_prune_latents = value;
+   }
 };
 
 }
@@ -6,6 +6,8 @@
 
 #include "TensorConfig.h"
 
+#include <SmurffCpp/IO/MatrixIO.h>
+
 #define MACAU_PRIOR_CONFIG_PREFIX_TAG "macau_prior_config"
 #define MACAU_PRIOR_CONFIG_ITEM_PREFIX_TAG "macau_prior_config_item"
 
@@ -13,19 +15,45 @@
 
 #define TOL_TAG "tol"
 #define DIRECT_TAG "direct"
+#define SPARSE_DIRECT_TAG "sparse_direct"
 #define THROW_ON_CHOLESKY_ERROR_TAG "throw_on_cholesky_error"
+#define COMPRESSED_TAG "compressed"
+#define BITPACKED_TAG "bitpacked"
+#define HASH_BUCKETS_TAG "hash_buckets"
+#define HASH_SEED_TAG "hash_seed"
+#define PROJECTION_RANK_TAG "projection_rank"
+#define AUTOTUNE_TAG "autotune"
+#define SINGLE_PRECISION_TAG "single_precision"
+#define PARTITION_ROWS_TAG "partition_rows"
 #define SIDE_INFO_PREFIX "side_info"
 
 using namespace smurff;
 
 double SideInfoConfig::BETA_PRECISION_DEFAULT_VALUE = 10.0;
 double SideInfoConfig::TOL_DEFAULT_VALUE = 1e-6;
+SideInfoConfig::RowRange SideInfoConfig::s_row_range;
 
 SideInfoConfig::SideInfoConfig()
 {
    m_tol = SideInfoConfig::TOL_DEFAULT_VALUE;
    m_direct = false;
+   m_sparse_direct = false;
    m_throw_on_cholesky_error = false;
+   m_compressed = false;
+   m_bitpacked = false;
+   m_hash_buckets = 0;
+   m_hash_seed = 0;
+   m_projection_rank = 0;
+   m_autotune = false;
+   m_single_precision = false;
+   m_partition_rows = false;
+   m_nrow = 0;
+   m_row_begin = 0;
+}
+
+void SideInfoConfig::setRowRange(RowRange row_range)
+{
+   s_row_range = row_range;
 }
 
 void SideInfoConfig::save(INIFile& writer, std::size_t prior_index, std::size_t config_item_index) const
@@ -38,7 +66,16 @@ void SideInfoConfig::save(INIFile& writer, std::size_t prior_index, std::size_t
    //config item data
    writer.appendItem(sectionName, TOL_TAG, std::to_string(m_tol));
    writer.appendItem(sectionName, DIRECT_TAG, std::to_string(m_direct));
+   writer.appendItem(sectionName, SPARSE_DIRECT_TAG, std::to_string(m_sparse_direct));
    writer.appendItem(sectionName, THROW_ON_CHOLESKY_ERROR_TAG, std::to_string(m_throw_on_cholesky_error));
+   writer.appendItem(sectionName, COMPRESSED_TAG, std::to_string(m_compressed));
+   writer.appendItem(sectionName, BITPACKED_TAG, std::to_string(m_bitpacked));
+   writer.appendItem(sectionName, HASH_BUCKETS_TAG, std::to_string(m_hash_buckets));
+   writer.appendItem(sectionName, HASH_SEED_TAG, std::to_string(m_hash_seed));
+   writer.appendItem(sectionName, PROJECTION_RANK_TAG, std::to_string(m_projection_rank));
+   writer.appendItem(sectionName, AUTOTUNE_TAG, std::to_string(m_autotune));
+   writer.appendItem(sectionName, SINGLE_PRECISION_TAG, std::to_string(m_single_precision));
+   writer.appendItem(sectionName, PARTITION_ROWS_TAG, std::to_string(m_partition_rows));
 
    writer.endSection();
 
@@ -57,6 +94,37 @@ bool SideInfoConfig::restore(const INIFile& reader, std::size_t prior_index, std
       return name;
    };
 
+   if (!restoreOptions(reader, prior_index, config_item_index))
+   {
+       return false;
+   }
+
+   std::stringstream ss;
+   ss << SIDE_INFO_PREFIX << "_" << prior_index;
+
+   if (!m_partition_rows || !s_row_range)
+   {
+      auto tensor_cfg = TensorConfig::restore_tensor_config(reader, add_index(ss.str(), config_item_index));
+      setSideInfo(std::dynamic_pointer_cast<MatrixConfig>(tensor_cfg));
+      return true;
+   }
+
+   // only the rows of this process are read
+   std::uint64_t nrow = 0, begin = 0, end = 0;
+   auto tensor_cfg = TensorConfig::restore_tensor_config(reader, add_index(ss.str(), config_item_index),
+      [&](const std::string& filename, bool is_scarce) -> std::shared_ptr<TensorConfig>
+      {
+         nrow = matrix_io::read_matrix_nrow(filename);
+         s_row_range(nrow, begin, end);
+         return matrix_io::read_matrix_rows(filename, is_scarce, begin, end);
+      });
+   setSideInfoRows(std::dynamic_pointer_cast<MatrixConfig>(tensor_cfg), begin, nrow);
+
+   return true;
+}
+
+bool SideInfoConfig::restoreOptions(const INIFile& reader, std::size_t prior_index, std::size_t config_item_index)
+{
    std::stringstream section;
    section << MACAU_PRIOR_CONFIG_ITEM_PREFIX_TAG << "_" << prior_index << "_" << config_item_index;
 
@@ -68,13 +136,16 @@ bool SideInfoConfig::restore(const INIFile& reader, std::size_t prior_index, std
    //restore side info properties
    m_tol = reader.getReal(section.str(), TOL_TAG, SideInfoConfig::TOL_DEFAULT_VALUE);
    m_direct = reader.getBoolean(section.str(), DIRECT_TAG, false);
+   m_sparse_direct = reader.getBoolean(section.str(), SPARSE_DIRECT_TAG, false);
    m_throw_on_cholesky_error = reader.getBoolean(section.str(), THROW_ON_CHOLESKY_ERROR_TAG, false);
-
-   std::stringstream ss;
-   ss << SIDE_INFO_PREFIX << "_" << prior_index;
-
-   auto tensor_cfg = TensorConfig::restore_tensor_config(reader, add_index(ss.str(), config_item_index));
-   m_sideInfo = std::dynamic_pointer_cast<MatrixConfig>(tensor_cfg);
+   m_compressed = reader.getBoolean(section.str(), COMPRESSED_TAG, false);
+   m_bitpacked = reader.getBoolean(section.str(), BITPACKED_TAG, false);
+   m_hash_buckets = reader.getInteger(section.str(), HASH_BUCKETS_TAG, 0);
+   m_hash_seed = reader.getInteger(section.str(), HASH_SEED_TAG, 0);
+   m_projection_rank = reader.getInteger(section.str(), PROJECTION_RANK_TAG, 0);
+   m_autotune = reader.getBoolean(section.str(), AUTOTUNE_TAG, false);
+   m_single_precision = reader.getBoolean(section.str(), SINGLE_PRECISION_TAG, false);
+   m_partition_rows = reader.getBoolean(section.str(), PARTITION_ROWS_TAG, false);
 
    return true;
 }
@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <functional>
 
 #include <SmurffCpp/IO/INIFile.h>
 
@@ -15,12 +16,29 @@ namespace smurff
    public:
       static double BETA_PRECISION_DEFAULT_VALUE;
       static double TOL_DEFAULT_VALUE;
+
+      // rows [begin, end) of nrow rows that this process holds of row-partitioned side info
+      typedef std::function<void(std::uint64_t nrow, std::uint64_t& begin, std::uint64_t& end)> RowRange;
+
    private:
+      static RowRange s_row_range; //set by mpi_smurff, empty if every process holds all rows
+
       double m_tol;
       bool m_direct;
+      bool m_sparse_direct; //direct method on sparse side info factorizes a sparse F'F
       bool m_throw_on_cholesky_error;
+      bool m_compressed; //store binary side info as delta-encoded CSR
+      bool m_bitpacked; //store binary side info as packed bits
+      int m_hash_buckets; //hash feature ids into this many signed buckets, 0 = no hashing
+      int m_hash_seed; //seed of the feature hash
+      int m_projection_rank; //sample beta in a rank-r randomized SVD of dense side info, 0 = full rank
+      bool m_autotune; //pick direct/CG and the BlockCG block size by timing them on the first updates
+      bool m_single_precision; //store dense side info as float
+      bool m_partition_rows; //mpi: every rank only holds its own slice of the rows
 
       std::shared_ptr<MatrixConfig> m_sideInfo; //side info matrix for macau and macauone prior
+      std::uint64_t m_nrow; //rows of the whole side info if m_sideInfo only holds a slice, 0 otherwise
+      std::uint64_t m_row_begin; //first row of the slice in m_sideInfo
 
    public:
       SideInfoConfig();
@@ -34,6 +52,32 @@ namespace smurff
       void setSideInfo(std::shared_ptr<MatrixConfig> value)
       {
          m_sideInfo = value;
+         m_nrow = 0;
+         m_row_begin = 0;
+      }
+
+      // value holds the rows [row_begin, row_begin + value->getNRow()) of nrow rows
+      void setSideInfoRows(std::shared_ptr<MatrixConfig> value, std::uint64_t row_begin, std::uint64_t nrow)
+      {
+         m_sideInfo = value;
+         m_nrow = nrow;
+         m_row_begin = row_begin;
+      }
+
+      bool isRowSlice() const
+      {
+         return m_nrow > 0;
+      }
+
+      // rows of the whole side info, also if only a slice is held
+      std::uint64_t getNRow() const
+      {
+         return isRowSlice() ? m_nrow : m_sideInfo->getNRow();
+      }
+
+      std::uint64_t getRowBegin() const
+      {
+         return m_row_begin;
       }
 
       double getTol() const
@@ -56,6 +100,16 @@ namespace smurff
          m_direct = value;
       }
 
+      bool getSparseDirect() const
+      {
+         return m_sparse_direct;
+      }
+
+      void setSparseDirect(bool value)
+      {
+         m_sparse_direct = value;
+      }
+
       bool getThrowOnCholeskyError() const
       {
          return m_throw_on_cholesky_error;
@@ -66,9 +120,96 @@ namespace smurff
          m_throw_on_cholesky_error = value;
       }
 
+      bool getCompressed() const
+      {
+         return m_compressed;
+      }
+
+      void setCompressed(bool value)
+      {
+         m_compressed = value;
+      }
+
+      bool getBitPacked() const
+      {
+         return m_bitpacked;
+      }
+
+      void setBitPacked(bool value)
+      {
+         m_bitpacked = value;
+      }
+
+      int getHashBuckets() const
+      {
+         return m_hash_buckets;
+      }
+
+      void setHashBuckets(int value)
+      {
+         m_hash_buckets = value;
+      }
+
+      int getHashSeed() const
+      {
+         return m_hash_seed;
+      }
+
+      void setHashSeed(int value)
+      {
+         m_hash_seed = value;
+      }
+
+      int getProjectionRank() const
+      {
+         return m_projection_rank;
+      }
+
+      void setProjectionRank(int value)
+      {
+         m_projection_rank = value;
+      }
+
+      bool getAutotune() const
+      {
+         return m_autotune;
+      }
+
+      void setAutotune(bool value)
+      {
+         m_autotune = value;
+      }
+
+      bool getSinglePrecision() const
+      {
+         return m_single_precision;
+      }
+
+      void setSinglePrecision(bool value)
+      {
+         m_single_precision = value;
+      }
+
+      bool getPartitionRows() const
+      {
+         return m_partition_rows;
+      }
+
+      void setPartitionRows(bool value)
+      {
+         m_partition_rows = value;
+      }
+
+   public:
+      // with a row range, restore only reads the rows of this process of side info with partition_rows
+      static void setRowRange(RowRange row_range);
+
    public:
       void save(INIFile& writer, std::size_t prior_index, std::size_t config_item_index) const;
 
       bool restore(const INIFile& reader, std::size_t prior_index, std::size_t config_item_index);
+
+      //restores the options only, the side info matrix is not read
+      bool restoreOptions(const INIFile& reader, std::size_t prior_index, std::size_t config_item_index);
    };
 }
@@ -472,7 +472,7 @@ void TensorConfig::save(INIFile& writer, const std::string& section_name) const
    writer.endSection();
 }
 
-std::shared_ptr<TensorConfig> TensorConfig::restore_tensor_config(const INIFile& reader, const std::string& sec_name)
+std::shared_ptr<TensorConfig> TensorConfig::restore_tensor_config(const INIFile& reader, const std::string& sec_name, DataReader read_data)
 {
    //restore filename
    std::string filename = reader.get(sec_name, FILE_TAG, NONE_TAG);
@@ -483,7 +483,7 @@ std::shared_ptr<TensorConfig> TensorConfig::restore_tensor_config(const INIFile&
    bool is_scarce = reader.get(sec_name, TYPE_TAG, SCARCE_TAG) == SCARCE_TAG;
 
    //restore data
-   auto cfg = generic_io::read_data_config(filename, is_scarce);
+   auto cfg = read_data ? read_data(filename, is_scarce) : generic_io::read_data_config(filename, is_scarce);
 
    //restore instance
    cfg->restore(reader, sec_name);
@@ -504,7 +504,14 @@ bool TensorConfig::restore(const INIFile& reader, const std::string& sec_name)
       this->setPos(PVec<>(tokens));
    }
 
-   //restore noise model
+   //assign noise model
+   this->setNoiseConfig(restore_noise_config(reader, sec_name));
+
+   return true;
+}
+
+NoiseConfig TensorConfig::restore_noise_config(const INIFile& reader, const std::string& sec_name)
+{
    NoiseConfig noise;
 
    NoiseTypes noiseType = smurff::stringToNoiseType(reader.get(sec_name, NOISE_MODEL_TAG, smurff::noiseTypeToString(NoiseTypes::unset)));
@@ -517,10 +524,7 @@ bool TensorConfig::restore(const INIFile& reader, const std::string& sec_name)
       noise.setThreshold(reader.getReal(sec_name, NOISE_THRESHOLD_TAG, NoiseConfig::PROBIT_DEFAULT_VALUE));
    }
 
-   //assign noise model
-   this->setNoiseConfig(noise);
-
-   return true;
+   return noise;
 }
 
 std::shared_ptr<Data> TensorConfig::create(std::shared_ptr<IDataCreator> creator) const
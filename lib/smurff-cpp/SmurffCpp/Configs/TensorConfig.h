@@ -4,6 +4,7 @@
 #include <iostream>
 #include <memory>
 #include <cstdint>
+#include <functional>
 
 #include <SmurffCpp/Utils/PVec.hpp>
 #include <SmurffCpp/Configs/NoiseConfig.h>
@@ -119,7 +120,13 @@ namespace smurff
    public:
       static void save_tensor_config(INIFile& writer, const std::string& sec_name, int sec_idx, const std::shared_ptr<TensorConfig> &cfg);
 
-      static std::shared_ptr<TensorConfig> restore_tensor_config(const INIFile& reader, const std::string& sec_name);
+      // reads the data file of a restored config, generic_io::read_data_config if empty
+      typedef std::function<std::shared_ptr<TensorConfig>(const std::string& filename, bool is_scarce)> DataReader;
+
+      static std::shared_ptr<TensorConfig> restore_tensor_config(const INIFile& reader, const std::string& sec_name, DataReader read_data = DataReader());
+
+      //noise model of a saved tensor config, the data itself is not read
+      static NoiseConfig restore_noise_config(const INIFile& reader, const std::string& sec_name);
 
    public:
       virtual std::shared_ptr<Data> create(std::shared_ptr<IDataCreator> creator) const;
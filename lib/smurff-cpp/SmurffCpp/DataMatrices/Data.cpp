@@ -8,6 +8,11 @@ Data::Data()
 {
 }
 
+Data::Data(const Data& other)
+   : name(other.name), noise_ptr(other.noise_ptr ? other.noise_ptr->clone() : std::shared_ptr<INoiseModel>())
+{
+}
+
 void Data::init()
 {
     init_pre();
@@ -25,6 +30,11 @@ void Data::update(const SubModel& model)
    noise().update(model);
 }
 
+void Data::for_each_noise_param(const std::function<void(double*, std::size_t)>& f)
+{
+   noise().for_each_param(f);
+}
+
 //#### dimention functions ####
 
 std::uint64_t Data::size() const
@@ -68,6 +78,11 @@ void Data::setNoiseModel(std::shared_ptr<INoiseModel> nm)
    noise_ptr = nm;
 }
 
+void Data::getGradient(const SubModel& model, uint32_t mode, int d, int batch_size, Eigen::VectorXd& grad, Eigen::VectorXd& hess) const
+{
+   THROWERROR("Stochastic gradients are not supported by " + name);
+}
+
 //#### info functions ####
 
 std::ostream& Data::info(std::ostream& os, std::string indent)
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <functional>
 
 #include <SmurffCpp/Noises/INoiseModel.h>
 #include <SmurffCpp/Utils/PVec.hpp>
@@ -25,10 +26,14 @@ namespace smurff
 
    protected:
       Data();
+      Data(const Data& other); // the copy gets its own noise model
 
    public:
       virtual ~Data(){}
 
+      // a copy with its own noise model and caches that shares the train data
+      virtual std::shared_ptr<Data> clone() const = 0;
+
    protected:
       virtual void init_pre() = 0;
       virtual void init_post();
@@ -37,6 +42,9 @@ namespace smurff
       virtual void init();
       virtual void update(const SubModel& model);
 
+      // calls f with the data and size of every noise parameter that update writes
+      virtual void for_each_noise_param(const std::function<void(double*, std::size_t)>& f);
+
    //#### arithmetic functions ####
    public:
       virtual double sum() const = 0;
@@ -69,6 +77,11 @@ namespace smurff
       virtual void update_pnm(const SubModel& model, uint32_t mode) = 0;
       virtual void getMuLambda(const SubModel& model, uint32_t mode, int d, Eigen::VectorXd& rr, Eigen::MatrixXd& MM) const = 0;
 
+      // stochastic estimate of getMuLambda for the sgld sampler, from a random minibatch of at most
+      // <batch_size> entries of column d scaled up to all of them: grad = rr - MM * U(mode).col(d)
+      // and hess = the diagonal of MM, without forming MM. Not supported by default
+      virtual void getGradient(const SubModel& model, uint32_t mode, int d, int batch_size, Eigen::VectorXd& grad, Eigen::VectorXd& hess) const;
+
    public:
       virtual double sumsq(const SubModel& model) const = 0;
       virtual double var_total() const = 0;
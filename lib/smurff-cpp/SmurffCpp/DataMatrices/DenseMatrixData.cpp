@@ -9,6 +9,11 @@ DenseMatrixData::DenseMatrixData(MatrixXd Y)
     this->name = "DenseMatrixData [fully known]";
 }
 
+std::shared_ptr<Data> DenseMatrixData::clone() const
+{
+   return std::make_shared<DenseMatrixData>(*this);
+}
+
 //d is an index of column in U matrix
 void DenseMatrixData::getMuLambda(const SubModel& model, uint32_t mode, int d, VectorXd& rr, MatrixXd& MM) const
 {
@@ -8,6 +8,8 @@ namespace smurff
    {
    public:
       DenseMatrixData(Eigen::MatrixXd Y);
+
+      std::shared_ptr<Data> clone() const override;
       void getMuLambda(const SubModel& model, std::uint32_t mode, int d, Eigen::VectorXd& rr, Eigen::MatrixXd& MM) const override;
 
    public:
@@ -0,0 +1,216 @@
+#include "FoldMatrixData.h"
+
+#include <numeric>
+
+#include <SmurffCpp/Configs/MatrixConfig.h>
+#include <SmurffCpp/Utils/Distribution.h>
+#include <SmurffCpp/Utils/Error.h>
+
+using namespace smurff;
+using namespace Eigen;
+
+FoldMatrixData::FoldMatrixData(const ScarceMatrixData& data, std::shared_ptr<Folds> folds, int fold, double weight)
+   : ScarceMatrixData(data), m_folds(folds), m_fold(fold), m_weight(weight)
+{
+   name = "FoldMatrixData [fold " + std::to_string(fold) + " held out]";
+
+   THROWERROR_ASSERT(m_folds->size() == 2);
+   THROWERROR_ASSERT(m_folds->at(1).size() == (std::size_t)Y().nonZeros());
+
+   const auto& f = m_folds->at(1);
+   m_nnz = f.size() - std::count(f.begin(), f.end(), (std::uint8_t)m_fold);
+}
+
+std::shared_ptr<Data> FoldMatrixData::clone() const
+{
+   return std::make_shared<FoldMatrixData>(*this);
+}
+
+std::shared_ptr<FoldMatrixData::Folds> FoldMatrixData::assign_folds(const ScarceMatrixData& data, int nfolds)
+{
+   THROWERROR_ASSERT_MSG(nfolds > 1 && nfolds <= 255, "Number of folds should be between 2 and 255");
+
+   const auto& Y = data.Y(1);
+   std::uint64_t nnz = Y.nonZeros();
+
+   // random permutation of the entries, dealt out to the folds
+   std::vector<std::uint64_t> perm(nnz);
+   std::iota(perm.begin(), perm.end(), 0);
+   for (std::uint64_t i = nnz - 1; i > 0; i--)
+   {
+      std::uint64_t j = std::min((std::uint64_t)(rand_unif() * (i + 1)), i);
+      std::swap(perm[i], perm[j]);
+   }
+
+   auto folds = std::make_shared<Folds>(2);
+   auto& f1 = folds->at(1);
+   f1.resize(nnz);
+   for (std::uint64_t i = 0; i < nnz; i++)
+      f1[perm[i]] = i % nfolds;
+
+   transpose_folds(data, *folds);
+
+   return folds;
+}
+
+std::shared_ptr<FoldMatrixData> FoldMatrixData::subsample(const ScarceMatrixData& data, double fraction)
+{
+   THROWERROR_ASSERT_MSG(fraction > 0.0 && fraction <= 1.0, "Subsample fraction should be in (0, 1]");
+
+   // entries in the subsample are in fold 1, the others in the held-out fold 0
+   std::uint64_t nnz = data.Y(1).nonZeros();
+   auto folds = std::make_shared<Folds>(2);
+   auto& f1 = folds->at(1);
+   f1.resize(nnz);
+
+   std::uint64_t nkept = 0;
+   for (std::uint64_t i = 0; i < nnz; i++)
+   {
+      f1[i] = rand_unif() < fraction;
+      nkept += f1[i];
+   }
+
+   THROWERROR_ASSERT_MSG(nkept > 0, "Empty subsample of the train data");
+
+   transpose_folds(data, *folds);
+
+   auto view = std::make_shared<FoldMatrixData>(data, folds, 0, (double)nnz / nkept);
+   view->name = "FoldMatrixData [subsample of " + std::to_string(nkept) + " entries]";
+   return view;
+}
+
+void FoldMatrixData::transpose_folds(const ScarceMatrixData& data, Folds& folds)
+{
+   const auto& f1 = folds.at(1);
+
+   SparseMatrix<int> F1 = data.Y(1).cast<int>();
+   std::copy(f1.begin(), f1.end(), F1.valuePtr());
+   SparseMatrix<int> F0 = F1.transpose();
+   THROWERROR_ASSERT(F0.nonZeros() == data.Y(0).nonZeros());
+
+   folds.at(0).assign(F0.valuePtr(), F0.valuePtr() + F0.nonZeros());
+}
+
+std::shared_ptr<MatrixConfig> FoldMatrixData::held_out(const ScarceMatrixData& data, const Folds& folds, int fold)
+{
+   const auto& Y = data.Y(1);
+
+   std::vector<std::uint32_t> rows;
+   std::vector<std::uint32_t> cols;
+   std::vector<double> values;
+
+   for (int j = 0; j < Y.outerSize(); j++)
+   {
+      for (SparseMatrix<double>::InnerIterator it(Y, j); it; ++it)
+      {
+         if (folds[1][&it.value() - Y.valuePtr()] != fold)
+            continue;
+
+         rows.push_back(it.row());
+         cols.push_back(it.col());
+         values.push_back(it.value());
+      }
+   }
+
+   return std::make_shared<MatrixConfig>(Y.rows(), Y.cols(), std::move(rows), std::move(cols), std::move(values), NoiseConfig(), true);
+}
+
+void FoldMatrixData::init_pre()
+{
+   MatrixDataTempl<SparseMatrix<double> >::init_pre();
+
+   // rows and cols that only have held-out entries
+   for(std::uint64_t mode = 0; mode < nmode(); ++mode)
+   {
+      auto& m = this->Y(mode);
+      auto& count = num_empty[mode];
+      count = 0;
+      for (int j = 0; j < m.cols(); j++)
+      {
+         bool empty = true;
+         for (auto i = m.outerIndexPtr()[j]; i < m.outerIndexPtr()[j + 1] && empty; i++)
+            empty = !is_train(mode, i);
+         if (empty)
+            count++;
+      }
+   }
+}
+
+std::ostream& FoldMatrixData::info(std::ostream& os, std::string indent)
+{
+   ScarceMatrixData::info(os, indent);
+   os << indent << "  Held-out entries: " << Y().nonZeros() - m_nnz << "\n";
+   if (m_weight != 1.0)
+      os << indent << "  Noise precision scaled by: " << m_weight << "\n";
+   return os;
+}
+
+void FoldMatrixData::getGradient(const SubModel& model, std::uint32_t mode, int d, int batch_size, VectorXd& grad, VectorXd& hess) const
+{
+   THROWERROR("Stochastic gradients are not supported on a masked train matrix");
+}
+
+std::uint64_t FoldMatrixData::nnz() const
+{
+   return m_nnz;
+}
+
+double FoldMatrixData::sum() const
+{
+   const auto& Y = this->Y();
+
+   double sum = 0.0;
+   for (std::int64_t i = 0; i < Y.nonZeros(); i++)
+   {
+      if (is_train(1, i))
+         sum += Y.valuePtr()[i];
+   }
+
+   return sum;
+}
+
+double FoldMatrixData::var_total() const
+{
+   const auto& Y = this->Y();
+
+   double cwise_mean = this->sum() / this->nnz();
+   double se = 0.0;
+
+   #pragma omp parallel for schedule(dynamic, 4) reduction(+:se)
+   for (int k = 0; k < Y.outerSize(); ++k)
+   {
+      for (auto i = Y.outerIndexPtr()[k]; i < Y.outerIndexPtr()[k + 1]; i++)
+      {
+         if (is_train(1, i))
+            se += std::pow(Y.valuePtr()[i] - cwise_mean, 2);
+      }
+   }
+
+   double var = se / this->nnz();
+   if (var <= 0.0 || std::isnan(var))
+   {
+      // if var cannot be computed using 1.0
+      var = 1.0;
+   }
+
+   return var;
+}
+
+double FoldMatrixData::sumsq(const SubModel& model) const
+{
+   const auto& Y = this->Y();
+
+   double sumsq = 0.0;
+
+   #pragma omp parallel for schedule(dynamic, 4) reduction(+:sumsq)
+   for (int j = 0; j < Y.outerSize(); j++)
+   {
+      for (auto i = Y.outerIndexPtr()[j]; i < Y.outerIndexPtr()[j + 1]; i++)
+      {
+         if (is_train(1, i))
+            sumsq += std::pow(model.predict({static_cast<int>(Y.innerIndexPtr()[i]), j}) - Y.valuePtr()[i], 2);
+      }
+   }
+
+   return sumsq;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ScarceMatrixData.h"
+
+namespace smurff
+{
+   // view of a ScarceMatrixData that hides the entries of one cross-validation fold,
+   // all folds share Y and the fold assignment.
+   // Also used as a random subsample of Y, where the entries outside the subsample are the held-out fold
+   class FoldMatrixData : public ScarceMatrixData
+   {
+   public:
+      // fold of every stored value of Y(0) and Y(1), in storage order
+      typedef std::vector<std::vector<std::uint8_t> > Folds;
+
+   private:
+      std::shared_ptr<Folds> m_folds;
+      int m_fold; //held-out fold
+      std::uint64_t m_nnz; //entries outside the held-out fold
+      double m_weight; //every entry stands for this many entries of Y in the likelihood
+
+   public:
+      FoldMatrixData(const ScarceMatrixData& data, std::shared_ptr<Folds> folds, int fold, double weight = 1.0);
+
+      std::shared_ptr<Data> clone() const override;
+
+      // assigns every entry of <data> to one of <nfolds> folds, folds differ by at most one entry in size
+      static std::shared_ptr<Folds> assign_folds(const ScarceMatrixData& data, int nfolds);
+
+      // entries of <data> in <fold>, as a test config
+      static std::shared_ptr<MatrixConfig> held_out(const ScarceMatrixData& data, const Folds& folds, int fold);
+
+      // random subsample of about <fraction> of the entries of <data>,
+      // the noise precision is scaled up so the subsample weighs as much as all of Y
+      static std::shared_ptr<FoldMatrixData> subsample(const ScarceMatrixData& data, double fraction);
+
+   public:
+      void init_pre() override;
+
+      std::ostream& info(std::ostream& os, std::string indent) override;
+
+      // a minibatch would have to skip the held-out entries, not supported
+      void getGradient(const SubModel& model, std::uint32_t mode, int d, int batch_size, Eigen::VectorXd& grad, Eigen::VectorXd& hess) const override;
+
+      std::uint64_t nnz() const override;
+      double sum() const override;
+
+   public:
+      double var_total() const override;
+
+      double sumsq(const SubModel& model) const override;
+
+   public:
+      int getFold() const
+      {
+         return m_fold;
+      }
+
+      double getWeight() const
+      {
+         return m_weight;
+      }
+
+   protected:
+      // held-out entries are left out, the others stand for m_weight entries
+      double weight(std::uint32_t mode, std::int64_t i) const override
+      {
+         return is_train(mode, i) ? m_weight : 0.0;
+      }
+
+   private:
+      // orders the folds of Y(0), which is stored as the transpose of Y(1), like the folds of Y(1)
+      static void transpose_folds(const ScarceMatrixData& data, Folds& folds);
+
+      bool is_train(int mode, int i) const
+      {
+         return (*m_folds)[mode][i] != m_fold;
+      }
+   };
+}
@@ -10,6 +10,16 @@ MatricesData::MatricesData()
    name = "MatricesData";
 }
 
+std::shared_ptr<Data> MatricesData::clone() const
+{
+   auto data = std::make_shared<MatricesData>(*this);
+   for(auto &b : data->blocks)
+   {
+      b.m_matrix = b.m_matrix->clone();
+   }
+   return data;
+}
+
 void MatricesData::init_pre()
 {
    mode_dim.resize(nmode());
@@ -109,6 +119,14 @@ void MatricesData::update(const SubModel &model)
    }
 }
 
+void MatricesData::for_each_noise_param(const std::function<void(double*, std::size_t)>& f)
+{
+   for(auto &b : blocks)
+   {
+      b.data()->for_each_noise_param(f);
+   }
+}
+
 void MatricesData::getMuLambda(const SubModel& model, uint32_t mode, int pos, Eigen::VectorXd& rr, Eigen::MatrixXd& MM) const
 {
    int count = 0;
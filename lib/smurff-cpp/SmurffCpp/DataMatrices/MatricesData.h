@@ -9,6 +9,8 @@ namespace smurff
    public:
       MatricesData();
 
+      std::shared_ptr<Data> clone() const override;
+
    public:
       void init_pre() override;
       void init_post() override;
@@ -24,6 +26,7 @@ namespace smurff
 
       // update noise and precision/mean
       void update(const SubModel& model) override;
+      void for_each_noise_param(const std::function<void(double*, std::size_t)>& f) override;
       void getMuLambda(const SubModel& model, uint32_t mode, int d, Eigen::VectorXd& rr, Eigen::MatrixXd& MM) const override;
       void update_pnm(const SubModel& model, uint32_t mode) override;
 
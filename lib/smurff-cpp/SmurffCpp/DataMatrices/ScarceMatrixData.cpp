@@ -5,6 +5,7 @@
 #include <SmurffCpp/ConstVMatrixExprIterator.hpp>
 
 #include <SmurffCpp/Utils/ThreadVector.hpp>
+#include <SmurffCpp/Utils/Distribution.h>
 
 using namespace smurff;
 using namespace Eigen;
@@ -15,6 +16,11 @@ ScarceMatrixData::ScarceMatrixData(SparseMatrix<double> Y)
    name = "ScarceMatrixData [with NAs]";
 }
 
+std::shared_ptr<Data> ScarceMatrixData::clone() const
+{
+   return std::make_shared<ScarceMatrixData>(*this);
+}
+
 void ScarceMatrixData::init_pre()
 {
    MatrixDataTempl<SparseMatrix<double> >::init_pre();
@@ -64,13 +70,18 @@ void ScarceMatrixData::getMuLambda(const SubModel& model, std::uint32_t mode, in
 
        for(int i = from; i < to; ++i)
        {
+           const double w = weight(mode, i);
+           if (w == 0.0)
+              continue;
+
            auto val = Y.valuePtr()[i];
            auto idx = Y.innerIndexPtr()[i];
            const auto &col = Vf.col(idx);
            auto pos = this->pos(mode, n, idx);
-           double noisy_val = ns.sample(model, pos, val);
+           double noisy_val = ns.sample(model, pos, val) * w;
+           double alpha = ns.getAlpha() * w;
            rr.noalias() += col * noisy_val;
-           MM.triangularView<Lower>() +=  ns.getAlpha() * col * col.transpose();
+           MM.triangularView<Lower>() +=  alpha * col * col.transpose();
        }
 
        // make MM complete
@@ -110,6 +121,40 @@ void ScarceMatrixData::getMuLambda(const SubModel& model, std::uint32_t mode, in
    }
 }
 
+void ScarceMatrixData::getGradient(const SubModel& model, std::uint32_t mode, int n, int batch_size, VectorXd& grad, VectorXd& hess) const
+{
+   COUNTER("getGradient");
+
+   auto &Y = this->Y(mode);
+   auto Vf = *model.CVbegin(mode);
+   const auto u = model.U(mode).col(n);
+   auto &ns = noise();
+
+   const std::int64_t from = Y.outerIndexPtr()[n];
+   const std::int64_t local_nnz = Y.outerIndexPtr()[n + 1] - from;
+   if (local_nnz == 0)
+      return;
+
+   // all entries of a short column, else a sample with replacement
+   const bool all = local_nnz <= batch_size;
+   const std::int64_t nbatch = all ? local_nnz : batch_size;
+   const double scale = (double)local_nnz / nbatch;
+
+   for (std::int64_t b = 0; b < nbatch; ++b)
+   {
+      std::int64_t i = from + (all ? b : std::min((std::int64_t)(rand_unif() * local_nnz), local_nnz - 1));
+
+      auto val = Y.valuePtr()[i];
+      auto idx = Y.innerIndexPtr()[i];
+      const auto &col = Vf.col(idx);
+      auto pos = this->pos(mode, n, idx);
+      double noisy_val = ns.sample(model, pos, val);
+      double alpha = ns.getAlpha();
+      grad.noalias() += (scale * (noisy_val - alpha * col.dot(u))) * col;
+      hess.noalias() += (scale * alpha) * col.cwiseAbs2();
+   }
+}
+
 void ScarceMatrixData::update_pnm(const SubModel &, std::uint32_t mode)
 {
    //can not cache VV because of scarceness
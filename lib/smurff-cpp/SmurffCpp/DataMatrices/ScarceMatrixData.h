@@ -6,12 +6,14 @@ namespace smurff
 {
    class ScarceMatrixData : public MatrixDataTempl<Eigen::SparseMatrix<double> >
    {
-   private:
+   protected:
       int num_empty[2] = {0,0};
 
    public:
       ScarceMatrixData(Eigen::SparseMatrix<double> Y);
 
+      std::shared_ptr<Data> clone() const override;
+
    public:
       void init_pre() override;
       
@@ -20,6 +22,7 @@ namespace smurff
       std::ostream& info(std::ostream& os, std::string indent) override;
 
       void getMuLambda(const SubModel& model, std::uint32_t mode, int d, Eigen::VectorXd& rr, Eigen::MatrixXd& MM) const override;
+      void getGradient(const SubModel& model, std::uint32_t mode, int d, int batch_size, Eigen::VectorXd& grad, Eigen::VectorXd& hess) const override;
       void update_pnm(const SubModel& model, std::uint32_t mode) override;
 
       std::uint64_t nna() const override;
@@ -28,5 +31,12 @@ namespace smurff
       double var_total() const override;
       
       double sumsq(const SubModel& model) const override;
+
+   protected:
+      // weight in the likelihood of stored value <i> of Y(mode), 0 leaves it out
+      virtual double weight(std::uint32_t mode, std::int64_t i) const
+      {
+         return 1.0;
+      }
    };
 }
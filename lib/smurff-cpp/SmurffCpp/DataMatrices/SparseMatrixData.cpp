@@ -9,6 +9,11 @@ SparseMatrixData::SparseMatrixData(SparseMatrix<double> Y)
    this->name = "SparseMatrixData [fully known]";
 }
 
+std::shared_ptr<Data> SparseMatrixData::clone() const
+{
+   return std::make_shared<SparseMatrixData>(*this);
+}
+
 void SparseMatrixData::getMuLambda(const SubModel& model, uint32_t mode, int d, VectorXd& rr, MatrixXd& MM) const
 {
     const auto& Y = this->Y(mode);
@@ -9,6 +9,8 @@ namespace smurff
    public:
       SparseMatrixData(Eigen::SparseMatrix<double> Y);
 
+      std::shared_ptr<Data> clone() const override;
+
       void getMuLambda(const SubModel& model, std::uint32_t mode, int d, Eigen::VectorXd& rr, Eigen::MatrixXd& MM) const override;
 
    public:
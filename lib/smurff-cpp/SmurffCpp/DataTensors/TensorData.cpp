@@ -40,6 +40,11 @@ TensorData::TensorData(const smurff::TensorConfig& tc)
    this->name = totalSize == m_nnz ? "TensorData [fully known]" : "TensorData [with NAs]";
 }
 
+std::shared_ptr<Data> TensorData::clone() const
+{
+   return std::make_shared<TensorData>(*this);
+}
+
 std::shared_ptr<SparseMode> TensorData::Y(std::uint64_t mode) const
 {
    return m_Y->operator[](mode);
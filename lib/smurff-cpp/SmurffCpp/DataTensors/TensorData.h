@@ -25,6 +25,8 @@ private:
 public:
    TensorData(const smurff::TensorConfig& tc);
 
+   std::shared_ptr<Data> clone() const override;
+
    std::shared_ptr<SparseMode> Y(std::uint64_t mode) const;
 
 protected:
@@ -12,6 +12,7 @@
 #include <SmurffCpp/Utils/Error.h>
 
 #include <SmurffCpp/IO/GenericIO.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
 
 using namespace smurff;
 
@@ -152,6 +153,123 @@ std::shared_ptr<MatrixConfig> matrix_io::read_matrix(const std::string& filename
    return ret;
 }
 
+std::uint64_t matrix_io::read_matrix_nrow(const std::string& filename)
+{
+   MatrixType matrixType = ExtensionToMatrixType(filename);
+   if (matrixType != matrix_io::MatrixType::sdm && matrixType != matrix_io::MatrixType::sbm && matrixType != matrix_io::MatrixType::ddm)
+      return read_matrix(filename, false)->getNRow();
+
+   THROWERROR_FILE_NOT_EXIST(filename);
+   std::ifstream fileStream(filename, std::ios_base::binary);
+   THROWERROR_ASSERT_MSG(fileStream.is_open(), "Error opening file: " + filename);
+
+   std::uint64_t nrow;
+   fileStream.read(reinterpret_cast<char*>(&nrow), sizeof(std::uint64_t));
+   return nrow;
+}
+
+namespace {
+
+// entries [0, nnz) of a binary array of T, the callback gets each chunk and the index of its first entry
+template<typename T, typename Chunk>
+void read_chunks(std::istream& in, std::uint64_t nnz, Chunk chunk)
+{
+   const std::uint64_t chunk_size = 1 << 20;
+   std::vector<T> buf;
+   for (std::uint64_t first = 0; first < nnz; first += chunk_size)
+   {
+      buf.resize(std::min(chunk_size, nnz - first));
+      in.read(reinterpret_cast<char*>(buf.data()), buf.size() * sizeof(T));
+      chunk(buf, first);
+   }
+}
+
+}
+
+std::shared_ptr<MatrixConfig> matrix_io::read_matrix_rows(const std::string& filename, bool isScarce, std::uint64_t begin, std::uint64_t end)
+{
+   MatrixType matrixType = ExtensionToMatrixType(filename);
+   if (matrixType != matrix_io::MatrixType::sdm && matrixType != matrix_io::MatrixType::sbm && matrixType != matrix_io::MatrixType::ddm)
+   {
+      auto ret = matrix_utils::row_slice(*read_matrix(filename, isScarce), begin, end);
+      ret->setFilename(filename);
+      return ret;
+   }
+
+   THROWERROR_FILE_NOT_EXIST(filename);
+   std::ifstream in(filename, std::ios_base::binary);
+   THROWERROR_ASSERT_MSG(in.is_open(), "Error opening file: " + filename);
+
+   std::uint64_t nrow;
+   std::uint64_t ncol;
+   in.read(reinterpret_cast<char*>(&nrow), sizeof(std::uint64_t));
+   in.read(reinterpret_cast<char*>(&ncol), sizeof(std::uint64_t));
+   THROWERROR_ASSERT_MSG(begin <= end && end <= nrow, "Row range out of bounds in " + filename);
+
+   std::shared_ptr<MatrixConfig> ret;
+   if (matrixType == matrix_io::MatrixType::ddm)
+   {
+      // values are stored column-major, the rows of a column are contiguous
+      std::vector<double> values((end - begin) * ncol);
+      for (std::uint64_t c = 0; c < ncol; c++)
+      {
+         in.seekg(2 * sizeof(std::uint64_t) + (c * nrow + begin) * sizeof(double));
+         in.read(reinterpret_cast<char*>(values.data() + c * (end - begin)), (end - begin) * sizeof(double));
+      }
+      ret = std::make_shared<smurff::MatrixConfig>(end - begin, ncol, std::move(values), smurff::NoiseConfig());
+   }
+   else
+   {
+      std::uint64_t nnz;
+      in.read(reinterpret_cast<char*>(&nnz), sizeof(std::uint64_t));
+
+      // rows are 1-based, keep the entries of [begin, end)
+      std::vector<std::uint64_t> keep;
+      std::vector<std::uint32_t> rows;
+      read_chunks<std::uint32_t>(in, nnz, [&](const std::vector<std::uint32_t>& buf, std::uint64_t first)
+      {
+         for (std::size_t i = 0; i < buf.size(); i++)
+         {
+            if (buf[i] > begin && buf[i] <= end)
+            {
+               keep.push_back(first + i);
+               rows.push_back(buf[i] - 1 - begin);
+            }
+         }
+      });
+
+      std::vector<std::uint32_t> cols;
+      cols.reserve(keep.size());
+      auto k = keep.begin();
+      read_chunks<std::uint32_t>(in, nnz, [&](const std::vector<std::uint32_t>& buf, std::uint64_t first)
+      {
+         for (; k != keep.end() && *k < first + buf.size(); ++k)
+            cols.push_back(buf[*k - first] - 1);
+      });
+
+      if (matrixType == matrix_io::MatrixType::sbm)
+      {
+         ret = std::make_shared<smurff::MatrixConfig>(end - begin, ncol, std::move(rows), std::move(cols), smurff::NoiseConfig(), isScarce);
+      }
+      else
+      {
+         std::vector<double> values;
+         values.reserve(keep.size());
+         k = keep.begin();
+         read_chunks<double>(in, nnz, [&](const std::vector<double>& buf, std::uint64_t first)
+         {
+            for (; k != keep.end() && *k < first + buf.size(); ++k)
+               values.push_back(buf[*k - first]);
+         });
+         ret = std::make_shared<smurff::MatrixConfig>(end - begin, ncol, std::move(rows), std::move(cols), std::move(values), smurff::NoiseConfig(), isScarce);
+      }
+   }
+
+   THROWERROR_ASSERT_MSG(in.good(), "Error reading file: " + filename);
+   ret->setFilename(filename);
+   return ret;
+}
+
 std::shared_ptr<MatrixConfig> matrix_io::read_dense_float64_bin(std::istream& in)
 {
    std::uint64_t nrow;
@@ -41,6 +41,13 @@ namespace smurff { namespace matrix_io
 
    std::shared_ptr<MatrixConfig> read_matrix(const std::string& filename, bool isScarce);
 
+   // number of rows, only the header of the binary formats is read
+   std::uint64_t read_matrix_nrow(const std::string& filename);
+
+   // rows [begin, end) of a matrix file, the binary formats are read without
+   // holding the other rows in memory, the text formats are read completely and sliced
+   std::shared_ptr<MatrixConfig> read_matrix_rows(const std::string& filename, bool isScarce, std::uint64_t begin, std::uint64_t end);
+
    std::shared_ptr<MatrixConfig> read_dense_float64_bin(std::istream& in);
    std::shared_ptr<MatrixConfig> read_dense_float64_csv(std::istream& in);
 
@@ -5,6 +5,7 @@
 #include <chrono>
 #include <memory>
 #include <cmath>
+#include <numeric>
 #include <signal.h>
 
 #include <unsupported/Eigen/SparseExtra>
@@ -23,6 +24,7 @@
 
 #include <SmurffCpp/Utils/Error.h>
 #include <SmurffCpp/Utils/StepFile.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
 
 #include <SmurffCpp/IO/GenericIO.h>
 
@@ -44,6 +46,9 @@ void Model::init(int num_latent, const PVec<>& dims, ModelInitTypes model_init_t
    m_num_latent = num_latent;
    m_dims = std::unique_ptr<PVec<> >(new PVec<>(dims));
 
+   m_active_latents.resize(m_num_latent);
+   std::iota(m_active_latents.begin(), m_active_latents.end(), 0);
+
    for(size_t i = 0; i < dims.size(); ++i)
    {
       std::shared_ptr<Eigen::MatrixXd> sample(new Eigen::MatrixXd(m_num_latent, dims[i]));
@@ -51,6 +56,7 @@ void Model::init(int num_latent, const PVec<>& dims, ModelInitTypes model_init_t
       switch(model_init_type)
       {
       case ModelInitTypes::random:
+      case ModelInitTypes::als: //refined by the session once the priors are set up
          bmrandn(*sample);
          break;
       case ModelInitTypes::zero:
@@ -128,6 +134,32 @@ int Model::nsamples() const
       [](const int &a, const std::shared_ptr<Eigen::MatrixXd> &b) { return a + b->cols(); });
 }
 
+const std::vector<int>& Model::getActiveLatents() const
+{
+   return m_active_latents;
+}
+
+bool Model::isPruned() const
+{
+   return !m_active_latents.empty() && m_active_latents.back() != (int)m_active_latents.size() - 1;
+}
+
+void Model::prune_latents(const std::vector<int>& keep)
+{
+   THROWERROR_ASSERT_MSG(!keep.empty(), "At least one latent dimention has to be kept");
+
+   for (auto U : m_samples)
+      smurff::matrix_utils::keep_rows(*U, keep);
+
+   std::vector<int> active_latents;
+   for (int k : keep)
+      active_latents.push_back(m_active_latents.at(k));
+   m_active_latents.swap(active_latents);
+
+   m_num_latent = keep.size();
+   Pcache.init(ArrayXd::Ones(m_num_latent));
+}
+
 const PVec<>& Model::getDims() const
 {
    return *m_dims;
@@ -35,6 +35,7 @@ class Model : public std::enable_shared_from_this<Model>
 private:
    std::vector<std::shared_ptr<Eigen::MatrixXd>> m_samples; //vector of U matrices
    int m_num_latent; //size of latent dimention for U matrices
+   std::vector<int> m_active_latents; //original index of every latent dimention still in the model
    std::unique_ptr<PVec<> > m_dims; //dimentions of train data
 
    // to make predictions faster
@@ -80,6 +81,15 @@ public:
    //sum of number of columns in each U matrix in the model
    int nsamples() const;
 
+   //original indices of the latent dimentions, differs from 0 .. nlatent()-1 after pruning
+   const std::vector<int>& getActiveLatents() const;
+
+   bool isPruned() const;
+
+public:
+   //drops all latent dimentions not listed in keep (indices into the current dimentions)
+   void prune_latents(const std::vector<int>& keep);
+
 public:
    //vector if dimention sizes of train data
    const PVec<>& getDims() const;
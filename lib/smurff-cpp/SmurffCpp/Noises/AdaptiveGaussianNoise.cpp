@@ -13,6 +13,11 @@ AdaptiveGaussianNoise::AdaptiveGaussianNoise(double sinit, double smax)
 
 }
 
+std::shared_ptr<INoiseModel> AdaptiveGaussianNoise::clone() const
+{
+   return std::shared_ptr<INoiseModel>(new AdaptiveGaussianNoise(*this));
+}
+
 void AdaptiveGaussianNoise::init(const Data* data)
 {
    INoiseModel::init(data);
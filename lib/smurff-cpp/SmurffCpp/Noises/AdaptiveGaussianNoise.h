@@ -25,6 +25,9 @@ namespace smurff {
    protected:
       AdaptiveGaussianNoise(double sinit = 1., double smax = 10.);
 
+   public:
+      std::shared_ptr<INoiseModel> clone() const override;
+
    public:
       void init(const Data* data) override;
       void update(const SubModel& model) override;
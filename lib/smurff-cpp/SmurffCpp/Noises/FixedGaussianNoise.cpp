@@ -10,6 +10,11 @@ FixedGaussianNoise::FixedGaussianNoise(double a)
     alpha = a;
 }
 
+std::shared_ptr<INoiseModel> FixedGaussianNoise::clone() const
+{
+   return std::shared_ptr<INoiseModel>(new FixedGaussianNoise(*this));
+}
+
 std::ostream& FixedGaussianNoise::info(std::ostream& os, std::string indent)
 {
    os << "Fixed gaussian noise with precision: " << std::fixed << std::setprecision(2) << alpha << std::endl;
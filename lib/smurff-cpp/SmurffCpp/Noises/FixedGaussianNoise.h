@@ -17,6 +17,9 @@ namespace smurff {
    protected:
       FixedGaussianNoise(double a = 1.);
 
+   public:
+      std::shared_ptr<INoiseModel> clone() const override;
+
    public:
       std::ostream& info(std::ostream& os, std::string indent)  override;
       std::string getStatus() override;
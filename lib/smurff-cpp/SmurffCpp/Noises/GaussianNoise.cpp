@@ -9,3 +9,8 @@ double GaussianNoise::getAlpha() const
 {
     return alpha;
 }
+
+void GaussianNoise::for_each_param(const std::function<void(double*, std::size_t)>& f)
+{
+   f(&alpha, 1);
+}
@@ -15,6 +15,8 @@ namespace smurff {
 
    public:
       double getAlpha() const override;
+
+      void for_each_param(const std::function<void(double*, std::size_t)>& f) override;
    };
 
 }
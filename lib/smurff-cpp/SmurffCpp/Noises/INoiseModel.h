@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
+#include <memory>
 #include <iostream>
+#include <functional>
 
 #include <Eigen/Core>
 
@@ -35,11 +37,18 @@ namespace smurff {
       virtual void update(const SubModel & model) {}
       const Data& data() const { return *m_data; }
 
+   public:
+      // a copy with its own state, not yet bound to a data object
+      virtual std::shared_ptr<INoiseModel> clone() const = 0;
+
    public:
       virtual std::ostream &info(std::ostream &os, std::string indent)   = 0;
       virtual std::string getStatus()  = 0;
 
       virtual double getAlpha() const;
+
+      // calls f with the data and size of every parameter that update writes, none by default
+      virtual void for_each_param(const std::function<void(double*, std::size_t)>& f) {}
       virtual double sample(const SubModel& model, const PVec<> &pos, double val);
    };
 }
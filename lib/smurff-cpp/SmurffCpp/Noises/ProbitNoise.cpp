@@ -13,6 +13,11 @@ ProbitNoise::ProbitNoise(double t)
 
 }
 
+std::shared_ptr<INoiseModel> ProbitNoise::clone() const
+{
+   return std::shared_ptr<INoiseModel>(new ProbitNoise(*this));
+}
+
 /* original code from jaak:
  *
  * double y = 2 * it.value() - 1; // y == sign (-1. or +1.)
@@ -20,6 +20,9 @@ namespace smurff {
    protected:
       ProbitNoise(double threshold = 0.0);
 
+   public:
+      std::shared_ptr<INoiseModel> clone() const override;
+
    public:
       double sample(const SubModel& model, const PVec<> &pos, double val) override;
 
@@ -9,6 +9,11 @@ UnusedNoise::UnusedNoise()
 {
 }
 
+std::shared_ptr<INoiseModel> UnusedNoise::clone() const
+{
+   return std::shared_ptr<INoiseModel>(new UnusedNoise(*this));
+}
+
 double UnusedNoise::getAlpha() const 
 {
    THROWERROR_NOTIMPL();
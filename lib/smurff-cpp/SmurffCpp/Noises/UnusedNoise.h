@@ -16,6 +16,9 @@ class UnusedNoise : public INoiseModel
 protected:
    UnusedNoise();
 
+public:
+   std::shared_ptr<INoiseModel> clone() const override;
+
 public:
    double getAlpha() const override;
    double sample(const SubModel& model, const PVec<> &pos, double val) override;
@@ -0,0 +1,14 @@
+#include "CachedPriorFactory.h"
+
+using namespace smurff;
+
+std::shared_ptr<ISideInfo> CachedPriorFactory::create_side_info(std::shared_ptr<SideInfoConfig> item, int mode)
+{
+   // the dims are shared by all copies of a MatrixConfig
+   auto key = std::make_pair((const void*)item->getSideInfo()->getDimsPtr().get(), mode);
+
+   auto& side_info = (*m_cache)[key];
+   if (!side_info)
+      side_info = PriorFactory::create_side_info(item, mode);
+   return side_info;
+}
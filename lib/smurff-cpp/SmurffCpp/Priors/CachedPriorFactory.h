@@ -0,0 +1,32 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include <SmurffCpp/Priors/PriorFactory.h>
+
+namespace smurff {
+
+// creates the features of every side info matrix once,
+// sessions handed the same cache share them
+class CachedPriorFactory : public PriorFactory
+{
+public:
+   // keyed by the loaded matrix, copies of a SideInfoConfig share the features
+   // as long as they keep its storage options
+   typedef std::map<std::pair<const void*, int>, std::shared_ptr<ISideInfo> > Cache;
+
+private:
+   std::shared_ptr<Cache> m_cache;
+
+public:
+   CachedPriorFactory(std::shared_ptr<Cache> cache)
+      : m_cache(cache)
+   {
+   }
+
+   std::shared_ptr<ISideInfo> create_side_info(std::shared_ptr<SideInfoConfig> item, int mode) override;
+};
+
+}
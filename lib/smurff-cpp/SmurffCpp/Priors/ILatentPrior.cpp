@@ -1,5 +1,10 @@
 #include "ILatentPrior.h"
 #include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
+#include <SmurffCpp/Utils/StepFile.h>
+#include <SmurffCpp/IO/GenericIO.h>
+#include <SmurffCpp/IO/MatrixIO.h>
 
 using namespace smurff;
 using namespace Eigen;
@@ -14,6 +19,7 @@ void ILatentPrior::init()
 {
    rrs.init(VectorXd::Zero(num_latent()));
    MMs.init(MatrixXd::Zero(num_latent(), num_latent()));
+   hesses.init(VectorXd::Zero(num_latent()));
 
    //this is some new initialization
    init_Usum();
@@ -97,20 +103,93 @@ bool ILatentPrior::run_slave()
 }
 
 void ILatentPrior::sample_latents()
+{
+   sample_all_latents();
+   m_session->update_prior(*this);
+}
+
+void ILatentPrior::sample_all_latents()
 {
    COUNTER("sample_latents");
+   update_all_latents([this](int n) { sample_latent(n); });
+}
+
+void ILatentPrior::als_sweep(double reg)
+{
+   COUNTER("als_sweep");
+   update_all_latents([this, reg](int n) { als_latent(n, reg); });
+}
+
+Eigen::VectorXd ILatentPrior::als_mean(int n) const
+{
+   return VectorXd::Zero(num_latent());
+}
+
+void ILatentPrior::als_latent(int n, double reg)
+{
+   VectorXd &rr = rrs.local();
+   MatrixXd &MM = MMs.local();
+
+   rr.setZero();
+   MM.setZero();
+
+   data().getMuLambda(model(), m_mode, n, rr, MM);
+
+   rr.noalias() += reg * als_mean(n);
+   MM.diagonal().array() += reg;
+
+   U().col(n) = MM.llt().solve(rr);
+}
+
+void ILatentPrior::sgld_latent(int n, double step, int batch_size)
+{
+   VectorXd &grad = rrs.local();
+   grad.setZero();
+   VectorXd &G = hesses.local();
+   G.setZero();
+
+   data().getGradient(model(), m_mode, n, batch_size, grad, G);
+   prior_gradient(n, grad, G);
+
+   // Langevin step in the metric G = hess^-1: u += step / 2 * G * grad + N(0, step * G)
+   G = G.cwiseInverse();
+   U().col(n).noalias() += (0.5 * step) * G.cwiseProduct(grad) + (step * G).cwiseSqrt().cwiseProduct(nrandn(num_latent()));
+}
+
+void ILatentPrior::sgld_update_prior()
+{
+   init_Usum();
+   m_session->end_sample_latents(m_mode, Usum, UUsum);
+   m_session->update_prior(*this);
+}
+
+void ILatentPrior::prior_gradient(int n, VectorXd& grad, VectorXd& hess) const
+{
+   THROWERROR("Stochastic gradients are not supported by " + m_name);
+}
+
+void ILatentPrior::for_each_hyper(const std::function<void(double*, std::size_t)>& f)
+{
+   THROWERROR("Sharing the hyperparameters is not supported by " + m_name);
+}
+
+void ILatentPrior::update_all_latents(const std::function<void(int)>& update_latent)
+{
    data().update_pnm(model(), m_mode);
 
    // for effiency, we keep + update Ucol and UUcol by every thread
    thread_vector<VectorXd> Ucol(VectorXd::Zero(num_latent()));
    thread_vector<MatrixXd> UUcol(MatrixXd::Zero(num_latent(), num_latent()));
 
+   int begin, end;
+   m_session->begin_sample_latents(m_mode, begin, end);
+
    #pragma omp parallel for schedule(guided)
-   for(int n = 0; n < U().cols(); n++)
+   for(int n = begin; n < end; n++)
    {
        #pragma omp task
        {
-           sample_latent(n);
+           update_latent(n);
            const auto& col = U().col(n);
            Ucol.local().noalias() += col;
            UUcol.local().noalias() += col * col.transpose();
@@ -120,7 +199,28 @@ void ILatentPrior::sample_latents()
    Usum  = Ucol.combine();
    UUsum = UUcol.combine();
 
+   m_session->end_sample_latents(m_mode, Usum, UUsum);
+}
+
+std::function<void()> ILatentPrior::start_update_prior()
+{
    update_prior();
+   return std::function<void()>();
+}
+
+bool ILatentPrior::latent_active(int k) const
+{
+   return true;
+}
+
+void ILatentPrior::prune_latents(const std::vector<int>& keep)
+{
+   rrs.init(VectorXd::Zero(num_latent()));
+   MMs.init(MatrixXd::Zero(num_latent(), num_latent()));
+   hesses.init(VectorXd::Zero(num_latent()));
+
+   matrix_utils::keep_rows(Usum, keep);
+   matrix_utils::keep_rows_cols(UUsum, keep);
 }
 
 void ILatentPrior::save(std::shared_ptr<const StepFile> sf) const
@@ -130,7 +230,31 @@ void ILatentPrior::save(std::shared_ptr<const StepFile> sf) const
 void ILatentPrior::restore(std::shared_ptr<const StepFile> sf)
 {
     init_Usum();
-    update_prior();
+    m_session->update_prior(*this);
+}
+
+void ILatentPrior::warm_start(std::shared_ptr<const StepFile> sf, int num_old)
+{
+    THROWERROR_ASSERT(num_old <= num_cols());
+
+    if (num_old < num_cols())
+        init_appended(sf, num_old);
+
+    init_Usum();
+    m_session->update_prior(*this);
+}
+
+void ILatentPrior::init_appended(std::shared_ptr<const StepFile> sf, int num_old)
+{
+    //mu is saved with the hyperparameters, otherwise it is estimated from the restored columns
+    VectorXd mean = VectorXd::Zero(num_latent());
+    std::string muPath = sf->getMuFileName(m_mode);
+    if (generic_io::file_exists(muPath))
+        smurff::matrix_io::eigen::read_matrix(muPath, mean);
+    else if (num_old > 0)
+        mean = U().leftCols(num_old).rowwise().mean();
+
+    U().rightCols(num_cols() - num_old).colwise() = mean;
 }
 
 void ILatentPrior::init_Usum()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
@@ -29,6 +30,7 @@ public:
 
    smurff::thread_vector<Eigen::VectorXd> rrs;
    smurff::thread_vector<Eigen::MatrixXd> MMs;
+   smurff::thread_vector<Eigen::VectorXd> hesses; //used by sgld_latent
 
 protected:
    ILatentPrior(){}
@@ -67,6 +69,10 @@ public:
 
    virtual void save(std::shared_ptr<const StepFile> sf) const;
    virtual void restore(std::shared_ptr<const StepFile> sf);
+
+   // warm start from the last sample of a previous run: the first <num_old> columns of U
+   // hold the restored entities, the appended ones are set by init_appended
+   void warm_start(std::shared_ptr<const StepFile> sf, int num_old);
    virtual std::ostream &info(std::ostream &os, std::string indent);
    virtual std::ostream &status(std::ostream &os, std::string indent) const = 0;
 
@@ -76,9 +82,57 @@ public:
    virtual void sample_latents();
    virtual void sample_latent(int n) = 0;
 
+   // samples all columns of U, without updating the prior
+   void sample_all_latents();
+
+   // one sweep of alternating least squares over all columns of U, without updating the prior:
+   // the normal equations of getMuLambda plus <reg> * I towards the prior mean, solved without the noise draw
+   virtual void als_sweep(double reg);
+
+   // one preconditioned stochastic gradient Langevin step of column n of U, the gradient is estimated
+   // from a minibatch of at most <batch_size> of its entries, the metric is the inverse of the diagonal
+   // of its posterior precision. Reads the other modes while they are updated (lock-free)
+   void sgld_latent(int n, double step, int batch_size);
+
+   // updates the prior after the sgld steps of all columns of U
+   void sgld_update_prior();
+
    virtual void update_prior() = 0;
 
+   // pipelined update_prior: draws all random numbers of the update now and
+   // returns the deterministic remainder (empty if there is none), which can
+   // run concurrently with the sampling of the other modes
+   virtual std::function<void()> start_update_prior();
+
+   // calls f with the data and size of every array that update_prior writes,
+   // so another process can receive them instead of running the update
+   virtual void for_each_hyper(const std::function<void(double*, std::size_t)>& f);
+
+   // false if the prior has switched latent dimention k off for good
+   virtual bool latent_active(int k) const;
+
+   // drops the state of the latent dimentions not listed in keep,
+   // called after the model itself has been pruned
+   virtual void prune_latents(const std::vector<int>& keep);
+
+protected:
+   // columns num_old .. num_cols() - 1 of U start at the prior mean saved in sf,
+   // or at the mean of the restored columns if sf has no hyperparameters
+   virtual void init_appended(std::shared_ptr<const StepFile> sf, int num_old);
+
+   // prior mean of column n that the als init regularizes towards, zero by default
+   virtual Eigen::VectorXd als_mean(int n) const;
+
+   // adds the gradient of the log prior density of column n of U to <grad> and the diagonal
+   // of its precision to <hess>, used by sgld_latent. Not supported by default
+   virtual void prior_gradient(int n, Eigen::VectorXd& grad, Eigen::VectorXd& hess) const;
+
 private:
+   // updates every column of U with <update_latent>, and the sums over the columns
+   void update_all_latents(const std::function<void(int)>& update_latent);
+
+   void als_latent(int n, double reg);
+
    void init_Usum();
    Eigen::VectorXd Usum;
    Eigen::MatrixXd UUsum;
@@ -4,6 +4,9 @@
 #include <SmurffCpp/IO/GenericIO.h>
 
 #include <SmurffCpp/Utils/linop.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
+
+#include <SmurffCpp/SideInfo/CompositeSideInfo.h>
 
 using namespace smurff;
 
@@ -23,6 +26,15 @@ void MacauOnePrior::init()
    Uhat = Eigen::MatrixXd::Constant(num_latent(), Features->rows(), 0.0);
    beta = Eigen::MatrixXd::Constant(num_latent(), Features->cols(), 0.0);
 
+   // parallel over features only pays off if the color classes are not too small
+   feature_colors.clear();
+   if (!Features->is_dense())
+   {
+      Features->color_cols(feature_colors);
+      if (feature_colors.size() * 4 > (std::size_t)Features->cols())
+         feature_colors.clear();
+   }
+
    // initial value (should be determined automatically)
    // Hyper-prior for beta_precision (mean 1.0):
    beta_precision = Eigen::VectorXd::Constant(num_latent(), bp0);
@@ -40,6 +52,24 @@ void MacauOnePrior::update_prior()
       sample_beta_precision();
 }
 
+void MacauOnePrior::for_each_hyper(const std::function<void(double*, std::size_t)>& f)
+{
+   NormalOnePrior::for_each_hyper(f);
+
+   f(beta.data(), beta.size());
+   f(Uhat.data(), Uhat.size());
+   f(beta_precision.data(), beta_precision.size());
+}
+
+void MacauOnePrior::prune_latents(const std::vector<int>& keep)
+{
+   NormalOnePrior::prune_latents(keep);
+
+   matrix_utils::keep_rows(beta, keep);
+   matrix_utils::keep_rows(Uhat, keep);
+   matrix_utils::keep_rows(beta_precision, keep);
+}
+
 const Eigen::VectorXd MacauOnePrior::getMu(int n) const
 {
    return this->mu + Uhat.col(n);
@@ -51,9 +81,12 @@ void MacauOnePrior::addSideInfo(const std::shared_ptr<ISideInfo>& side_info_a, d
 
    // old code
 
-   Features = side_info_a;
-   bp0 = beta_precision_a;
-   enable_beta_precision_sampling = enable_beta_precision_sampling_a;
+   // settings come from the first side info, all blocks share them
+   if (side_info_values.empty())
+   {
+      bp0 = beta_precision_a;
+      enable_beta_precision_sampling = enable_beta_precision_sampling_a;
+   }
 
    // new code
 
@@ -62,6 +95,12 @@ void MacauOnePrior::addSideInfo(const std::shared_ptr<ISideInfo>& side_info_a, d
    beta_precision_values.push_back(beta_precision_a);
    enable_beta_precision_sampling_values.push_back(enable_beta_precision_sampling_a);
 
+   // several side infos act as one horizontal concatenation
+   if (side_info_values.size() == 1)
+      Features = side_info_a;
+   else
+      Features = std::make_shared<CompositeSideInfo>(side_info_values);
+
    // other code
 
    F_colsq = Features->col_square_sum();
@@ -69,9 +108,14 @@ void MacauOnePrior::addSideInfo(const std::shared_ptr<ISideInfo>& side_info_a, d
 
 void MacauOnePrior::sample_beta(const Eigen::MatrixXd &U)
 {
+   if (!feature_colors.empty())
+   {
+      sample_beta_colored(U);
+      return;
+   }
+
    // updating beta and beta_var
    const int nfeat = beta.cols();
-   const int N = U.cols();
    const int blocksize = 4;
 
    Eigen::MatrixXd Z;
@@ -81,41 +125,85 @@ void MacauOnePrior::sample_beta(const Eigen::MatrixXd &U)
    {
       const int dcount = std::min(blocksize, num_latent() - dstart);
       Z.resize(dcount, U.cols());
+      compute_beta_residual(Z, U, dstart);
 
-      for (int i = 0; i < N; i++)
+      for (int f = 0; f < nfeat; f++)
       {
-         for (int d = 0; d < dcount; d++)
-         {
-            int dx = d + dstart;
-            Z(d, i) = U(dx, i) - mu(dx) - Uhat(dx, i);
-         }
+         sample_beta_feature(Z, dstart, f);
       }
+   }
+}
 
-      for (int f = 0; f < nfeat; f++)
+void MacauOnePrior::sample_beta_colored(const Eigen::MatrixXd &U)
+{
+   const int blocksize = 4;
+   const int nblocks = (num_latent() + blocksize - 1) / blocksize;
+
+   std::vector<Eigen::MatrixXd> Z(nblocks);
+
+   #pragma omp parallel for schedule(static, 1)
+   for (int b = 0; b < nblocks; b++)
+   {
+      const int dstart = b * blocksize;
+      Z[b].resize(std::min(blocksize, num_latent() - dstart), U.cols());
+      compute_beta_residual(Z[b], U, dstart);
+   }
+
+   // within a color every (latent block, feature) pair writes its own
+   // rows of beta and its own columns of Z
+   for (const auto &color : feature_colors)
+   {
+      const int ntasks = nblocks * color.size();
+
+      #pragma omp parallel for schedule(static)
+      for (int t = 0; t < ntasks; t++)
       {
-         Eigen::VectorXd zx(dcount), delta_beta(dcount), randvals(dcount);
-         // zx = Z[dstart : dstart + dcount, :] * F[:, f]
-         Features->At_mul_Bt(zx, f, Z);
-         // TODO: check if sampling randvals for whole [nfeat x dcount] matrix works faster
-         bmrandn_single(randvals);
+         const int b = t % nblocks;
+         sample_beta_feature(Z[b], b * blocksize, color[t / nblocks]);
+      }
+   }
+}
 
-         for (int d = 0; d < dcount; d++)
-         {
-            int dx = d + dstart;
-            double A_df = beta_precision(dx) + Lambda(dx, dx) * F_colsq(f);
-            double B_df = Lambda(dx, dx) * (zx(d) + beta(dx, f) * F_colsq(f));
-            double A_inv = 1.0 / A_df;
-            double beta_new = B_df * A_inv + std::sqrt(A_inv) * randvals(d);
-            delta_beta(d) = beta(dx, f) - beta_new;
-
-            beta(dx, f) = beta_new;
-         }
-         // Z[dstart : dstart + dcount, :] += F[:, f] * delta_beta'
-         Features->add_Acol_mul_bt(Z, f, delta_beta);
+void MacauOnePrior::compute_beta_residual(Eigen::MatrixXd &Z, const Eigen::MatrixXd &U, const int dstart) const
+{
+   const int N = U.cols();
+   const int dcount = Z.rows();
+
+   for (int i = 0; i < N; i++)
+   {
+      for (int d = 0; d < dcount; d++)
+      {
+         int dx = d + dstart;
+         Z(d, i) = U(dx, i) - mu(dx) - Uhat(dx, i);
       }
    }
 }
 
+void MacauOnePrior::sample_beta_feature(Eigen::MatrixXd &Z, const int dstart, const int f)
+{
+   const int dcount = Z.rows();
+
+   Eigen::VectorXd zx(dcount), delta_beta(dcount), randvals(dcount);
+   // zx = Z[dstart : dstart + dcount, :] * F[:, f]
+   Features->At_mul_Bt(zx, f, Z);
+   // TODO: check if sampling randvals for whole [nfeat x dcount] matrix works faster
+   bmrandn_single(randvals);
+
+   for (int d = 0; d < dcount; d++)
+   {
+      int dx = d + dstart;
+      double A_df = beta_precision(dx) + Lambda(dx, dx) * F_colsq(f);
+      double B_df = Lambda(dx, dx) * (zx(d) + beta(dx, f) * F_colsq(f));
+      double A_inv = 1.0 / A_df;
+      double beta_new = B_df * A_inv + std::sqrt(A_inv) * randvals(d);
+      delta_beta(d) = beta(dx, f) - beta_new;
+
+      beta(dx, f) = beta_new;
+   }
+   // Z[dstart : dstart + dcount, :] += F[:, f] * delta_beta'
+   Features->add_Acol_mul_bt(Z, f, delta_beta);
+}
+
 void MacauOnePrior::sample_mu_lambda(const Eigen::MatrixXd &U)
 {
    Eigen::MatrixXd WI(num_latent(), num_latent());
@@ -167,6 +255,10 @@ void MacauOnePrior::save(std::shared_ptr<const StepFile> sf) const
 {
    NormalOnePrior::save(sf);
 
+   // cold-start predictions and warm starts need mu next to the link matrix
+   if (!m_session->getSaveHyper())
+      smurff::matrix_io::eigen::write_matrix(sf->getMuFileName(m_mode), Eigen::MatrixXd(mu));
+
    std::string path = sf->getLinkMatrixFileName(m_mode);
    smurff::matrix_io::eigen::write_matrix(path, beta);
 }
@@ -182,6 +274,25 @@ void MacauOnePrior::restore(std::shared_ptr<const StepFile> sf)
    smurff::matrix_io::eigen::read_matrix(path, beta);
 }
 
+void MacauOnePrior::init_appended(std::shared_ptr<const StepFile> sf, int num_old)
+{
+   std::string path = sf->getLinkMatrixFileName(m_mode);
+   THROWERROR_FILE_NOT_EXIST(path);
+   THROWERROR_FILE_NOT_EXIST(sf->getMuFileName(m_mode));
+
+   Eigen::MatrixXd saved_beta, saved_mu;
+   smurff::matrix_io::eigen::read_matrix(path, saved_beta);
+   smurff::matrix_io::eigen::read_matrix(sf->getMuFileName(m_mode), saved_mu);
+
+   THROWERROR_ASSERT_MSG(saved_beta.rows() == beta.rows() && saved_beta.cols() == beta.cols(),
+      "Side info of mode " + std::to_string(m_mode) + " has other features than in the warm start model");
+
+   beta = saved_beta;
+   Features->compute_uhat(Uhat, beta);
+
+   U().rightCols(num_cols() - num_old) = Uhat.rightCols(num_cols() - num_old).colwise() + saved_mu.col(0);
+}
+
 std::ostream& MacauOnePrior::status(std::ostream &os, std::string indent) const
 {
    os << indent << "  " << m_name << ": Beta = " << beta.norm() << std::endl;
@@ -22,6 +22,9 @@ public:
    Eigen::VectorXd F_colsq;   // sum-of-squares for every feature (column)
 
    Eigen::MatrixXd beta;      // link matrix
+
+   // features of one color touch disjoint rows of F, empty if not used
+   std::vector<std::vector<int> > feature_colors;
    
    double beta_precision_a0; // Hyper-prior for beta_precision
    double beta_precision_b0; // Hyper-prior for beta_precision
@@ -49,6 +52,10 @@ public:
    void init() override;
 
    void update_prior() override;
+
+   void for_each_hyper(const std::function<void(double*, std::size_t)>& f) override;
+
+   void prune_latents(const std::vector<int>& keep) override;
     
    const Eigen::VectorXd getMu(int n) const override;
 
@@ -64,6 +71,18 @@ public:
 
    void sample_beta(const Eigen::MatrixXd &U);
 
+private:
+   // Z = (U - mu - Uhat)[dstart : dstart + Z.rows(), :]
+   void compute_beta_residual(Eigen::MatrixXd &Z, const Eigen::MatrixXd &U, const int dstart) const;
+
+   // samples beta[dstart : dstart + Z.rows(), f] and updates the residual Z
+   void sample_beta_feature(Eigen::MatrixXd &Z, const int dstart, const int f);
+
+   // features of one color are sampled concurrently
+   void sample_beta_colored(const Eigen::MatrixXd &U);
+
+public:
+
    //used in update_prior
 
    void sample_mu_lambda(const Eigen::MatrixXd &U);
@@ -78,6 +97,12 @@ public:
 
    void restore(std::shared_ptr<const StepFile> sf) override;
 
+protected:
+   // appended entities start at mu + beta * F from the link matrix of the previous run
+   void init_appended(std::shared_ptr<const StepFile> sf, int num_old) override;
+
+public:
+
    std::ostream& status(std::ostream &os, std::string indent) const override;
 };
 
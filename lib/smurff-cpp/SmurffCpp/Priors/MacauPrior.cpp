@@ -5,13 +5,25 @@
 
 #include <SmurffCpp/Utils/Distribution.h>
 #include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
 
 #include <SmurffCpp/Utils/linop.h>
+#include <SmurffCpp/Utils/counters.h>
 
+#include <SmurffCpp/SideInfo/CompositeSideInfo.h>
+#include <SmurffCpp/SideInfo/DenseDoubleFeatSideInfo.h>
+
+#include <cmath>
 #include <ios>
+#include <limits>
+#include <random>
+#include <sstream>
 
 using namespace smurff;
 
+int MacauPrior::AUTOTUNE_DIRECT_MAX_FEATURES_DEFAULT_VALUE = 16384;
+double MacauPrior::AUTOTUNE_BETA_PRECISION_DRIFT = 2.0;
+
 MacauPrior::MacauPrior()
    : NormalPrior() 
 {
@@ -24,6 +36,16 @@ MacauPrior::MacauPrior(std::shared_ptr<BaseSession> session, uint32_t mode)
    tol = SideInfoConfig::TOL_DEFAULT_VALUE;
 
    enable_beta_precision_sampling = Config::ENABLE_BETA_PRECISION_SAMPLING_DEFAULT_VALUE;
+
+   sparse_direct = false;
+   use_sparse_FtF = false;
+   K_sparse_beta_precision = -1.0;
+   projection_rank = 0;
+   cg_blocksize = 32;
+   cg_excess = 8;
+   autotune = false;
+   autotune_next = -1;
+   autotune_beta_precision = -1.0;
 }
 
 MacauPrior::~MacauPrior()
@@ -36,21 +58,91 @@ void MacauPrior::init()
 
    THROWERROR_ASSERT_MSG(Features->rows() == num_cols(), "Number of rows in train must be equal to number of rows in features");
 
-   if (use_FtF)
-   {
-      FtF.resize(Features->cols(), Features->cols());
-      K.resize(Features->cols(), Features->cols());
-      Features->At_mul_A(FtF);
-   }
+   if (projection_rank > 0 && feature_projection.size() == 0)
+      project_features();
+
+   // with autotune F'F is only built when the direct candidate is tried
+   if (use_FtF && !autotune)
+      build_FtF();
 
    Uhat.resize(this->num_latent(), Features->rows());
    Uhat.setZero();
 
    beta.resize(this->num_latent(), Features->cols());
    beta.setZero();
+
+   if (autotune)
+      init_autotune();
 }
 
 void MacauPrior::update_prior()
+{
+   sample_mu_lambda();
+
+   timed_update([this]() { sample_beta(); });
+
+   Features->compute_uhat(Uhat, beta);
+
+   if (enable_beta_precision_sampling)
+      beta_precision = sample_beta_precision(beta, this->Lambda, beta_precision_nu0, beta_precision_mu0);
+}
+
+std::function<void()> MacauPrior::start_update_prior()
+{
+   sample_mu_lambda();
+   compute_Ft_y_omp(Ft_y);
+
+   // the shape of the beta_precision posterior only depends on the size of beta,
+   // so the gamma variate can be drawn now and scaled once beta is known
+   double beta_precision_gamma = 0.0;
+   if (enable_beta_precision_sampling)
+      beta_precision_gamma = rgamma((beta_precision_nu0 + beta.rows() * beta.cols()) / 2, 1.0);
+
+   return [this, beta_precision_gamma]()
+   {
+      timed_update([this]() { solve_beta(); });
+
+      Features->compute_uhat(Uhat, beta);
+
+      if (enable_beta_precision_sampling)
+         beta_precision = beta_precision_gamma * posterior_beta_precision(beta, this->Lambda, beta_precision_nu0, beta_precision_mu0).second;
+   };
+}
+
+void MacauPrior::for_each_hyper(const std::function<void(double*, std::size_t)>& f)
+{
+   NormalPrior::for_each_hyper(f);
+
+   f(beta.data(), beta.size());
+   f(Uhat.data(), Uhat.size());
+   f(&beta_precision, 1);
+}
+
+void MacauPrior::prune_latents(const std::vector<int>& keep)
+{
+   NormalPrior::prune_latents(keep);
+
+   matrix_utils::keep_rows(beta, keep);
+   matrix_utils::keep_rows(Uhat, keep);
+
+   // recomputed at the next update
+   HyperU.resize(0, 0);
+   HyperU2.resize(0, 0);
+   Ft_y.resize(0, 0);
+}
+
+void MacauPrior::als_sweep(double reg)
+{
+   NormalPrior::als_sweep(reg);
+
+   // same system as sample_beta, without the noise added to U
+   HyperU = U().colwise() - this->mu;
+   Ft_y = Features->A_mul_B(HyperU);
+   solve_beta();
+   Features->compute_uhat(Uhat, beta);
+}
+
+void MacauPrior::sample_mu_lambda()
 {
    // residual (Uhat is later overwritten):
    Uhat.noalias() = U() - Uhat;
@@ -58,11 +150,6 @@ void MacauPrior::update_prior()
 
    // sampling Gaussian
    std::tie(this->mu, this->Lambda) = CondNormalWishart(Uhat, this->mu0, this->b0, this->WI + beta_precision * BBt, this->df + beta.cols());
-   sample_beta();
-   Features->compute_uhat(Uhat, beta);
-
-   if (enable_beta_precision_sampling)
-      beta_precision = sample_beta_precision(beta, this->Lambda, beta_precision_nu0, beta_precision_mu0);
 }
 
 const Eigen::VectorXd MacauPrior::getMu(int n) const
@@ -91,9 +178,31 @@ void MacauPrior::compute_Ft_y_omp(Eigen::MatrixXd& Ft_y)
    }
 }
 
+void MacauPrior::solve_beta()
+{
+   if (use_FtF && use_sparse_FtF)
+   {
+      solve_beta_sparse_direct();
+   }
+   else if (use_FtF)
+   {
+      K.triangularView<Eigen::Lower>() = FtF;
+      K.diagonal().array() += beta_precision;
+      chol_decomp(K);
+      chol_solve_t(K, Ft_y);
+      std::swap(beta, Ft_y);
+   }
+   else
+   {
+      Features->solve_blockcg(beta, beta_precision, Ft_y, tol, cg_blocksize, cg_excess, throw_on_cholesky_error);
+   }
+}
+
 void MacauPrior::sample_beta()
 {
-   if (use_FtF)
+   if (use_FtF && use_sparse_FtF)
+      sample_beta_sparse_direct();
+   else if (use_FtF)
       sample_beta_direct();
    else
       sample_beta_cg();
@@ -105,13 +214,15 @@ void MacauPrior::addSideInfo(const std::shared_ptr<ISideInfo>& side_info_a, doub
 
    // old code
 
-   // side information
-   Features = side_info_a;
-   beta_precision = beta_precision_a;
-   tol = tolerance_a;
-   use_FtF = direct_a;
-   enable_beta_precision_sampling = enable_beta_precision_sampling_a;
-   throw_on_cholesky_error = throw_on_cholesky_error_a;
+   // solver settings come from the first side info, all blocks share them
+   if (side_info_values.empty())
+   {
+      beta_precision = beta_precision_a;
+      tol = tolerance_a;
+      use_FtF = direct_a;
+      enable_beta_precision_sampling = enable_beta_precision_sampling_a;
+      throw_on_cholesky_error = throw_on_cholesky_error_a;
+   }
 
    // new code
 
@@ -123,6 +234,12 @@ void MacauPrior::addSideInfo(const std::shared_ptr<ISideInfo>& side_info_a, doub
    enable_beta_precision_sampling_values.push_back(enable_beta_precision_sampling_a);
    throw_on_cholesky_error_values.push_back(throw_on_cholesky_error_a);
 
+   // several side infos act as one horizontal concatenation
+   if (side_info_values.size() == 1)
+      Features = side_info_a;
+   else
+      Features = std::make_shared<CompositeSideInfo>(side_info_values);
+
    // other code
 
    // Hyper-prior for beta_precision (mean 1.0, var of 1e+3):
@@ -134,8 +251,21 @@ void MacauPrior::save(std::shared_ptr<const StepFile> sf) const
 {
    NormalPrior::save(sf);
 
+   // cold-start predictions and warm starts need mu next to the link matrix
+   if (!m_session->getSaveHyper())
+      smurff::matrix_io::eigen::write_matrix(sf->getMuFileName(m_mode), Eigen::MatrixXd(mu));
+
    std::string path = sf->getLinkMatrixFileName(m_mode);
-   smurff::matrix_io::eigen::write_matrix(path, this->beta);
+
+   // link matrix is saved in the original feature space, for cold-start prediction
+   if (feature_projection.size())
+      smurff::matrix_io::eigen::write_matrix(path, Eigen::MatrixXd(this->beta * feature_projection.transpose()));
+   else
+      smurff::matrix_io::eigen::write_matrix(path, this->beta);
+
+   // record the autotuned solver, restore continues with it
+   if (autotune && autotune_next < 0)
+      sf->appendToStepFile(std::string(), sf->getSolverTag(m_mode), solver_string());
 }
 
 void MacauPrior::restore(std::shared_ptr<const StepFile> sf)
@@ -147,6 +277,113 @@ void MacauPrior::restore(std::shared_ptr<const StepFile> sf)
    THROWERROR_FILE_NOT_EXIST(path);
 
    smurff::matrix_io::eigen::read_matrix(path, this->beta);
+
+   if (feature_projection.size())
+      this->beta = this->beta * feature_projection;
+
+   auto solver = sf->tryGetIniValueBase(sf->getSolverTag(m_mode));
+   if (autotune && solver.first)
+   {
+      std::stringstream ss(solver.second);
+      std::string method;
+      SolverChoice choice = { false, cg_blocksize, cg_excess };
+      ss >> method;
+      if (method == "direct")
+         choice.direct = true;
+      else
+         ss >> choice.blocksize >> choice.excess;
+
+      apply_solver(choice);
+      autotune_next = -1;
+      autotune_beta_precision = beta_precision;
+   }
+}
+
+void MacauPrior::project_features()
+{
+   auto dense = std::dynamic_pointer_cast<DenseDoubleFeatSideInfo>(Features);
+   THROWERROR_ASSERT_MSG(dense, "Low-rank projection is only supported for a single dense side info");
+
+   const Eigen::MatrixXd& F = *dense->get_features();
+   const int rank = std::min<int>(projection_rank, std::min(F.rows(), F.cols()));
+   const int sketch = std::min<int>(rank + 10, std::min(F.rows(), F.cols()));
+
+   // nothing to gain if the sketch is as wide as F
+   if (rank >= F.cols())
+      return;
+
+   // fixed seed: the projection does not depend on the session RNG, so restore gets the same one
+   std::mt19937 gen(0);
+   std::normal_distribution<double> normal;
+   Eigen::MatrixXd Omega(F.cols(), sketch);
+   for (Eigen::Index i = 0; i < Omega.size(); i++)
+      Omega.data()[i] = normal(gen);
+
+   // thin Q of A, the pivoting only reorders the columns, not their span;
+   // the reflectors are applied one by one: the blocked householder products of HouseholderQR
+   // and the QR preconditioners of JacobiSVD make gcc warn about an uninitialized triangular factor
+   auto orthonormalize = [](const Eigen::MatrixXd& A) -> Eigen::MatrixXd
+   {
+      Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(A);
+      Eigen::MatrixXd Q = Eigen::MatrixXd::Identity(A.rows(), A.cols());
+      Eigen::VectorXd workspace(A.cols());
+      for (Eigen::Index i = A.cols() - 1; i >= 0; i--)
+      {
+         Eigen::Index tail = A.rows() - i;
+         Q.bottomRows(tail).applyHouseholderOnTheLeft(qr.matrixQR().col(i).tail(tail - 1), qr.hCoeffs()(i), workspace.data());
+      }
+      return Q;
+   };
+
+   // range finder with two power iterations, then SVD of the small [sketch x F] matrix Q'F
+   Eigen::MatrixXd Q = orthonormalize(F * Omega);
+   Eigen::MatrixXd P;
+   for (int i = 0; i < 2; i++)
+   {
+      P = orthonormalize(F.transpose() * Q);
+      Q = orthonormalize(F * P);
+   }
+
+   // P spans the rows of Q'F, so Q'F = (Q'F P) P' and V = P W with W from the square SVD of Q'F P
+   P = orthonormalize(F.transpose() * Q);
+   Eigen::MatrixXd B = Q.transpose() * F * P;
+   Eigen::JacobiSVD<Eigen::MatrixXd, Eigen::NoQRPreconditioner> svd(B, Eigen::ComputeFullV);
+   feature_projection = P * svd.matrixV().leftCols(rank);
+
+   // singular vectors are unique up to sign, make the largest entry of each one positive
+   for (int r = 0; r < rank; r++)
+   {
+      Eigen::Index imax;
+      feature_projection.col(r).cwiseAbs().maxCoeff(&imax);
+      if (feature_projection(imax, r) < 0)
+         feature_projection.col(r) *= -1.0;
+   }
+
+   // F * V is exact, so uhat = beta_r * (F V)' = (beta_r V') * F'
+   auto projected = std::make_shared<Eigen::MatrixXd>(F * feature_projection);
+   Features = std::make_shared<DenseDoubleFeatSideInfo>(projected);
+}
+
+void MacauPrior::init_appended(std::shared_ptr<const StepFile> sf, int num_old)
+{
+   std::string path = sf->getLinkMatrixFileName(m_mode);
+   THROWERROR_FILE_NOT_EXIST(path);
+   THROWERROR_FILE_NOT_EXIST(sf->getMuFileName(m_mode));
+
+   Eigen::MatrixXd saved_beta, saved_mu;
+   smurff::matrix_io::eigen::read_matrix(path, saved_beta);
+   smurff::matrix_io::eigen::read_matrix(sf->getMuFileName(m_mode), saved_mu);
+
+   if (feature_projection.size())
+      saved_beta = saved_beta * feature_projection;
+
+   THROWERROR_ASSERT_MSG(saved_beta.rows() == beta.rows() && saved_beta.cols() == beta.cols(),
+      "Side info of mode " + std::to_string(m_mode) + " has other features than in the warm start model");
+
+   this->beta = saved_beta;
+   Features->compute_uhat(Uhat, beta);
+
+   U().rightCols(num_cols() - num_old) = Uhat.rightCols(num_cols() - num_old).colwise() + saved_mu.col(0);
 }
 
 std::ostream& MacauPrior::info(std::ostream &os, std::string indent)
@@ -154,7 +391,16 @@ std::ostream& MacauPrior::info(std::ostream &os, std::string indent)
    NormalPrior::info(os, indent);
    os << indent << " SideInfo: ";
    Features->print(os);
-   os << indent << " Method: " << (use_FtF ? "Cholesky Decomposition" : "CG Solver") << std::endl;
+   if (feature_projection.size())
+      os << indent << " Projection: rank " << feature_projection.cols() << " of " << feature_projection.rows() << " features" << std::endl;
+   if (autotune && autotune_next >= 0)
+      os << indent << " Method: autotuning " << solver_candidates.size() << " solvers" << std::endl;
+   else if (use_FtF)
+      os << indent << " Method: " << (use_sparse_FtF ? "Sparse Cholesky Decomposition" : "Cholesky Decomposition") << (autotune ? " (autotuned)" : "") << std::endl;
+   else
+      os << indent << " Method: CG Solver (blocksize " << cg_blocksize << ", excess " << cg_excess << ")" << (autotune ? " (autotuned)" : "") << std::endl;
+   if (use_sparse_FtF)
+      os << indent << " FtF nnz: " << FtF_sparse.nonZeros() << std::endl;
    os << indent << " Tol: " << std::scientific << tol << std::fixed << std::endl;
    os << indent << " BetaPrecision: " << beta_precision << std::endl;
    return os;
@@ -164,12 +410,14 @@ std::ostream& MacauPrior::status(std::ostream &os, std::string indent) const
 {
    os << indent << m_name << ": " << std::endl;
    indent += "  ";
-   os << indent << "FtF          = " << FtF.norm() << std::endl;
+   os << indent << "FtF          = " << (use_sparse_FtF ? FtF_sparse.norm() : FtF.norm()) << std::endl;
    os << indent << "HyperU       = " << HyperU.norm() << std::endl;
    os << indent << "HyperU2      = " << HyperU2.norm() << std::endl;
    os << indent << "Beta         = " << beta.norm() << std::endl;
    os << indent << "beta_precision  = " << beta_precision << std::endl;
    os << indent << "Ft_y         = " << Ft_y.norm() << std::endl;
+   if (autotune)
+      os << indent << "solver       = " << (autotune_next >= 0 ? "autotuning" : solver_string()) << std::endl;
    return os;
 }
 
@@ -195,6 +443,28 @@ void MacauPrior::sample_beta_direct()
    std::swap(beta, Ft_y);
 }
 
+void MacauPrior::sample_beta_sparse_direct()
+{
+   this->compute_Ft_y_omp(Ft_y);
+   solve_beta_sparse_direct();
+}
+
+void MacauPrior::solve_beta_sparse_direct()
+{
+   // numeric refactorization only, the ordering and symbolic analysis are reused
+   if (beta_precision != K_sparse_beta_precision)
+   {
+      Eigen::SparseMatrix<double> I(FtF_sparse.rows(), FtF_sparse.cols());
+      I.setIdentity();
+      K_sparse = FtF_sparse + beta_precision * I;
+      K_sparse_chol.factorize(K_sparse);
+      THROWERROR_SPEC_COND(smurff::solver_error, "Sparse Cholesky Decomposition failed!", K_sparse_chol.info() == Eigen::Success);
+      K_sparse_beta_precision = beta_precision;
+   }
+
+   beta = K_sparse_chol.solve(Ft_y.transpose()).transpose();
+}
+
 std::pair<double, double> MacauPrior::posterior_beta_precision(Eigen::MatrixXd & beta, Eigen::MatrixXd & Lambda_u, double nu, double mu)
 {
    const int D = beta.rows();
@@ -218,5 +488,152 @@ void MacauPrior::sample_beta_cg()
     Eigen::MatrixXd Ft_y;
     this->compute_Ft_y_omp(Ft_y);
 
-    Features->solve_blockcg(beta, beta_precision, Ft_y, tol, 32, 8, throw_on_cholesky_error);
+    Features->solve_blockcg(beta, beta_precision, Ft_y, tol, cg_blocksize, cg_excess, throw_on_cholesky_error);
+}
+
+void MacauPrior::build_FtF()
+{
+   use_sparse_FtF = sparse_direct && !Features->is_dense();
+
+   if (use_sparse_FtF)
+   {
+      Features->At_mul_A(FtF_sparse);
+
+      // K has the pattern of F'F plus the full diagonal, so one symbolic analysis is enough
+      Eigen::SparseMatrix<double> I(Features->cols(), Features->cols());
+      I.setIdentity();
+      K_sparse = FtF_sparse + I;
+      K_sparse_chol.analyzePattern(K_sparse);
+      K_sparse_beta_precision = -1.0;
+   }
+   else
+   {
+      FtF.resize(Features->cols(), Features->cols());
+      K.resize(Features->cols(), Features->cols());
+      Features->At_mul_A(FtF);
+   }
+}
+
+void MacauPrior::release_FtF()
+{
+   FtF.resize(0, 0);
+   K.resize(0, 0);
+   FtF_sparse.resize(0, 0);
+   K_sparse.resize(0, 0);
+   use_sparse_FtF = false;
+}
+
+bool MacauPrior::has_FtF() const
+{
+   return FtF.size() || FtF_sparse.size();
+}
+
+void MacauPrior::init_autotune()
+{
+   solver_candidates.clear();
+
+   // larger blocks than num_latent all solve in one block, so they are the same candidate
+   for (int blocksize : { 8, 16, 32, 64 })
+   {
+      solver_candidates.push_back({ false, blocksize, blocksize / 4 });
+      if (num_latent() <= blocksize + blocksize / 4)
+         break;
+   }
+
+   // the direct method goes last, its F'F is only built if the tuning gets there
+   if (use_FtF || Features->cols() <= AUTOTUNE_DIRECT_MAX_FEATURES_DEFAULT_VALUE)
+      solver_candidates.push_back({ true, 0, 0 });
+
+   solver_times.assign(solver_candidates.size(), 0.0);
+   autotune_next = 0;
+   apply_solver(solver_candidates.front());
+}
+
+void MacauPrior::apply_solver(const SolverChoice& choice)
+{
+   if (choice.direct && !has_FtF())
+      build_FtF();
+
+   use_FtF = choice.direct;
+   if (!choice.direct)
+   {
+      cg_blocksize = choice.blocksize;
+      cg_excess = choice.excess;
+   }
+}
+
+void MacauPrior::autotune_step(double elapsed)
+{
+   if (!autotune)
+      return;
+
+   if (autotune_next < 0)
+   {
+      // the conditioning of F'F + beta_precision * I, and so the CG iteration count, follows beta_precision
+      double drift = beta_precision / autotune_beta_precision;
+      if (drift > AUTOTUNE_BETA_PRECISION_DRIFT || drift < 1.0 / AUTOTUNE_BETA_PRECISION_DRIFT)
+      {
+         autotune_next = 0;
+         apply_solver(solver_candidates.front());
+      }
+      return;
+   }
+
+   solver_times.at(autotune_next++) = elapsed;
+   if (autotune_next < (int)solver_candidates.size())
+   {
+      apply_solver(solver_candidates.at(autotune_next));
+      return;
+   }
+
+   // CG always iterates down to tol, so every candidate meets the tolerance and the fastest one wins
+   auto fastest = std::min_element(solver_times.begin(), solver_times.end()) - solver_times.begin();
+   THROWERROR_ASSERT_MSG(std::isfinite(solver_times.at(fastest)), "None of the autotuned solvers for beta succeeded");
+   apply_solver(solver_candidates.at(fastest));
+   if (!use_FtF)
+      release_FtF();
+   autotune_next = -1;
+   autotune_beta_precision = beta_precision;
+}
+
+void MacauPrior::timed_update(const std::function<void()>& update)
+{
+   while (true)
+   {
+      double start = tick();
+      try
+      {
+         update();
+      }
+      catch (solver_error&)
+      {
+         if (!autotune)
+            throw;
+
+         // a failing solver is never picked, retune if the chosen one stops working
+         if (autotune_next < 0)
+         {
+            autotune_next = 0;
+            apply_solver(solver_candidates.front());
+         }
+         else
+         {
+            autotune_step(std::numeric_limits<double>::infinity());
+         }
+         continue;
+      }
+
+      autotune_step(tick() - start);
+      return;
+   }
+}
+
+std::string MacauPrior::solver_string() const
+{
+   std::stringstream ss;
+   if (use_FtF)
+      ss << "direct";
+   else
+      ss << "cg " << cg_blocksize << " " << cg_excess;
+   return ss.str();
 }
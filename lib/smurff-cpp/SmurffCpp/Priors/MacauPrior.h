@@ -18,6 +18,22 @@ namespace smurff {
 /// Prior with side information
 class MacauPrior : public NormalPrior
 {
+public:
+   // autotuning only tries the direct method up to this many features
+   static int AUTOTUNE_DIRECT_MAX_FEATURES_DEFAULT_VALUE;
+
+   // a beta_precision this many times larger or smaller than at the last tuning triggers a new one
+   static double AUTOTUNE_BETA_PRECISION_DRIFT;
+
+   struct SolverChoice
+   {
+      bool direct;
+      int blocksize;
+      int excess;
+   };
+
+   typedef Eigen::SimplicialLLT<Eigen::SparseMatrix<double>, Eigen::Lower, Eigen::AMDOrdering<int> > SparseCholesky;
+
 public:
    Eigen::MatrixXd Uhat;
    Eigen::MatrixXd FtF;       // F'F
@@ -25,6 +41,23 @@ public:
    Eigen::MatrixXd beta;      // link matrix
    Eigen::MatrixXd HyperU, HyperU2;
    Eigen::MatrixXd Ft_y;
+
+   Eigen::SparseMatrix<double> FtF_sparse;  // lower triangle of F'F (sparse direct method)
+   Eigen::SparseMatrix<double> K_sparse;    // FtF_sparse + beta_precision * I
+   SparseCholesky K_sparse_chol;            // analyzed once in init, refactorized when beta_precision changes
+   double K_sparse_beta_precision;          // beta_precision of the current factorization
+
+   int projection_rank;                     // > 0: sample beta in a rank-r sketch of dense F
+
+   int cg_blocksize;                        // BlockCG right-hand sides per block
+   int cg_excess;                           // BlockCG merges a last block of at most this many rows
+
+   bool autotune;                                 // time the solvers on the first updates and keep the fastest
+   std::vector<SolverChoice> solver_candidates;
+   std::vector<double> solver_times;
+   int autotune_next;                             // candidate used in the current update, -1 when tuned
+   double autotune_beta_precision;                // beta_precision at the last tuning
+   Eigen::MatrixXd feature_projection;      // [F x r] orthonormal, full beta = beta * feature_projection'
    
    double beta_precision_mu0; // Hyper-prior for beta_precision
    double beta_precision_nu0; // Hyper-prior for beta_precision
@@ -48,6 +81,8 @@ public:
    double beta_precision;
    double tol = 1e-6;
    bool use_FtF;
+   bool sparse_direct;                   // the direct method factorizes a sparse F'F of sparse side info
+   bool use_sparse_FtF;
    bool enable_beta_precision_sampling;
    bool throw_on_cholesky_error;
 
@@ -63,6 +98,15 @@ public:
 
    void update_prior() override;
 
+   std::function<void()> start_update_prior() override;
+
+   void for_each_hyper(const std::function<void(double*, std::size_t)>& f) override;
+
+   void prune_latents(const std::vector<int>& keep) override;
+
+   // als sweep of U followed by the ridge regression of U on the side info
+   void als_sweep(double reg) override;
+
    const Eigen::VectorXd getMu(int n) const override;
 
    void compute_Ft_y_omp(Eigen::MatrixXd& Ft_y);
@@ -80,6 +124,10 @@ public:
 
    void restore(std::shared_ptr<const StepFile> sf) override;
 
+protected:
+   // appended entities start at mu + beta * F from the link matrix of the previous run
+   void init_appended(std::shared_ptr<const StepFile> sf, int num_old) override;
+
 public:
 
    std::ostream& info(std::ostream &os, std::string indent) override;
@@ -88,12 +136,39 @@ public:
 
 private:
 
+   // sample mu and Lambda given the residual U - Uhat
+   void sample_mu_lambda();
+
+   // solve beta for the current Ft_y, draws no random numbers
+   void solve_beta();
+
    // direct method
    void sample_beta_direct();
 
+   // direct method with sparse F'F
+   void sample_beta_sparse_direct();
+   void solve_beta_sparse_direct();
+
    // BlockCG solver
    void sample_beta_cg();
 
+   // F'F (and K) for the direct method, dense or sparse
+   void build_FtF();
+   void release_FtF();
+   bool has_FtF() const;
+
+   // autotuning: builds the candidate list and starts timing them
+   void init_autotune();
+   void apply_solver(const SolverChoice& choice);
+   // records the time of the last beta update and moves on to the next candidate
+   void autotune_step(double elapsed);
+   // runs update with the current solver and times it, a solver that fails while autotuning is skipped
+   void timed_update(const std::function<void()>& update);
+   std::string solver_string() const;
+
+   // replaces dense Features by F * V, V the top right singular vectors of a randomized SVD of F
+   void project_features();
+
 public:
 
    static std::pair<double, double> posterior_beta_precision(Eigen::MatrixXd & beta, Eigen::MatrixXd & Lambda_u, double nu, double mu);
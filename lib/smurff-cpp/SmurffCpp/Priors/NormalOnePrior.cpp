@@ -1,5 +1,7 @@
 #include "NormalOnePrior.h"
 #include <SmurffCpp/IO/MatrixIO.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
+#include <SmurffCpp/Utils/StepFile.h>
 
 using namespace smurff;
 using namespace Eigen;
@@ -37,36 +39,86 @@ const Eigen::VectorXd NormalOnePrior::getMu(int n) const
    return mu;
 }
 
+void NormalOnePrior::prune_latents(const std::vector<int>& keep)
+{
+   ILatentPrior::prune_latents(keep);
+
+   matrix_utils::keep_rows(mu, keep);
+   matrix_utils::keep_rows_cols(Lambda, keep);
+   matrix_utils::keep_rows_cols(WI, keep);
+   matrix_utils::keep_rows(mu0, keep);
+   df = num_latent();
+}
+
+void NormalOnePrior::save(std::shared_ptr<const StepFile> sf) const
+{
+   ILatentPrior::save(sf);
+
+   //only fold-in uses the hyperparameters of every sample
+   if (m_session->getSaveHyper())
+   {
+      smurff::matrix_io::eigen::write_matrix(sf->getMuFileName(m_mode), Eigen::MatrixXd(mu));
+      smurff::matrix_io::eigen::write_matrix(sf->getLambdaFileName(m_mode), Lambda);
+   }
+}
+
 void NormalOnePrior::update_prior()
 {
     std::tie(mu, Lambda) = CondNormalWishart(num_cols(), getUUsum(), getUsum(), mu0, b0, WI, df);
 }
 
+void NormalOnePrior::for_each_hyper(const std::function<void(double*, std::size_t)>& f)
+{
+   f(mu.data(), mu.size());
+   f(Lambda.data(), Lambda.size());
+}
+
 void NormalOnePrior::sample_latent(int d)
 {
-   const int K = num_latent();
+   VectorXd &r = rrs.local();
+   MatrixXd &XX = MMs.local();
 
-   MatrixXd XX = MatrixXd::Zero(K, K);
-   VectorXd yX = VectorXd::Zero(K);
+   r.setZero();
+   XX.setZero();
 
-   data().getMuLambda(model(), m_mode, d, yX, XX);
+   data().getMuLambda(model(), m_mode, d, r, XX);
 
    // add hyperparams
-   yX.noalias() += Lambda * mu;
+   r.noalias() += Lambda * mu;
    XX.noalias() += Lambda;
 
-   for(int k=0;k<K;++k) sample_latent(d, k, XX, yX);
+   // running residual r = yX - XX * Ucol, updated after every coordinate
+   auto Ucol = U().col(d);
+   r.noalias() -= XX * Ucol;
+
+   for(int k=0;k<num_latent();++k)
+   {
+      const double u_old = Ucol(k);
+      sample_latent(d, k, XX, r);
+      const double delta = Ucol(k) - u_old;
+      if (delta != 0.0)
+         r.noalias() -= XX.col(k) * delta;
+   }
 }
  
-std::pair<double,double> NormalOnePrior::sample_latent(int d, int k, const MatrixXd& XX, const VectorXd& yX)
+std::pair<double,double> NormalOnePrior::sample_latent(int d, int k, const MatrixXd& XX, const VectorXd& r)
 {
-    auto Ucol = U().col(d);
-    double lambda = XX(k,k);
-    double mu = (1/lambda) * (yX(k) - Ucol.transpose() * XX.col(k) + Ucol(k) * XX(k,k));
-    Ucol(k) = mu + randn() / sqrt(lambda);
+    return sample_coordinate(d, k, XX(k,k), r(k) + U()(k,d) * XX(k,k));
+}
+
+std::pair<double,double> NormalOnePrior::sample_coordinate(int d, int k, double lambda, double y)
+{
+    double mu = y / lambda;
+    U()(k,d) = mu + randn() / sqrt(lambda);
     return std::make_pair(mu, lambda);
 }
 
+void NormalOnePrior::prior_gradient(int n, VectorXd& grad, VectorXd& hess) const
+{
+   grad.noalias() += Lambda * (getMu(n) - U().col(n));
+   hess += Lambda.diagonal();
+}
+
 std::ostream &NormalOnePrior::status(std::ostream &os, std::string indent) const
 {
    return os;
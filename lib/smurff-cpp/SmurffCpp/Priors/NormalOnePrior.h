@@ -40,11 +40,29 @@ public:
    virtual const Eigen::VectorXd getMu(int n) const;
 
    void sample_latent(int n) override;
-   virtual std::pair<double,double> sample_latent(int d, int k, const Eigen::MatrixXd& XX, const Eigen::VectorXd& yX);
+
+   // samples U(k, d) given the precision XX and the running residual r = yX - XX * U.col(d)
+   virtual std::pair<double,double> sample_latent(int d, int k, const Eigen::MatrixXd& XX, const Eigen::VectorXd& r);
+
+protected:
+   // samples U(k, d) from N(y / lambda, 1 / lambda)
+   std::pair<double,double> sample_coordinate(int d, int k, double lambda, double y);
+
+public:
 
    void update_prior() override;
 
+   void for_each_hyper(const std::function<void(double*, std::size_t)>& f) override;
+
+   void prune_latents(const std::vector<int>& keep) override;
+
+   //saves the hyperparameters mu and Lambda, used to fold in new entities
+   void save(std::shared_ptr<const StepFile> sf) const override;
+
    // mean value of Z
    std::ostream &status(std::ostream &os, std::string indent) const override;
+
+protected:
+   void prior_gradient(int n, Eigen::VectorXd& grad, Eigen::VectorXd& hess) const override;
 };
 }
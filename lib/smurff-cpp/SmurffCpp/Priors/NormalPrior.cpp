@@ -12,6 +12,8 @@
 
 #include <SmurffCpp/Utils/Distribution.h>
 #include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
+#include <SmurffCpp/Utils/StepFile.h>
 
 using namespace Eigen;
 using namespace smurff;
@@ -51,11 +53,40 @@ const Eigen::VectorXd NormalPrior::getMu(int n) const
    return mu;
 }
 
+void NormalPrior::prune_latents(const std::vector<int>& keep)
+{
+   ILatentPrior::prune_latents(keep);
+
+   matrix_utils::keep_rows(mu, keep);
+   matrix_utils::keep_rows_cols(Lambda, keep);
+   matrix_utils::keep_rows_cols(WI, keep);
+   matrix_utils::keep_rows(mu0, keep);
+   df = num_latent();
+}
+
+void NormalPrior::save(std::shared_ptr<const StepFile> sf) const
+{
+   ILatentPrior::save(sf);
+
+   //only fold-in uses the hyperparameters of every sample
+   if (m_session->getSaveHyper())
+   {
+      smurff::matrix_io::eigen::write_matrix(sf->getMuFileName(m_mode), Eigen::MatrixXd(mu));
+      smurff::matrix_io::eigen::write_matrix(sf->getLambdaFileName(m_mode), Lambda);
+   }
+}
+
 void NormalPrior::update_prior()
 {
    std::tie(mu, Lambda) = CondNormalWishart(num_cols(), getUUsum(), getUsum(), mu0, b0, WI, df);
 }
 
+void NormalPrior::for_each_hyper(const std::function<void(double*, std::size_t)>& f)
+{
+   f(mu.data(), mu.size());
+   f(Lambda.data(), Lambda.size());
+}
+
 //n is an index of column in U matrix
 void  NormalPrior::sample_latent(int n)
 {
@@ -95,6 +126,17 @@ void  NormalPrior::sample_latent(int n)
    U().col(n).noalias() = rr; // rr is equal to x
 }
 
+Eigen::VectorXd NormalPrior::als_mean(int n) const
+{
+   return getMu(n);
+}
+
+void NormalPrior::prior_gradient(int n, VectorXd& grad, VectorXd& hess) const
+{
+   grad.noalias() += Lambda * (getMu(n) - U().col(n));
+   hess += Lambda.diagonal();
+}
+
 std::ostream &NormalPrior::status(std::ostream &os, std::string indent) const
 {
    os << indent << m_name << ": mu = " <<  mu.norm() << std::endl;
@@ -43,6 +43,19 @@ public:
   void sample_latent(int n) override;
 
   void update_prior() override;
+
+  void for_each_hyper(const std::function<void(double*, std::size_t)>& f) override;
+
+  void prune_latents(const std::vector<int>& keep) override;
+
+  //saves the hyperparameters mu and Lambda, used to fold in new entities
+  void save(std::shared_ptr<const StepFile> sf) const override;
+
   std::ostream &status(std::ostream &os, std::string indent) const override;
+
+protected:
+  Eigen::VectorXd als_mean(int n) const override;
+
+  void prior_gradient(int n, Eigen::VectorXd& grad, Eigen::VectorXd& hess) const override;
 };
 }
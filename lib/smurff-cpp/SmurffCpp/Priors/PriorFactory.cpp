@@ -9,8 +9,11 @@
 #include <SmurffCpp/Utils/Error.h>
 
 #include <SmurffCpp/SideInfo/DenseDoubleFeatSideInfo.h>
+#include <SmurffCpp/SideInfo/DenseFloatFeatSideInfo.h>
 #include <SmurffCpp/SideInfo/SparseDoubleFeatSideInfo.h>
 #include <SmurffCpp/SideInfo/SparseFeatSideInfo.h>
+#include <SmurffCpp/SideInfo/CompressedSparseFeatSideInfo.h>
+#include <SmurffCpp/SideInfo/BitPackedFeatSideInfo.h>
 
 #include <SmurffCpp/Utils/MatrixUtils.h>
 
@@ -19,6 +22,40 @@ using namespace Eigen;
 
 //create macau prior features
 
+std::shared_ptr<ISideInfo> PriorFactory::create_side_info(std::shared_ptr<SideInfoConfig> item, int mode)
+{
+   const auto &sideinfoConfig = item->getSideInfo();
+
+   if (item->getHashBuckets() > 0)
+   {
+      return side_info_config_to_hashed_features(sideinfoConfig, item->getHashBuckets(), item->getHashSeed(), mode);
+   }
+   else if (item->getBitPacked())
+   {
+      return side_info_config_to_bitpacked_features(sideinfoConfig, mode);
+   }
+   else if (sideinfoConfig->isBinary() && item->getCompressed())
+   {
+      return side_info_config_to_compressed_binary_features(sideinfoConfig, mode);
+   }
+   else if (sideinfoConfig->isBinary())
+   {
+      return side_info_config_to_sparse_binary_features(sideinfoConfig, mode);
+   }
+   else if (sideinfoConfig->isDense() && item->getSinglePrecision())
+   {
+      return side_info_config_to_dense_float_features(sideinfoConfig, mode);
+   }
+   else if (sideinfoConfig->isDense())
+   {
+      return side_info_config_to_dense_features(sideinfoConfig, mode);
+   }
+   else
+   {
+      return side_info_config_to_sparse_features(sideinfoConfig, mode);
+   }
+}
+
 std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_dense_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode)
 {
    Eigen::MatrixXd sideinfo = matrix_utils::dense_to_eigen(*sideinfoConfig);
@@ -26,6 +63,16 @@ std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_dense_features(std:
    return std::make_shared<DenseDoubleFeatSideInfo>(side_info_ptr);
 }
 
+std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_dense_float_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode)
+{
+   THROWERROR_ASSERT(sideinfoConfig->isDense());
+   // dense values are stored column-major
+   const std::vector<double>& values = sideinfoConfig->getValues();
+   auto side_info_ptr = std::make_shared<Eigen::MatrixXf>(sideinfoConfig->getNRow(), sideinfoConfig->getNCol());
+   std::copy(values.begin(), values.end(), side_info_ptr->data());
+   return std::make_shared<DenseFloatFeatSideInfo>(side_info_ptr);
+}
+
 std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_sparse_binary_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode)
 {
    std::uint64_t nrow = sideinfoConfig->getNRow();
@@ -75,6 +122,62 @@ std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_sparse_features(std
    return std::make_shared<SparseDoubleFeatSideInfo>(side_info_ptr);
 }
 
+std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_compressed_binary_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode)
+{
+   std::uint64_t nrow = sideinfoConfig->getNRow();
+   std::uint64_t ncol = sideinfoConfig->getNCol();
+   std::uint64_t nnz = sideinfoConfig->getNNZ();
+
+   std::shared_ptr<std::vector<std::uint32_t> > rows = sideinfoConfig->getRowsPtr();
+   std::shared_ptr<std::vector<std::uint32_t> > cols = sideinfoConfig->getColsPtr();
+
+   auto side_info_ptr = std::make_shared<CompressedSparseFeat>(nrow, ncol, nnz, rows->data(), cols->data());
+   return std::make_shared<CompressedSparseFeatSideInfo>(side_info_ptr);
+}
+
+std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_bitpacked_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode)
+{
+   std::uint64_t nrow = sideinfoConfig->getNRow();
+   std::uint64_t ncol = sideinfoConfig->getNCol();
+
+   std::vector<int> rowsRaw;
+   std::vector<int> colsRaw;
+
+   if (sideinfoConfig->isDense())
+   {
+      // dense values are stored column-major
+      const std::vector<double>& values = sideinfoConfig->getValues();
+      for (std::uint64_t i = 0; i < values.size(); i++)
+      {
+         THROWERROR_ASSERT_MSG(values[i] == 0.0 || values[i] == 1.0, "bit-packed side info must only contain 0 and 1");
+         if (values[i] == 0.0)
+            continue;
+         rowsRaw.push_back(i % nrow);
+         colsRaw.push_back(i / nrow);
+      }
+   }
+   else
+   {
+      if (!sideinfoConfig->isBinary())
+      {
+         for (auto v : sideinfoConfig->getValues())
+            THROWERROR_ASSERT_MSG(v == 1.0, "sparse bit-packed side info must only contain 1");
+      }
+      rowsRaw.assign(sideinfoConfig->getRows().begin(), sideinfoConfig->getRows().end());
+      colsRaw.assign(sideinfoConfig->getCols().begin(), sideinfoConfig->getCols().end());
+   }
+
+   auto side_info_ptr = std::make_shared<BitPackedFeat>(nrow, ncol, rowsRaw.size(), rowsRaw.data(), colsRaw.data());
+   return std::make_shared<BitPackedFeatSideInfo>(side_info_ptr);
+}
+
+std::shared_ptr<ISideInfo> PriorFactory::side_info_config_to_hashed_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int nbuckets, int seed, int mode)
+{
+   // beta, Ft_y and HyperU2 are sized by the number of buckets instead of the raw feature space
+   std::shared_ptr<MatrixConfig> hashedConfig = matrix_utils::hash_columns(*sideinfoConfig, nbuckets, seed);
+   return side_info_config_to_sparse_features(hashedConfig, mode);
+}
+
 //-------
 
 std::shared_ptr<ILatentPrior> PriorFactory::create_macau_prior(std::shared_ptr<Session> session, PriorTypes prior_type,
@@ -83,7 +186,12 @@ std::shared_ptr<ILatentPrior> PriorFactory::create_macau_prior(std::shared_ptr<S
 {
    if(prior_type == PriorTypes::macau || prior_type == PriorTypes::default_prior)
    {
-      return create_macau_prior<MacauPrior>(session, side_infos, config_items);
+      auto prior = create_macau_prior<MacauPrior>(session, side_infos, config_items);
+      auto macau_prior = std::dynamic_pointer_cast<MacauPrior>(prior);
+      macau_prior->projection_rank = config_items.front()->getProjectionRank();
+      macau_prior->sparse_direct = config_items.front()->getSparseDirect();
+      macau_prior->autotune = config_items.front()->getAutotune();
+      return prior;
    }
    else if(prior_type == PriorTypes::macauone)
    {
@@ -17,10 +17,17 @@ class PriorFactory : public IPriorFactory
 private:
 
     std::shared_ptr<ISideInfo> side_info_config_to_dense_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode);
+    std::shared_ptr<ISideInfo> side_info_config_to_dense_float_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode);
     std::shared_ptr<ISideInfo> side_info_config_to_sparse_binary_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode);
     std::shared_ptr<ISideInfo> side_info_config_to_sparse_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode);
+    std::shared_ptr<ISideInfo> side_info_config_to_compressed_binary_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode);
+    std::shared_ptr<ISideInfo> side_info_config_to_bitpacked_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int mode);
+    std::shared_ptr<ISideInfo> side_info_config_to_hashed_features(std::shared_ptr<MatrixConfig> sideinfoConfig, int nbuckets, int seed, int mode);
 
 public:
+    // features for one side info item, stored the way its options ask for
+    virtual std::shared_ptr<ISideInfo> create_side_info(std::shared_ptr<SideInfoConfig> item, int mode);
+
     template<class MacauPrior>
     std::shared_ptr<ILatentPrior> create_macau_prior(std::shared_ptr<Session> session,
                                                      const std::vector<std::shared_ptr<ISideInfo> >& side_infos,
@@ -89,20 +96,7 @@ std::shared_ptr<ILatentPrior> PriorFactory::create_macau_prior(std::shared_ptr<S
 
    for (auto& item : config_items)
    {
-      const auto &sideinfoConfig = item->getSideInfo();
-
-      if (sideinfoConfig->isBinary())
-      {
-         side_infos.push_back(side_info_config_to_sparse_binary_features(sideinfoConfig, mode));
-      }
-      else if (sideinfoConfig->isDense())
-      {
-         side_infos.push_back(side_info_config_to_dense_features(sideinfoConfig, mode));
-      }
-      else
-      {
-         side_infos.push_back(side_info_config_to_sparse_features(sideinfoConfig, mode));
-      }
+      side_infos.push_back(create_side_info(item, mode));
    }
 
    return subFactory.create_macau_prior(session, prior_type, side_infos, config_items);
@@ -3,6 +3,7 @@
 #include <SmurffCpp/IO/MatrixIO.h>
 #include <SmurffCpp/IO/GenericIO.h>
 #include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
 
 using namespace smurff;
 using namespace Eigen;
@@ -61,6 +62,28 @@ void SpikeAndSlabPrior::update_prior()
    log_r = - r.log() + (ArrayXXd::Ones(K, nview) - r).log();
 }
 
+bool SpikeAndSlabPrior::latent_active(int k) const
+{
+   return (Zkeep.row(k) > 0).any();
+}
+
+void SpikeAndSlabPrior::prune_latents(const std::vector<int>& keep)
+{
+   NormalOnePrior::prune_latents(keep);
+
+   const int nview = data().nview(m_mode);
+
+   // reset at every update_prior
+   Zcol.init(MatrixXd::Zero(num_latent(), nview));
+   W2col.init(MatrixXd::Zero(num_latent(), nview));
+
+   matrix_utils::keep_rows(Zkeep, keep);
+   matrix_utils::keep_rows(alpha, keep);
+   matrix_utils::keep_rows(log_alpha, keep);
+   matrix_utils::keep_rows(r, keep);
+   matrix_utils::keep_rows(log_r, keep);
+}
+
 void SpikeAndSlabPrior::restore(std::shared_ptr<const StepFile> sf)
 {
   const int K = num_latent();
@@ -90,16 +113,15 @@ void SpikeAndSlabPrior::restore(std::shared_ptr<const StepFile> sf)
   update_prior();
 }
 
-std::pair<double, double> SpikeAndSlabPrior::sample_latent(int d, int k, const MatrixXd& XX, const VectorXd& yX)
+std::pair<double, double> SpikeAndSlabPrior::sample_latent(int d, int k, const MatrixXd& XX, const VectorXd& r)
 {
     const int v = data().view(m_mode, d);
     double mu, lambda;
 
-    MatrixXd aXX = alpha.matrix().col(v).asDiagonal();
-    aXX += XX;
-    std::tie(mu, lambda) = NormalOnePrior::sample_latent(d, k, aXX, yX);
-
+    // alpha only adds to the diagonal of the precision, r does not include it
     auto Ucol = U().col(d);
+    std::tie(mu, lambda) = sample_coordinate(d, k, XX(k,k) + alpha(k,v), r(k) + Ucol(k) * XX(k,k));
+
     double z1 = log_r(k,v) -  0.5 * (lambda * mu * mu - std::log(lambda) + log_alpha(k,v));
     double z = 1 / (1 + exp(z1));
     double p = rand_unif(0,1);
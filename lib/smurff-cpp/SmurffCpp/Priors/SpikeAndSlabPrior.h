@@ -36,10 +36,15 @@ public:
 
    void restore(std::shared_ptr<const StepFile> sf) override;
 
-   std::pair<double,double> sample_latent(int d, int k, const Eigen::MatrixXd& XX, const Eigen::VectorXd& yX) override;
+   std::pair<double,double> sample_latent(int d, int k, const Eigen::MatrixXd& XX, const Eigen::VectorXd& r) override;
 
    void update_prior() override;
 
+   // a latent dimention no column keeps in any view stays switched off
+   bool latent_active(int k) const override;
+
+   void prune_latents(const std::vector<int>& keep) override;
+
    // mean value of Z
    std::ostream &status(std::ostream &os, std::string indent) const override;
 };
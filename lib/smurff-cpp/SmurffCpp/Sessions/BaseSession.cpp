@@ -1,11 +1,15 @@
 #include "BaseSession.h"
 
+#include <algorithm>
 #include <fstream>
 
 #include <SmurffCpp/Priors/ILatentPrior.h>
 #include <SmurffCpp/Model.h>
 #include <SmurffCpp/result.h>
+#include <SmurffCpp/Noises/GaussianNoise.h>
 
+#include <SmurffCpp/Utils/omp_util.h>
+#include <SmurffCpp/Utils/counters.h>
 #include <SmurffCpp/Utils/Error.h>
 
 using namespace smurff;
@@ -24,14 +28,141 @@ void BaseSession::addPrior(std::shared_ptr<ILatentPrior> prior)
 
 bool BaseSession::step()
 {
-   for(auto &p : m_priors)
-      p->sample_latents();
-   data().update(model());
+   if (m_sgld)
+   {
+      sgld_step();
+   }
+   else if (m_pipeline)
+   {
+      m_prior_updates.resize(m_priors.size());
+
+      // an update is running next to the sampling at all times, so they split the threads
+      // instead of each starting a team of all of them
+      const int num_threads = threads::get_max_threads();
+      int update_threads = m_pipeline_threads ? std::min(m_pipeline_threads, num_threads) : num_threads / 2;
+      update_threads = std::max(update_threads, 1);
+      threads::init(0, std::max(num_threads - update_threads, 1));
+
+      for (std::size_t i = 0; i < m_priors.size(); i++)
+      {
+         // previous update of this mode has to be done before it is sampled again
+         if (m_prior_updates[i].valid())
+            m_prior_updates[i].get();
+
+         m_priors[i]->sample_all_latents();
+
+         std::function<void()> update = m_priors[i]->start_update_prior();
+         if (update)
+         {
+            m_prior_updates[i] = std::async(std::launch::async, [update, update_threads]()
+            {
+               threads::init(0, update_threads);
+               update();
+            });
+         }
+      }
+
+      threads::init(0, num_threads);
+   }
+   else
+   {
+      for(auto &p : m_priors)
+         p->sample_latents();
+   }
+
+   update_noise();
    return true;
 }
 
+void BaseSession::sgld_step()
+{
+   COUNTER("sgld_step");
+
+   int max_cols = 0;
+   for (std::size_t mode = 0; mode < m_priors.size(); mode++)
+      max_cols = std::max(max_cols, (int)model().U(mode).cols());
+
+   // columns of the modes interleaved, so that all modes move together
+   std::vector<std::pair<int, int> > columns;
+   for (int n = 0; n < max_cols; n++)
+   {
+      for (std::size_t mode = 0; mode < m_priors.size(); mode++)
+      {
+         if (n < model().U(mode).cols())
+            columns.emplace_back(mode, n);
+      }
+   }
+
+   #pragma omp parallel for schedule(dynamic, 256)
+   for (std::size_t i = 0; i < columns.size(); i++)
+      m_priors[columns[i].first]->sgld_latent(columns[i].second, m_sgld_step, m_sgld_batch_size);
+
+   for (auto &p : m_priors)
+      p->sgld_update_prior();
+}
+
+void BaseSession::begin_sample_latents(int mode, int& begin, int& end)
+{
+   begin = 0;
+   end = model().U(mode).cols();
+}
+
+void BaseSession::update_prior(ILatentPrior& prior)
+{
+   prior.update_prior();
+}
+
+void BaseSession::update_noise()
+{
+   data().update(model());
+}
+
+void BaseSession::join_prior_updates()
+{
+   for (auto &f : m_prior_updates)
+   {
+      if (f.valid())
+         f.get();
+   }
+}
+
+int BaseSession::prune_latents()
+{
+   join_prior_updates();
+
+   std::vector<int> keep;
+   for (int k = 0; k < model().nlatent(); k++)
+   {
+      bool active = true;
+      for (auto &p : m_priors)
+         active = active && p->latent_active(k);
+
+      if (active)
+         keep.push_back(k);
+   }
+
+   // the model needs at least one latent dimention
+   if (keep.empty())
+      keep.push_back(0);
+
+   const int npruned = model().nlatent() - keep.size();
+   if (npruned > 0)
+      prune_latents(keep);
+
+   return npruned;
+}
+
+void BaseSession::prune_latents(const std::vector<int>& keep)
+{
+   model().prune_latents(keep);
+   for (auto &p : m_priors)
+      p->prune_latents(keep);
+}
+
 std::ostream &BaseSession::info(std::ostream &os, std::string indent)
 {
+   join_prior_updates();
+
    os << indent << "  Data: {" << std::endl;
    data().info(os, indent + "    ");
    os << indent << "  }" << std::endl;
@@ -50,11 +181,24 @@ std::ostream &BaseSession::info(std::ostream &os, std::string indent)
 
 void BaseSession::save(std::shared_ptr<StepFile> stepFile)
 {
+   join_prior_updates();
    stepFile->save(m_model, m_pred, m_priors);
+
+   //fold-in samples new entities with the noise of the sample
+   auto noise = dynamic_cast<const GaussianNoise*>(&data().noise());
+   if (m_save_hyper && noise)
+      stepFile->saveNoisePrecision(noise->getAlpha());
 }
 
 void BaseSession::restore(std::shared_ptr<StepFile> stepFile)
 {
+   join_prior_updates();
+
+   // a pruned model is saved without its dropped rows
+   std::vector<int> active_latents = stepFile->getActiveLatents();
+   if (!active_latents.empty())
+      prune_latents(active_latents);
+
    stepFile->restore(m_model, m_pred, m_priors);
 }
 
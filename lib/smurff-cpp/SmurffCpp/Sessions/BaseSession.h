@@ -3,6 +3,9 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <future>
+
+#include <Eigen/Dense>
 
 #include <SmurffCpp/Sessions/ISession.h>
 #include <SmurffCpp/Utils/Error.h>
@@ -29,6 +32,21 @@ protected:
    std::vector<std::shared_ptr<ILatentPrior> > m_priors;
    std::string name;
 
+protected:
+   // run the deterministic part of update_prior concurrently with
+   // the sampling of the next mode
+   bool m_pipeline = false;
+   int m_pipeline_threads = 0; //threads of the updates, the sampling keeps the others
+   std::vector<std::future<void> > m_prior_updates;
+
+   // stochastic gradient Langevin steps instead of gibbs sampling of the latents
+   bool m_sgld = false;
+   double m_sgld_step = .0;
+   int m_sgld_batch_size = 0;
+
+   // the normal priors save mu and Lambda with every sample
+   bool m_save_hyper = false;
+
 protected:
    bool is_init = false;
 
@@ -64,11 +82,47 @@ public:
 public:
    bool step() override;
 
+   // wait for the pipelined prior updates that are still running
+   void join_prior_updates();
+
+private:
+   // one sgld step of every column of every mode, in a single lock-free parallel loop
+   void sgld_step();
+
+public:
+
+   // called by a prior before sampling the latents of mode,
+   // [begin, end) are the columns sampled by this process, all of them by default
+   virtual void begin_sample_latents(int mode, int& begin, int& end);
+
+   // called by a prior after sampling the latents of mode,
+   // makes the columns sampled elsewhere and the sums over all columns available
+   virtual void end_sample_latents(int mode, Eigen::VectorXd& Usum, Eigen::MatrixXd& UUsum) {}
+
+   // called by a prior in place of its update_prior, prior.update_prior() by default
+   virtual void update_prior(ILatentPrior& prior);
+
+   // updates the noise of the train data after all modes are sampled, data().update(model()) by default
+   virtual void update_noise();
+
+   // drops the latent dimentions that a prior has switched off for good,
+   // returns the number of dimentions dropped
+   int prune_latents();
+
+protected:
+   // keep - indices of the latent dimentions to keep
+   void prune_latents(const std::vector<int>& keep);
+
 public:
    std::ostream &info(std::ostream &, std::string indent) override;
 
    void save(std::shared_ptr<StepFile> stepFile);
 
+   bool getSaveHyper() const
+   {
+      return m_save_hyper;
+   }
+
    void restore(std::shared_ptr<StepFile> stepFile);
 
 public:
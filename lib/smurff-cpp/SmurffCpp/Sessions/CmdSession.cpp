@@ -7,6 +7,8 @@
 #endif
 
 #include "CmdSession.h"
+#include "MultiChainSession.h"
+#include "CrossValidationSession.h"
 
 #include <SmurffCpp/Configs/Config.h>
 #include <SmurffCpp/Utils/counters.h>
@@ -25,13 +27,31 @@
 #define TRAIN_NAME "train"
 #define BURNIN_NAME "burnin"
 #define NSAMPLES_NAME "nsamples"
+#define AUTO_BURNIN_NAME "auto-burnin"
+#define MAX_RHAT_NAME "max-rhat"
+#define TARGET_ESS_NAME "target-ess"
+#define COARSE_BURNIN_NAME "coarse-burnin"
+#define COARSE_FRACTION_NAME "coarse-fraction"
 #define NUM_LATENT_NAME "num-latent"
 #define NUM_THREADS_NAME "num-threads"
+#define NUM_CHAINS_NAME "num-chains"
+#define CV_FOLDS_NAME "cv-folds"
+#define WARM_START_NAME "warm-start"
+#define PIPELINE_NAME "pipeline"
+#define PIPELINE_THREADS_NAME "pipeline-threads"
+#define PRUNE_LATENTS_NAME "prune-latents"
+#define DATA_PARALLEL_NAME "data-parallel"
 #define INIT_MODEL_NAME "init-model"
+#define SAMPLER_NAME "sampler"
+#define SGLD_BATCH_SIZE_NAME "sgld-batch-size"
+#define SGLD_STEP_NAME "sgld-step"
+#define ALS_SWEEPS_NAME "als-sweeps"
+#define ALS_REG_NAME "als-reg"
 #define SAVE_PREFIX_NAME "save-prefix"
 #define SAVE_EXTENSION_NAME "save-extension"
 #define SAVE_FREQ_NAME "save-freq"
 #define CHECKPOINT_FREQ_NAME "checkpoint-freq"
+#define SAVE_HYPER_NAME "save-hyper"
 #define THRESHOLD_NAME "threshold"
 #define VERBOSE_NAME "verbose"
 #define QUIET_NAME "quiet"
@@ -72,13 +92,31 @@ boost::program_options::options_description get_desc()
       (ROOT_NAME, boost::program_options::value<std::string>(), "restore session from root .ini file")
       (BURNIN_NAME, boost::program_options::value<int>()->default_value(Config::BURNIN_DEFAULT_VALUE), "number of samples to discard")
       (NSAMPLES_NAME, boost::program_options::value<int>()->default_value(Config::NSAMPLES_DEFAULT_VALUE), "number of samples to collect")
+      (AUTO_BURNIN_NAME, "end burnin once split-Rhat of the diagnostics is below max-rhat, burnin is the maximum")
+      (MAX_RHAT_NAME, boost::program_options::value<double>()->default_value(Config::MAX_RHAT_DEFAULT_VALUE), "split-Rhat that ends an automatic burnin")
+      (TARGET_ESS_NAME, boost::program_options::value<double>()->default_value(Config::TARGET_ESS_DEFAULT_VALUE), "stop sampling once the effective sample size of the diagnostics reaches this, nsamples is the maximum (0 = off)")
+      (COARSE_BURNIN_NAME, boost::program_options::value<int>()->default_value(Config::COARSE_BURNIN_DEFAULT_VALUE), "first burnin iterations on a random subsample of the train data (0 = off)")
+      (COARSE_FRACTION_NAME, boost::program_options::value<double>()->default_value(Config::COARSE_FRACTION_DEFAULT_VALUE), "fraction of the train entries in the subsample of the coarse burnin")
       (NUM_LATENT_NAME, boost::program_options::value<int>()->default_value(Config::NUM_LATENT_DEFAULT_VALUE), "number of latent dimensions")
       (NUM_THREADS_NAME, boost::program_options::value<int>()->default_value(Config::NUM_THREADS_DEFAULT_VALUE), "number of threads (0 = default by OpenMP)")
-      (INIT_MODEL_NAME, boost::program_options::value<std::string>()->default_value(modelInitTypeToString(Config::INIT_MODEL_DEFAULT_VALUE)), "Initialize model using <random|zero> values")
+      (NUM_CHAINS_NAME, boost::program_options::value<int>()->default_value(Config::NUM_CHAINS_DEFAULT_VALUE), "number of independent chains sampled in one process")
+      (CV_FOLDS_NAME, boost::program_options::value<int>()->default_value(Config::CV_FOLDS_DEFAULT_VALUE), "k-fold cross-validation over the train data (0 = off)")
+      (WARM_START_NAME, boost::program_options::value<std::string>(), "start from the last sample in this root .ini file of a previous run, train data may have appended rows and columns")
+      (PIPELINE_NAME, "overlap the link matrix update of a mode with the sampling of the next mode")
+      (PIPELINE_THREADS_NAME, boost::program_options::value<int>()->default_value(Config::PIPELINE_THREADS_DEFAULT_VALUE), "pipeline: threads of the link matrix updates, taken from the sampling (0 = half of them)")
+      (PRUNE_LATENTS_NAME, "after burnin, drop the latent dimentions switched off by the priors")
+      (DATA_PARALLEL_NAME, "mpi: every rank samples a slice of the latent vectors of each mode, every rank but 0 only keeps the train entries of its slices")
+      (INIT_MODEL_NAME, boost::program_options::value<std::string>()->default_value(modelInitTypeToString(Config::INIT_MODEL_DEFAULT_VALUE)), "Initialize model using <random|zero|als> values, als runs alternating least squares sweeps from a random start")
+      (SAMPLER_NAME, boost::program_options::value<std::string>()->default_value(samplerTypeToString(Config::SAMPLER_DEFAULT_VALUE)), "sampler engine <gibbs|sgld>, sgld takes approximate Langevin steps from minibatches of the train entries")
+      (SGLD_BATCH_SIZE_NAME, boost::program_options::value<int>()->default_value(Config::SGLD_BATCH_SIZE_DEFAULT_VALUE), "sgld: train entries of a row or column in its minibatch")
+      (SGLD_STEP_NAME, boost::program_options::value<double>()->default_value(Config::SGLD_STEP_DEFAULT_VALUE), "sgld: step size in (0, 1], relative to the posterior variance")
+      (ALS_SWEEPS_NAME, boost::program_options::value<int>()->default_value(Config::ALS_SWEEPS_DEFAULT_VALUE), "number of alternating least squares sweeps of the als init")
+      (ALS_REG_NAME, boost::program_options::value<double>()->default_value(Config::ALS_REG_DEFAULT_VALUE), "ridge regularization of the als init")
       (SAVE_PREFIX_NAME, boost::program_options::value<std::string>()->default_value(Config::SAVE_PREFIX_DEFAULT_VALUE), "prefix for result files")
       (SAVE_EXTENSION_NAME, boost::program_options::value<std::string>()->default_value(Config::SAVE_EXTENSION_DEFAULT_VALUE), "extension for result files (.csv or .ddm)")
       (SAVE_FREQ_NAME, boost::program_options::value<int>()->default_value(Config::SAVE_FREQ_DEFAULT_VALUE), "save every n iterations (0 == never, -1 == final model)")
       (CHECKPOINT_FREQ_NAME, boost::program_options::value<int>()->default_value(Config::CHECKPOINT_FREQ_DEFAULT_VALUE), "save state every n seconds, only one checkpointing state is kept")
+      (SAVE_HYPER_NAME, "also save mu and Lambda of the normal priors with every sample, needed to fold in new entities")
       (THRESHOLD_NAME, boost::program_options::value<double>()->default_value(Config::THRESHOLD_DEFAULT_VALUE), "threshold for binary classification and AUC calculation")
       (VERBOSE_NAME, boost::program_options::value<int>()->default_value(Config::VERBOSE_DEFAULT_VALUE), "verbosity of output (0, 1, 2 or 3)")
       (QUIET_NAME, "no output (equivalent to verbose=0)")
@@ -248,15 +286,66 @@ void fill_config(boost::program_options::variables_map& vm, Config& config)
    if (vm.count(NSAMPLES_NAME) && !vm[NSAMPLES_NAME].defaulted())
       config.setNSamples(vm[NSAMPLES_NAME].as<int>());
 
+   if (vm.count(AUTO_BURNIN_NAME))
+      config.setAutoBurnin(true);
+
+   if (vm.count(MAX_RHAT_NAME) && !vm[MAX_RHAT_NAME].defaulted())
+      config.setMaxRhat(vm[MAX_RHAT_NAME].as<double>());
+
+   if (vm.count(TARGET_ESS_NAME) && !vm[TARGET_ESS_NAME].defaulted())
+      config.setTargetEss(vm[TARGET_ESS_NAME].as<double>());
+
+   if (vm.count(COARSE_BURNIN_NAME) && !vm[COARSE_BURNIN_NAME].defaulted())
+      config.setCoarseBurnin(vm[COARSE_BURNIN_NAME].as<int>());
+
+   if (vm.count(COARSE_FRACTION_NAME) && !vm[COARSE_FRACTION_NAME].defaulted())
+      config.setCoarseFraction(vm[COARSE_FRACTION_NAME].as<double>());
+
    if (vm.count(NUM_LATENT_NAME) && !vm[NUM_LATENT_NAME].defaulted())
       config.setNumLatent(vm[NUM_LATENT_NAME].as<int>());
 
    if (vm.count(NUM_THREADS_NAME) && !vm[NUM_THREADS_NAME].defaulted())
      config.setNumThreads(vm[NUM_THREADS_NAME].as<int>());
 
-   if(vm.count(INIT_MODEL_NAME))
+   if (vm.count(NUM_CHAINS_NAME) && !vm[NUM_CHAINS_NAME].defaulted())
+     config.setNumChains(vm[NUM_CHAINS_NAME].as<int>());
+
+   if (vm.count(CV_FOLDS_NAME) && !vm[CV_FOLDS_NAME].defaulted())
+     config.setCVFolds(vm[CV_FOLDS_NAME].as<int>());
+
+   if (vm.count(WARM_START_NAME))
+     config.setWarmStart(vm[WARM_START_NAME].as<std::string>());
+
+   if (vm.count(PIPELINE_NAME))
+     config.setPipeline(true);
+
+   if (vm.count(PIPELINE_THREADS_NAME) && !vm[PIPELINE_THREADS_NAME].defaulted())
+     config.setPipelineThreads(vm[PIPELINE_THREADS_NAME].as<int>());
+
+   if (vm.count(PRUNE_LATENTS_NAME))
+     config.setPruneLatents(true);
+
+   if (vm.count(DATA_PARALLEL_NAME))
+     config.setDataParallel(true);
+
+   if (vm.count(INIT_MODEL_NAME) && !vm[INIT_MODEL_NAME].defaulted())
       config.setModelInitType(stringToModelInitType(vm[INIT_MODEL_NAME].as<std::string>()));
 
+   if (vm.count(SAMPLER_NAME) && !vm[SAMPLER_NAME].defaulted())
+      config.setSamplerType(stringToSamplerType(vm[SAMPLER_NAME].as<std::string>()));
+
+   if (vm.count(SGLD_BATCH_SIZE_NAME) && !vm[SGLD_BATCH_SIZE_NAME].defaulted())
+      config.setSgldBatchSize(vm[SGLD_BATCH_SIZE_NAME].as<int>());
+
+   if (vm.count(SGLD_STEP_NAME) && !vm[SGLD_STEP_NAME].defaulted())
+      config.setSgldStep(vm[SGLD_STEP_NAME].as<double>());
+
+   if (vm.count(ALS_SWEEPS_NAME) && !vm[ALS_SWEEPS_NAME].defaulted())
+      config.setAlsSweeps(vm[ALS_SWEEPS_NAME].as<int>());
+
+   if (vm.count(ALS_REG_NAME) && !vm[ALS_REG_NAME].defaulted())
+      config.setAlsReg(vm[ALS_REG_NAME].as<double>());
+
    if (vm.count(SAVE_PREFIX_NAME) && !vm[SAVE_PREFIX_NAME].defaulted())
       config.setSavePrefix(vm[SAVE_PREFIX_NAME].as<std::string>());
 
@@ -269,6 +358,9 @@ void fill_config(boost::program_options::variables_map& vm, Config& config)
    if (vm.count(CHECKPOINT_FREQ_NAME) && !vm[CHECKPOINT_FREQ_NAME].defaulted())
       config.setCheckpointFreq(vm[CHECKPOINT_FREQ_NAME].as<int>());
 
+   if (vm.count(SAVE_HYPER_NAME))
+      config.setSaveHyper(true);
+
    if (vm.count(THRESHOLD_NAME) && !vm[THRESHOLD_NAME].defaulted())
    {
       config.setThreshold(vm[THRESHOLD_NAME].as<double>());
@@ -343,6 +435,8 @@ bool CmdSession::parse_options(int argc, char* argv[])
          //override root file config with options
          fill_config(vm, config);
 
+         THROWERROR_ASSERT_MSG(config.getNumChains() == 1 && !config.getCVFolds(), "Resuming a session with multiple chains or cross-validation is not supported");
+
          //create session from config, open root file
          setRestoreFromConfig(config, root_name);
          return true;
@@ -429,6 +523,16 @@ bool CmdSession::parse_options(int argc, char* argv[])
    #endif
 }
 
+void CmdSession::setCreateFromConfig(const Config& cfg)
+{
+   if (cfg.getCVFolds())
+      m_multi_session = std::make_shared<CrossValidationSession>(cfg);
+   else if (cfg.getNumChains() > 1)
+      m_multi_session = std::make_shared<MultiChainSession>(cfg);
+   else
+      Session::setCreateFromConfig(cfg);
+}
+
 void CmdSession::setFromArgs(int argc, char** argv)
 {
    std::shared_ptr<RootFile> rootFile;
@@ -443,5 +547,7 @@ std::shared_ptr<ISession> smurff::create_cmd_session(int argc, char** argv)
 {
    std::shared_ptr<CmdSession> session(new CmdSession());
    session->setFromArgs(argc, argv);
+   if (session->m_multi_session)
+      return session->m_multi_session;
    return session;
 }
@@ -6,12 +6,21 @@ namespace smurff {
 
    class CmdSession : public Session
    {
+      friend std::shared_ptr<ISession> create_cmd_session(int argc, char** argv);
+
+   private:
+      //runs instead of this session when the config asks for several chains or cross-validation
+      std::shared_ptr<ISession> m_multi_session;
+
    public:
       CmdSession() {}
 
    public:
       void setFromArgs(int argc, char** argv);
 
+   protected:
+      void setCreateFromConfig(const Config& cfg) override;
+
    private:
       bool parse_options(int argc, char* argv[]);
    };
@@ -0,0 +1,212 @@
+#include "CrossValidationSession.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+#include <SmurffCpp/DataMatrices/DataCreatorBase.h>
+#include <SmurffCpp/DataMatrices/FoldMatrixData.h>
+
+#include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/StringUtils.h>
+
+#include <SmurffCpp/result.h>
+
+using namespace smurff;
+
+std::shared_ptr<Data> FoldSession::create_data()
+{
+   return m_fold_data;
+}
+
+std::shared_ptr<IPriorFactory> FoldSession::create_prior_factory() const
+{
+   return std::make_shared<CachedPriorFactory>(m_side_infos);
+}
+
+//-------
+
+CrossValidationSession::CrossValidationSession(const Config& cfg)
+   : m_config(cfg)
+{
+   m_config.validate();
+   THROWERROR_ASSERT_MSG(m_config.getCVFolds() > 1, "Cross-validation needs at least 2 folds");
+
+   int seed = m_config.getRandomSeed();
+   if (!m_config.getRandomSeedSet())
+      seed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+   // the train matrix is loaded once, the folds only hold masks over it
+   auto train = std::dynamic_pointer_cast<ScarceMatrixData>(m_config.getTrain()->create(std::make_shared<DataCreatorBase>()));
+   THROWERROR_ASSERT_MSG(train, "Cross-validation needs a sparse train matrix with missing values (scarce)");
+
+   auto assign_rng = create_bmrng_state(seed);
+   swap_bmrng(*assign_rng);
+   auto folds = FoldMatrixData::assign_folds(*train, m_config.getCVFolds());
+   swap_bmrng(*assign_rng);
+
+   auto side_infos = std::make_shared<CachedPriorFactory::Cache>();
+   for (int f = 0; f < m_config.getCVFolds(); f++)
+   {
+      Config foldConfig = m_config;
+      foldConfig.setCVFolds(0);
+      foldConfig.setVerbose(0);
+      foldConfig.setTest(FoldMatrixData::held_out(*train, *folds, f));
+      if (m_config.getCsvStatus().size())
+         foldConfig.setCsvStatus(addFileNameSuffix(m_config.getCsvStatus(), "-fold" + std::to_string(f)));
+
+      auto fold_data = std::make_shared<FoldMatrixData>(*train, folds, f);
+
+      std::shared_ptr<FoldSession> fold(new FoldSession(fold_data, side_infos));
+      fold->setCreateFromConfig(foldConfig);
+      m_folds.push_back(fold);
+
+      // streams far enough apart for the per-thread offsets of init_bmrng
+      m_rngs.push_back(create_bmrng_state(seed + (f + 1) * 1000003));
+   }
+}
+
+void CrossValidationSession::init()
+{
+   for (std::size_t f = 0; f < m_folds.size(); f++)
+   {
+      swap_bmrng(*m_rngs[f]);
+      m_folds[f]->init();
+      swap_bmrng(*m_rngs[f]);
+   }
+
+   if (m_config.getVerbose())
+   {
+      info(std::cout, "");
+      printStatus(std::cout);
+   }
+}
+
+void CrossValidationSession::run()
+{
+   init();
+   while (step());
+}
+
+bool CrossValidationSession::step()
+{
+   m_iter++;
+
+   // folds take turns, each step uses all threads
+   bool isStep = true;
+   auto starti = tick();
+   for (std::size_t f = 0; f < m_folds.size(); f++)
+   {
+      swap_bmrng(*m_rngs[f]);
+      isStep = m_folds[f]->step();
+      swap_bmrng(*m_rngs[f]);
+   }
+   m_secs_per_iter = tick() - starti;
+
+   if (!isStep)
+      return false;
+
+   printStatus(std::cout);
+
+   return true;
+}
+
+std::shared_ptr<std::vector<ResultItem> > CrossValidationSession::getResult() const
+{
+   auto all = std::make_shared<std::vector<ResultItem> >();
+   for (auto& fold : m_folds)
+   {
+      auto result = fold->getResult();
+      all->insert(all->end(), result->begin(), result->end());
+   }
+   return all;
+}
+
+std::shared_ptr<StatusItem> CrossValidationSession::getStatus() const
+{
+   std::shared_ptr<StatusItem> ret = m_folds.front()->getStatus();
+
+   ret->train_rmse = .0;
+   for (auto& fold : m_folds)
+      ret->train_rmse += fold->getStatus()->train_rmse / m_folds.size();
+
+   // every entry is predicted by exactly one fold
+   auto all = getResult();
+   if (!all->empty())
+   {
+      double se_1sample = .0, se_avg = .0;
+      for (const auto& t : *all)
+      {
+         se_1sample += std::pow(t.val - t.pred_1sample, 2);
+         se_avg += std::pow(t.val - t.pred_avg, 2);
+      }
+      ret->rmse_1sample = std::sqrt(se_1sample / all->size());
+      ret->rmse_avg = std::sqrt(se_avg / all->size());
+
+      if (m_config.getClassify() && m_folds.front()->m_pred->sample_iter > 0)
+      {
+         ret->auc_avg = calc_auc(*all, m_config.getThreshold(),
+               [](const ResultItem &a, const ResultItem &b) { return a.pred_avg < b.pred_avg;});
+      }
+   }
+
+   ret->elapsed_iter = m_secs_per_iter;
+   ret->nnz_per_sec = (double)m_folds.front()->data().nnz() * m_folds.size() / m_secs_per_iter;
+   ret->samples_per_sec = (double)m_folds.front()->model().nsamples() * m_folds.size() / m_secs_per_iter;
+
+   return ret;
+}
+
+MatrixConfig CrossValidationSession::getSample(int mode) const
+{
+   return m_folds.front()->getSample(mode);
+}
+
+std::shared_ptr<RootFile> CrossValidationSession::getRootFile() const
+{
+   THROWERROR("Cross-validation does not save models");
+}
+
+std::ostream& CrossValidationSession::info(std::ostream &os, std::string indent)
+{
+   os << indent << "CrossValidationSession {\n";
+   os << indent << "  Folds: " << m_folds.size() << " (sharing train data and side info)\n";
+   m_folds.front()->info(os, indent + "  ");
+   os << indent << "}\n";
+   return os;
+}
+
+void CrossValidationSession::printStatus(std::ostream& output) const
+{
+   if (!m_config.getVerbose())
+      return;
+
+   auto status_item = getStatus();
+
+   if (m_iter < 0)
+      output << " ====== Initial phase ====== " << std::endl;
+   else if (m_iter == 0 && m_config.getBurnin() > 0)
+      output << " ====== Sampling (burning phase) ====== " << std::endl;
+   else if (m_iter == m_config.getBurnin())
+      output << " ====== Burn-in complete, averaging samples ====== " << std::endl;
+
+   output << status_item->phase
+      << " "
+      << std::setfill(' ') << std::setw(3) << status_item->iter
+      << "/"
+      << std::setfill(' ') << std::setw(3) << status_item->phase_iter
+      << ": RMSE: "
+      << std::fixed << std::setprecision(4) << status_item->rmse_avg
+      << " (1samp: "
+      << std::fixed << std::setprecision(4) << status_item->rmse_1sample
+      << ", per fold:";
+
+   for (auto& fold : m_folds)
+      output << " " << std::fixed << std::setprecision(4) << fold->getStatus()->rmse_avg;
+
+   output << ") [took: "
+      << std::fixed << std::setprecision(1) << status_item->elapsed_iter
+      << "s]"
+      << std::endl;
+}
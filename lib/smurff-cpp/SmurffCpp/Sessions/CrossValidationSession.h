@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <SmurffCpp/Sessions/Session.h>
+#include <SmurffCpp/Priors/CachedPriorFactory.h>
+#include <SmurffCpp/Utils/Distribution.h>
+
+namespace smurff {
+
+class CrossValidationSession;
+class FoldMatrixData;
+
+// one fold of a CrossValidationSession,
+// trains on a view of the shared train data that hides its fold and tests on the hidden entries
+class FoldSession : public Session
+{
+   friend class CrossValidationSession;
+
+private:
+   std::shared_ptr<FoldMatrixData> m_fold_data;
+   std::shared_ptr<CachedPriorFactory::Cache> m_side_infos;
+
+protected:
+   FoldSession(std::shared_ptr<FoldMatrixData> fold_data, std::shared_ptr<CachedPriorFactory::Cache> side_infos)
+      : m_fold_data(fold_data), m_side_infos(side_infos)
+   {
+      name = "FoldSession";
+   }
+
+protected:
+   std::shared_ptr<Data> create_data() override;
+
+   //the generators of a fold are swapped in by the CrossValidationSession
+   void initRng() override {}
+
+public:
+   std::shared_ptr<IPriorFactory> create_prior_factory() const override;
+};
+
+// k-fold cross-validation in one process,
+// every entry of the train matrix is assigned to one fold and predicted by the model that did not see it.
+// The folds are sampled as chains that share the train matrix and the side info.
+class CrossValidationSession : public ISession
+{
+private:
+   Config m_config;
+
+   std::vector<std::shared_ptr<FoldSession> > m_folds;
+   std::vector<std::shared_ptr<bmrng_state> > m_rngs;
+
+   int m_iter = -1;
+   double m_secs_per_iter = .0;
+
+public:
+   CrossValidationSession(const Config& cfg);
+
+public:
+   void run() override;
+   bool step() override;
+   void init() override;
+
+   // metrics over the held-out entries of all folds
+   std::shared_ptr<StatusItem> getStatus() const override;
+
+   // predictions of the held-out entries of all folds
+   std::shared_ptr<std::vector<ResultItem> > getResult() const override;
+
+   // sample of the first fold
+   MatrixConfig getSample(int mode) const override;
+
+   std::shared_ptr<RootFile> getRootFile() const override;
+
+   std::ostream &info(std::ostream &, std::string indent) override;
+
+public:
+   int getNumFolds() const
+   {
+      return m_folds.size();
+   }
+
+   std::shared_ptr<ISession> getFold(int fold) const
+   {
+      return m_folds.at(fold);
+   }
+
+private:
+   void printStatus(std::ostream& output) const;
+};
+
+}
@@ -0,0 +1,372 @@
+#include "MultiChainSession.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+#include <SmurffCpp/DataMatrices/Data.h>
+#include <SmurffCpp/Priors/CachedPriorFactory.h>
+
+#include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/StringUtils.h>
+
+#include <SmurffCpp/result.h>
+
+using namespace smurff;
+
+std::shared_ptr<Data> ChainSession::create_data()
+{
+   if (!m_shared_data)
+      return Session::create_data();
+
+   return m_shared_data->clone();
+}
+
+std::shared_ptr<IPriorFactory> ChainSession::create_prior_factory() const
+{
+   return std::make_shared<CachedPriorFactory>(m_side_infos);
+}
+
+//-------
+
+MultiChainSession::MultiChainSession(const Config& cfg)
+   : m_config(cfg)
+{
+   m_config.validate();
+
+   m_burnin = m_config.getBurnin();
+   m_nsamples = m_config.getNSamples();
+
+   if (m_config.getSaveFreq())
+   {
+      m_rootFile = std::make_shared<RootFile>(m_config.getSavePrefix(), m_config.getSaveExtension());
+      m_rootFile->saveConfig(m_config);
+   }
+
+   int seed = m_config.getRandomSeed();
+   if (!m_config.getRandomSeedSet())
+      seed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+   auto side_infos = std::make_shared<CachedPriorFactory::Cache>();
+   for (int c = 0; c < m_config.getNumChains(); c++)
+   {
+      Config chainConfig = m_config;
+      chainConfig.setNumChains(1);
+      chainConfig.setVerbose(0);
+      // convergence is decided on all chains together
+      chainConfig.setAutoBurnin(false);
+      chainConfig.setTargetEss(0);
+      chainConfig.setSavePrefix(m_config.getSavePrefix() + "-chain" + std::to_string(c));
+      if (m_config.getCsvStatus().size())
+         chainConfig.setCsvStatus(addFileNameSuffix(m_config.getCsvStatus(), "-chain" + std::to_string(c)));
+
+      // chains after the first one share its train data (Y is held by reference)
+      std::shared_ptr<Data> shared_data;
+      if (c > 0)
+         shared_data = m_chains.front()->data_ptr;
+
+      std::shared_ptr<ChainSession> chain(new ChainSession(shared_data, side_infos));
+      chain->setCreateFromConfig(chainConfig);
+      m_chains.push_back(chain);
+
+      // streams far enough apart for the per-thread offsets of init_bmrng
+      m_rngs.push_back(create_bmrng_state(seed + c * 1000003));
+
+      if (m_rootFile)
+         m_rootFile->addChainRootFile(c, chain->getRootFile()->getRootFileName());
+   }
+
+   if (m_rootFile)
+      m_rootFile->flushLast();
+}
+
+void MultiChainSession::init()
+{
+   for (std::size_t c = 0; c < m_chains.size(); c++)
+   {
+      swap_bmrng(*m_rngs[c]);
+      m_chains[c]->init();
+      swap_bmrng(*m_rngs[c]);
+   }
+
+   if (m_config.getVerbose())
+   {
+      info(std::cout, "");
+      printStatus(std::cout);
+   }
+}
+
+void MultiChainSession::run()
+{
+   init();
+   while (step());
+}
+
+bool MultiChainSession::step()
+{
+   m_iter++;
+
+   // chains take turns, each step uses all threads
+   bool isStep = true;
+   auto starti = tick();
+   for (std::size_t c = 0; c < m_chains.size(); c++)
+   {
+      swap_bmrng(*m_rngs[c]);
+      isStep = m_chains[c]->step();
+      swap_bmrng(*m_rngs[c]);
+   }
+   m_secs_per_iter = tick() - starti;
+
+   if (!isStep)
+      return false;
+
+   updateDiagnostics();
+
+   printStatus(std::cout);
+
+   if (m_rootFile && m_iter == m_burnin + m_nsamples - 1)
+      saveCombinedPred();
+
+   return true;
+}
+
+void MultiChainSession::diagnosticsWindow(int& begin, int& end) const
+{
+   end = m_iter + 1;
+   begin = m_iter < m_burnin ? end / 2 : m_burnin;
+}
+
+std::vector<const Diagnostics*> MultiChainSession::getDiagnostics() const
+{
+   std::vector<const Diagnostics*> diagnostics;
+   for (auto& chain : m_chains)
+      diagnostics.push_back(&chain->getDiagnostics());
+   return diagnostics;
+}
+
+void MultiChainSession::updateDiagnostics()
+{
+   int begin, end;
+   diagnosticsWindow(begin, end);
+
+   if (m_iter < m_burnin)
+   {
+      // burnin is over once all chains agree with each other
+      if (!m_config.getAutoBurnin() || !(Diagnostics::rhat(getDiagnostics(), begin, end) < m_config.getMaxRhat()))
+         return;
+
+      m_burnin = m_iter + 1;
+      for (std::size_t c = 0; c < m_chains.size(); c++)
+      {
+         swap_bmrng(*m_rngs[c]);
+         m_chains[c]->endBurnin();
+         swap_bmrng(*m_rngs[c]);
+      }
+
+      if (m_config.getVerbose())
+         std::cout << "-- Burnin converged after " << m_burnin << " iterations." << std::endl;
+   }
+   else if (m_config.getTargetEss() > 0 && Diagnostics::ess(getDiagnostics(), begin, end) >= m_config.getTargetEss())
+   {
+      m_nsamples = m_iter - m_burnin + 1;
+      for (auto& chain : m_chains)
+      {
+         chain->stopSampling();
+
+         // the chain has already passed its save of this iteration
+         if (m_config.getSaveFreq() < 0)
+            chain->save(m_iter);
+      }
+
+      if (m_config.getVerbose())
+         std::cout << "-- Target ESS reached after " << m_nsamples << " samples per chain." << std::endl;
+   }
+}
+
+std::shared_ptr<std::vector<ResultItem> > MultiChainSession::getResult() const
+{
+   auto pooled = std::make_shared<std::vector<ResultItem> >();
+
+   auto first = m_chains.front()->getResult();
+   if (!first || first->empty())
+      return pooled;
+
+   // every chain has the same number of samples
+   const double nchains = m_chains.size();
+   const double nsamples = m_chains.front()->m_pred->sample_iter;
+
+   std::vector<std::shared_ptr<std::vector<ResultItem> > > results;
+   for (auto& chain : m_chains)
+      results.push_back(chain->getResult());
+
+   *pooled = *first;
+
+   #pragma omp parallel for schedule(static)
+   for (std::size_t k = 0; k < pooled->size(); k++)
+   {
+      auto& t = pooled->at(k);
+
+      double pred_1sample = .0, pred_avg = .0;
+      for (auto& result : results)
+      {
+         const auto& item = result->at(k);
+         pred_1sample += item.pred_1sample;
+         pred_avg += item.pred_avg;
+      }
+      pred_1sample /= nchains;
+      pred_avg /= nchains;
+
+      // var is the sum of squared deviations, pooled over the chains
+      double var = .0;
+      for (auto& result : results)
+      {
+         const auto& item = result->at(k);
+         var += item.var + nsamples * std::pow(item.pred_avg - pred_avg, 2);
+      }
+
+      t.pred_1sample = pred_1sample;
+      t.pred_avg = pred_avg;
+      t.var = var;
+      t.stds = nsamples > 0 ? std::sqrt(var / (nchains * nsamples)) : .0;
+   }
+
+   return pooled;
+}
+
+std::shared_ptr<StatusItem> MultiChainSession::getStatus() const
+{
+   std::shared_ptr<StatusItem> ret = m_chains.front()->getStatus();
+
+   ret->rmse_1sample = .0;
+   ret->train_rmse = .0;
+   for (auto& chain : m_chains)
+   {
+      auto status = chain->getStatus();
+      ret->rmse_1sample += status->rmse_1sample / m_chains.size();
+      ret->train_rmse += status->train_rmse / m_chains.size();
+   }
+
+   auto pooled = getResult();
+   if (!pooled->empty() && m_chains.front()->m_pred->sample_iter > 0)
+   {
+      double se_avg = .0;
+      for (const auto& t : *pooled)
+         se_avg += std::pow(t.val - t.pred_avg, 2);
+      ret->rmse_avg = std::sqrt(se_avg / pooled->size());
+
+      if (m_config.getClassify())
+      {
+         ret->auc_avg = calc_auc(*pooled, m_config.getThreshold(),
+               [](const ResultItem &a, const ResultItem &b) { return a.pred_avg < b.pred_avg;});
+      }
+   }
+
+   ret->ess = std::numeric_limits<double>::quiet_NaN();
+   ret->rhat = std::numeric_limits<double>::quiet_NaN();
+   if (m_config.getRecordDiagnostics())
+   {
+      int begin, end;
+      diagnosticsWindow(begin, end);
+      ret->ess = Diagnostics::ess(getDiagnostics(), begin, end);
+      ret->rhat = Diagnostics::rhat(getDiagnostics(), begin, end);
+   }
+
+   ret->elapsed_iter = m_secs_per_iter;
+   ret->nnz_per_sec = (double)(m_chains.front()->data().nnz() * m_chains.size()) / m_secs_per_iter;
+   ret->samples_per_sec = (double)(m_chains.front()->model().nsamples() * m_chains.size()) / m_secs_per_iter;
+
+   return ret;
+}
+
+MatrixConfig MultiChainSession::getSample(int mode) const
+{
+   return m_chains.front()->getSample(mode);
+}
+
+std::shared_ptr<RootFile> MultiChainSession::getRootFile() const
+{
+   THROWERROR_ASSERT_MSG(m_rootFile, "No root file found. Did you save any models?");
+   return m_rootFile;
+}
+
+std::ostream& MultiChainSession::info(std::ostream &os, std::string indent)
+{
+   os << indent << "MultiChainSession {\n";
+   os << indent << "  Chains: " << m_chains.size() << " (sharing train data and side info)\n";
+   m_chains.front()->info(os, indent + "  ");
+   os << indent << "}\n";
+   return os;
+}
+
+void MultiChainSession::printStatus(std::ostream& output) const
+{
+   if (!m_config.getVerbose())
+      return;
+
+   auto status_item = getStatus();
+
+   if (m_iter < 0)
+      output << " ====== Initial phase ====== " << std::endl;
+   else if (m_iter == 0 && m_burnin > 0)
+      output << " ====== Sampling (burning phase) ====== " << std::endl;
+   else if (m_iter == m_burnin)
+      output << " ====== Burn-in complete, averaging samples ====== " << std::endl;
+
+   output << status_item->phase
+      << " "
+      << std::setfill(' ') << std::setw(3) << status_item->iter
+      << "/"
+      << std::setfill(' ') << std::setw(3) << status_item->phase_iter
+      << ": RMSE: "
+      << std::fixed << std::setprecision(4) << status_item->rmse_avg
+      << " (1samp per chain:";
+
+   for (auto& chain : m_chains)
+      output << " " << std::fixed << std::setprecision(4) << chain->getStatus()->rmse_1sample;
+
+   output << ")";
+
+   if (m_config.getRecordDiagnostics())
+      output << " ESS: "
+         << std::fixed << std::setprecision(1) << status_item->ess
+         << " Rhat: "
+         << std::fixed << std::setprecision(4) << status_item->rhat;
+
+   output << " [took: "
+      << std::fixed << std::setprecision(1) << status_item->elapsed_iter
+      << "s]"
+      << std::endl;
+}
+
+void MultiChainSession::saveCombinedPred() const
+{
+   auto pooled = getResult();
+   if (pooled->empty())
+      return;
+
+   std::string fname_pred = m_config.getSavePrefix() + "-combined-predictions.csv";
+   std::ofstream predfile(fname_pred);
+   THROWERROR_ASSERT_MSG(predfile.is_open(), "Error opening file: " + fname_pred);
+
+   for (std::size_t d = 0; d < pooled->front().coords.size(); d++)
+      predfile << "coord" << d << ",";
+
+   predfile << "y,pred_1samp,pred_avg,var,std" << std::endl;
+
+   for (const auto& t : *pooled)
+   {
+      t.coords.save(predfile)
+         << "," << std::to_string(t.val)
+         << "," << std::to_string(t.pred_1sample)
+         << "," << std::to_string(t.pred_avg)
+         << "," << std::to_string(t.var)
+         << "," << std::to_string(t.stds)
+         << std::endl;
+   }
+
+   m_rootFile->addCombinedPredFile(fname_pred);
+   m_rootFile->flushLast();
+}
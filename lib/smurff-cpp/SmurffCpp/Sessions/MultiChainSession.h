@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <SmurffCpp/Sessions/Session.h>
+#include <SmurffCpp/Priors/CachedPriorFactory.h>
+#include <SmurffCpp/Utils/Distribution.h>
+
+namespace smurff {
+
+class MultiChainSession;
+
+// one chain of a MultiChainSession,
+// shares the train data and the side info with the other chains
+class ChainSession : public Session
+{
+   friend class MultiChainSession;
+
+private:
+   std::shared_ptr<Data> m_shared_data; //train data of the first chain, empty for the first chain
+   std::shared_ptr<CachedPriorFactory::Cache> m_side_infos;
+
+protected:
+   ChainSession(std::shared_ptr<Data> shared_data, std::shared_ptr<CachedPriorFactory::Cache> side_infos)
+      : m_shared_data(shared_data), m_side_infos(side_infos)
+   {
+      name = "ChainSession";
+   }
+
+protected:
+   std::shared_ptr<Data> create_data() override;
+
+   //the generators of a chain are swapped in by the MultiChainSession
+   void initRng() override {}
+
+public:
+   std::shared_ptr<IPriorFactory> create_prior_factory() const override;
+};
+
+// samples several independent chains in one process,
+// every chain has its own model, priors, noise and random generators
+class MultiChainSession : public ISession
+{
+private:
+   Config m_config;
+   std::shared_ptr<RootFile> m_rootFile;
+
+   std::vector<std::shared_ptr<ChainSession> > m_chains;
+   std::vector<std::shared_ptr<bmrng_state> > m_rngs;
+
+   int m_iter = -1;
+   int m_burnin = 0; //iterations of burnin of all chains, fewer than configured with auto burnin
+   int m_nsamples = 0; //iterations of sampling of all chains, fewer than configured with a target ESS
+   double m_secs_per_iter = .0;
+
+public:
+   MultiChainSession(const Config& cfg);
+
+public:
+   void run() override;
+   bool step() override;
+   void init() override;
+
+   std::shared_ptr<StatusItem> getStatus() const override;
+
+   // predictions of all chains pooled into one posterior
+   std::shared_ptr<std::vector<ResultItem> > getResult() const override;
+
+   // sample of the first chain
+   MatrixConfig getSample(int mode) const override;
+
+   std::shared_ptr<RootFile> getRootFile() const override;
+
+   std::ostream &info(std::ostream &, std::string indent) override;
+
+public:
+   int getNumChains() const
+   {
+      return m_chains.size();
+   }
+
+   std::shared_ptr<ISession> getChain(int chain) const
+   {
+      return m_chains.at(chain);
+   }
+
+private:
+   //cross-chain diagnostics on the iterations [begin, end) of this phase
+   void diagnosticsWindow(int& begin, int& end) const;
+   std::vector<const Diagnostics*> getDiagnostics() const;
+
+   //ends burnin or sampling of all chains when configured
+   void updateDiagnostics();
+
+   void printStatus(std::ostream& output) const;
+
+   void saveCombinedPred() const;
+};
+
+}
@@ -0,0 +1,325 @@
+#include "PredictSession.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include <SmurffCpp/IO/INIFile.h>
+#include <SmurffCpp/IO/GenericIO.h>
+#include <SmurffCpp/IO/MatrixIO.h>
+#include <SmurffCpp/Configs/TensorConfig.h>
+#include <SmurffCpp/Priors/PriorFactory.h>
+#include <SmurffCpp/SideInfo/CompositeSideInfo.h>
+#include <SmurffCpp/Utils/Distribution.h>
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/linop.h>
+
+#define TRAIN_SECTION_TAG "train"
+
+using namespace smurff;
+
+//adds the predictions of sample <n> (counting from 1) to the running mean and sum of squared differences
+static void accumulate(const Eigen::MatrixXd& P, int n, Eigen::MatrixXd& mean, Eigen::MatrixXd& M2)
+{
+   if (n == 1)
+   {
+      mean = P;
+      M2 = Eigen::MatrixXd::Zero(P.rows(), P.cols());
+      return;
+   }
+
+   #pragma omp parallel for schedule(static)
+   for (int j = 0; j < P.cols(); j++)
+   {
+      for (int i = 0; i < P.rows(); i++)
+      {
+         double delta = P(i, j) - mean(i, j);
+         mean(i, j) += delta / n;
+         M2(i, j) += delta * (P(i, j) - mean(i, j));
+      }
+   }
+}
+
+PredictSession::PredictSession(std::string rootPath)
+{
+   m_rootFile = std::make_shared<RootFile>(rootPath);
+   m_stepFiles = m_rootFile->openSampleStepFiles();
+   THROWERROR_ASSERT_MSG(!m_stepFiles.empty(), "No saved samples in '" + rootPath + "'");
+
+   //only the side info options are needed, the train and side info matrices are not loaded
+   INIFile reader;
+   reader.open(m_rootFile->getOptionsFileName());
+
+   for (int mode = 0; mode < 2; mode++)
+   {
+      for (std::size_t item = 0;; item++)
+      {
+         auto options = std::make_shared<SideInfoConfig>();
+         if (!options->restoreOptions(reader, mode, item))
+            break;
+         m_sideInfoOptions[mode].push_back(options);
+      }
+   }
+
+   m_noiseConfig = TensorConfig::restore_noise_config(reader, TRAIN_SECTION_TAG);
+}
+
+std::size_t PredictSession::getNumSamples() const
+{
+   return m_stepFiles.size();
+}
+
+std::shared_ptr<ISideInfo> PredictSession::createSideInfo(int mode, const std::vector<std::shared_ptr<MatrixConfig> >& items) const
+{
+   THROWERROR_ASSERT_MSG(!items.empty(), "No side info given for mode " + std::to_string(mode));
+
+   auto it = m_sideInfoOptions.find(mode);
+   std::size_t nitems = it == m_sideInfoOptions.end() ? 0 : it->second.size();
+   //a single matrix can stand for the concatenation of all items, unless an item has to be hashed on its own
+   bool hashed = nitems > 0 && std::any_of(it->second.begin(), it->second.end(),
+      [](const std::shared_ptr<SideInfoConfig>& o) { return o->getHashBuckets() > 0; });
+   bool concatenated = nitems > 1 && items.size() == 1;
+   THROWERROR_ASSERT_MSG(items.size() == std::max<std::size_t>(nitems, 1) || (concatenated && !hashed),
+      "The model has " + std::to_string(nitems) + " side info items in mode " + std::to_string(mode) +
+      ", got " + std::to_string(items.size()) + " side info matrices");
+
+   //new side info is stored like the side info the model was trained with, item by item
+   PriorFactory factory;
+   std::vector<std::shared_ptr<ISideInfo> > blocks;
+   for (std::size_t i = 0; i < items.size(); i++)
+   {
+      auto options = std::make_shared<SideInfoConfig>();
+      if (i < nitems && !concatenated)
+         *options = *it->second.at(i);
+      options->setSideInfo(items.at(i));
+      blocks.push_back(factory.create_side_info(options, mode));
+   }
+
+   if (blocks.size() == 1)
+      return blocks.front();
+
+   return std::make_shared<CompositeSideInfo>(blocks);
+}
+
+std::shared_ptr<ISideInfo> PredictSession::createSideInfo(int mode, std::shared_ptr<MatrixConfig> features) const
+{
+   return createSideInfo(mode, std::vector<std::shared_ptr<MatrixConfig> >(1, features));
+}
+
+void PredictSession::priorMean(std::shared_ptr<StepFile> sf, int mode, std::shared_ptr<ISideInfo> features, int nnew, Eigen::MatrixXd& mean) const
+{
+   //mu is saved with the hyperparameters, older models only have the latent vectors
+   Eigen::VectorXd mu;
+   std::string muPath = sf->getMuFileName(mode);
+   if (generic_io::file_exists(muPath))
+   {
+      smurff::matrix_io::eigen::read_matrix(muPath, mu);
+   }
+   else
+   {
+      Eigen::MatrixXd Umode;
+      smurff::matrix_io::eigen::read_matrix(sf->getModelFileName(mode), Umode);
+      mu = Umode.rowwise().mean();
+   }
+
+   std::string betaPath = sf->getLinkMatrixFileName(mode);
+   if (!features)
+   {
+      THROWERROR_ASSERT_MSG(!generic_io::file_exists(betaPath),
+         "Mode " + std::to_string(mode) + " has a macau prior, side info of the new entities is required");
+
+      mean = mu.replicate(1, nnew);
+      return;
+   }
+
+   THROWERROR_FILE_NOT_EXIST(betaPath);
+
+   Eigen::MatrixXd beta;
+   smurff::matrix_io::eigen::read_matrix(betaPath, beta);
+   THROWERROR_ASSERT_MSG(beta.cols() == features->cols(),
+      "Side info has " + std::to_string(features->cols()) + " features, the link matrix has " + std::to_string(beta.cols()));
+
+   mean.resize(beta.rows(), features->rows());
+   features->compute_uhat(mean, beta);
+   mean.colwise() += mu;
+}
+
+void PredictSession::predict(int mode, std::shared_ptr<ISideInfo> features, Eigen::MatrixXd& mean, Eigen::MatrixXd& std) const
+{
+   THROWERROR_ASSERT_MSG(mode == 0 || mode == 1, "Cold-start prediction is only supported for matrix models");
+   THROWERROR_ASSERT_MSG(features, "Cold-start prediction needs the side info of the new entities");
+   const int other = 1 - mode;
+
+   Eigen::MatrixXd M2; //sum of squared differences from the running mean
+   int nsamples = 0;
+
+   for (const auto& sf : m_stepFiles)
+   {
+      THROWERROR_ASSERT_MSG(sf->getNPriors() == 2, "Cold-start prediction is only supported for matrix models");
+
+      Eigen::MatrixXd uhat;
+      priorMean(sf, mode, features, features->rows(), uhat);
+
+      Eigen::MatrixXd U;
+      smurff::matrix_io::eigen::read_matrix(sf->getModelFileName(other), U);
+
+      Eigen::MatrixXd P(uhat.cols(), U.cols());
+      smurff::linop::At_mul_B_blas(P, uhat, U);
+
+      accumulate(P, ++nsamples, mean, M2);
+   }
+
+   if (nsamples > 1)
+      std = (M2 / (nsamples - 1)).cwiseSqrt();
+   else
+      std = Eigen::MatrixXd::Constant(mean.rows(), mean.cols(), std::numeric_limits<double>::quiet_NaN());
+}
+
+void PredictSession::foldIn(int mode, const Eigen::SparseMatrix<double>& observations, std::shared_ptr<ISideInfo> features, int niters,
+                            Eigen::MatrixXd& mean, Eigen::MatrixXd& var) const
+{
+   THROWERROR_ASSERT_MSG(mode == 0 || mode == 1, "Fold-in is only supported for matrix models");
+   THROWERROR_ASSERT_MSG(m_noiseConfig.getNoiseType() == NoiseTypes::fixed || m_noiseConfig.getNoiseType() == NoiseTypes::adaptive,
+      "Fold-in is only supported for gaussian noise");
+   THROWERROR_ASSERT_MSG(!features || features->rows() == observations.rows(),
+      "Side info has " + std::to_string(features ? features->rows() : 0) + " rows, the observations have " + std::to_string(observations.rows()));
+   THROWERROR_ASSERT_MSG(niters > 0, "Fold-in needs at least one gibbs step");
+
+   const int other = 1 - mode;
+   const int nnew = observations.rows();
+   const bool adaptive = m_noiseConfig.getNoiseType() == NoiseTypes::adaptive;
+
+   //observations of every new entity
+   Eigen::SparseMatrix<double, Eigen::RowMajor> Y = observations;
+
+   //without a saved noise precision, adaptive noise starts from the variance of the new observations,
+   //like AdaptiveGaussianNoise does on the train data
+   double var_total = 1.0;
+   bool saved_noise = std::all_of(m_stepFiles.begin(), m_stepFiles.end(),
+      [](const std::shared_ptr<StepFile>& sf) { return !std::isnan(sf->getNoisePrecision()); });
+   if (adaptive && !saved_noise)
+   {
+      THROWERROR_ASSERT_MSG(Y.nonZeros() > 0, "No observations to fold in");
+
+      const double cwise_mean = Y.sum() / Y.nonZeros();
+      double se = .0;
+      for (int i = 0; i < Y.outerSize(); i++)
+         for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(Y, i); it; ++it)
+            se += std::pow(it.value() - cwise_mean, 2);
+
+      var_total = se / Y.nonZeros();
+      if (var_total <= 0.0 || std::isnan(var_total))
+         var_total = 1.0;
+   }
+
+   Eigen::MatrixXd M2; //sum of squared differences from the running mean
+   double noise_var = .0;
+   int nsamples = 0;
+
+   for (const auto& sf : m_stepFiles)
+   {
+      THROWERROR_ASSERT_MSG(sf->getNPriors() == 2, "Fold-in is only supported for matrix models");
+
+      Eigen::MatrixXd V;
+      smurff::matrix_io::eigen::read_matrix(sf->getModelFileName(other), V);
+      THROWERROR_ASSERT_MSG(V.cols() == Y.cols(),
+         "Observations have " + std::to_string(Y.cols()) + " columns, mode " + std::to_string(other) + " has " + std::to_string(V.cols()) + " entities");
+
+      //the spread of the saved U is not Lambda^-1 for macau priors and singular for few entities
+      std::string lambdaPath = sf->getLambdaFileName(mode);
+      THROWERROR_ASSERT_MSG(generic_io::file_exists(lambdaPath),
+         "Fold-in needs the hyperparameters of mode " + std::to_string(mode) + ", save the model with --save-hyper");
+
+      Eigen::MatrixXd Lambda;
+      smurff::matrix_io::eigen::read_matrix(lambdaPath, Lambda);
+      THROWERROR_ASSERT(Lambda.rows() == V.rows() && Lambda.cols() == V.rows());
+
+      Eigen::MatrixXd Umean;
+      priorMean(sf, mode, features, nnew, Umean);
+      const Eigen::MatrixXd Lmu = Lambda * Umean;
+
+      double alpha = adaptive ? (m_noiseConfig.getSnInit() + 1.0) / var_total : m_noiseConfig.getPrecision();
+      const double alpha_max = (m_noiseConfig.getSnMax() + 1.0) / var_total;
+      if (saved_noise)
+         alpha = sf->getNoisePrecision();
+
+      //with the noise of the sample known, the new latent vectors are independent, one draw is exact
+      const bool sample_noise = adaptive && !saved_noise;
+
+      Eigen::MatrixXd Unew(V.rows(), nnew);
+      for (int iter = 0; iter < (sample_noise ? niters : 1); iter++)
+      {
+         //same conditional as NormalPrior::sample_latent, only for the new entities
+         #pragma omp parallel for schedule(dynamic, 4)
+         for (int i = 0; i < nnew; i++)
+         {
+            Eigen::VectorXd rr = Lmu.col(i);
+            Eigen::MatrixXd MM = Lambda;
+
+            for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(Y, i); it; ++it)
+            {
+               rr.noalias() += (alpha * it.value()) * V.col(it.col());
+               MM.selfadjointView<Eigen::Lower>().rankUpdate(V.col(it.col()), alpha);
+            }
+
+            Eigen::LLT<Eigen::MatrixXd> chol = MM.llt();
+            if (chol.info() != Eigen::Success)
+            {
+               THROWERROR("Cholesky Decomposition failed!");
+            }
+
+            chol.matrixL().solveInPlace(rr);
+            rr.noalias() += nrandn(V.rows());
+            chol.matrixU().solveInPlace(rr);
+
+            Unew.col(i) = rr;
+         }
+
+         if (!sample_noise)
+            continue;
+
+         double sumsq = .0;
+         #pragma omp parallel for schedule(dynamic, 4) reduction(+:sumsq)
+         for (int i = 0; i < nnew; i++)
+            for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(Y, i); it; ++it)
+               sumsq += std::pow(it.value() - Unew.col(i).dot(V.col(it.col())), 2);
+
+         //same prior and upper bound as AdaptiveGaussianNoise::update
+         double aN = 0.5 + Y.nonZeros() / 2.0;
+         double bN = 0.5 * var_total + sumsq / 2.0;
+         alpha = std::min(rgamma(aN, 1.0 / bN), alpha_max);
+      }
+
+      Eigen::MatrixXd P(nnew, V.cols());
+      smurff::linop::At_mul_B_blas(P, Unew, V);
+
+      accumulate(P, ++nsamples, mean, M2);
+      noise_var += 1.0 / alpha;
+   }
+
+   //variance of the predictions over the samples plus the expected noise variance
+   var = (M2 / nsamples).array() + noise_var / nsamples;
+}
+
+void PredictSession::topK(const Eigen::MatrixXd& pred, int k, Eigen::MatrixXi& index, Eigen::MatrixXd& score)
+{
+   k = std::min<int>(k, pred.cols());
+   index.resize(pred.rows(), k);
+   score.resize(pred.rows(), k);
+
+   #pragma omp parallel for schedule(static)
+   for (int i = 0; i < pred.rows(); i++)
+   {
+      std::vector<int> order(pred.cols());
+      std::iota(order.begin(), order.end(), 0);
+      std::partial_sort(order.begin(), order.begin() + k, order.end(),
+         [&pred, i](int a, int b) { return pred(i, a) > pred(i, b); });
+
+      for (int j = 0; j < k; j++)
+      {
+         index(i, j) = order[j];
+         score(i, j) = pred(i, order[j]);
+      }
+   }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <SmurffCpp/Configs/MatrixConfig.h>
+#include <SmurffCpp/Configs/NoiseConfig.h>
+#include <SmurffCpp/Configs/SideInfoConfig.h>
+#include <SmurffCpp/SideInfo/ISideInfo.h>
+#include <SmurffCpp/Utils/RootFile.h>
+#include <SmurffCpp/Utils/StepFile.h>
+
+namespace smurff {
+
+//predictions for new entities of a saved model
+//cold-start: latent vectors of the new entities are computed from their side info and the saved link matrices
+//fold-in: latent vectors of the new entities are sampled from their observations against the frozen samples
+class PredictSession
+{
+private:
+   std::shared_ptr<RootFile> m_rootFile;
+   std::vector<std::shared_ptr<StepFile> > m_stepFiles;
+
+   //side info options of the trained model per mode, one per side info item
+   std::map<int, std::vector<std::shared_ptr<SideInfoConfig> > > m_sideInfoOptions;
+
+   //noise model of the train data
+   NoiseConfig m_noiseConfig;
+
+public:
+   //opens the root file of a saved session, only the sample step files are used
+   PredictSession(std::string rootPath);
+
+public:
+   std::size_t getNumSamples() const;
+
+   //side info of new entities in <mode>, stored the same way as the side info of the trained model
+   //<items> has one matrix per side info item of the mode, each is hashed/packed with the options of its item
+   std::shared_ptr<ISideInfo> createSideInfo(int mode, const std::vector<std::shared_ptr<MatrixConfig> >& items) const;
+
+   //side info of new entities in <mode> with a single side info item
+   std::shared_ptr<ISideInfo> createSideInfo(int mode, std::shared_ptr<MatrixConfig> features) const;
+
+   //mean and standard deviation over the samples of the predictions of all new entities (rows)
+   //against all entities of the other mode (columns)
+   void predict(int mode, std::shared_ptr<ISideInfo> features, Eigen::MatrixXd& mean, Eigen::MatrixXd& std) const;
+
+   //posterior predictive mean and variance of new entities in <mode> (rows of <observations>)
+   //against all entities of the other mode (columns), the saved samples are not changed
+   //for every sample the new latent vectors are drawn given the saved U of the other mode, mu/Lambda of <mode>
+   //and the noise precision, all saved with --save-hyper. <features> is required for macau priors,
+   //<niters> gibbs steps only sample adaptive noise of older models that have no saved noise precision
+   void foldIn(int mode, const Eigen::SparseMatrix<double>& observations, std::shared_ptr<ISideInfo> features, int niters,
+               Eigen::MatrixXd& mean, Eigen::MatrixXd& var) const;
+
+   //indices and scores of the <k> highest predictions in every row of <pred>, best first
+   static void topK(const Eigen::MatrixXd& pred, int k, Eigen::MatrixXi& index, Eigen::MatrixXd& score);
+
+private:
+   //prior mean of the new entities in <mode>, mu + beta * features for macau, mu otherwise
+   void priorMean(std::shared_ptr<StepFile> sf, int mode, std::shared_ptr<ISideInfo> features, int nnew, Eigen::MatrixXd& mean) const;
+};
+
+}
@@ -1,8 +1,11 @@
 #include "Session.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <string>
 #include <iomanip>
+#include <limits>
 
 #include <SmurffCpp/Version.h>
 
@@ -12,7 +15,11 @@
 #include <SmurffCpp/Utils/counters.h>
 #include <SmurffCpp/Utils/Error.h>
 
+#include <SmurffCpp/IO/MatrixIO.h>
+#include <SmurffCpp/IO/GenericIO.h>
+
 #include <SmurffCpp/DataMatrices/DataCreator.h>
+#include <SmurffCpp/DataMatrices/FoldMatrixData.h>
 #include <SmurffCpp/Priors/PriorFactory.h>
 
 #include <SmurffCpp/result.h>
@@ -86,7 +93,7 @@ void Session::setFromBase()
 
    // initialize data
 
-   data_ptr = m_config.getTrain()->create(std::make_shared<DataCreator>(this_session));
+   data_ptr = create_data();
 
    // initialize priors
 
@@ -99,6 +106,16 @@ void Session::init()
 {
    //init omp
    threads::init(m_config.getVerbose(), m_config.getNumThreads());
+   m_pipeline = m_config.getPipeline();
+   m_pipeline_threads = m_config.getPipelineThreads();
+   m_sgld = m_config.getSamplerType() == SamplerTypes::sgld;
+   m_sgld_step = m_config.getSgldStep();
+   m_sgld_batch_size = m_config.getSgldBatchSize();
+   m_save_hyper = m_config.getSaveHyper();
+
+   //iterations, shortened later if the diagnostics allow
+   m_burnin = m_config.getBurnin();
+   m_nsamples = m_config.getNSamples();
 
    //initialize random generator
    initRng();
@@ -128,6 +145,15 @@ void Session::init()
    //restore session (model, priors)
    bool resume = restore(m_iter);
 
+   //or start a new session from a previous run
+   if (!resume && m_config.getWarmStart().size())
+      warmStart();
+   else if (!resume && m_config.getModelInitType() == ModelInitTypes::als)
+      alsInit();
+
+   if (m_iter + 1 < m_config.getCoarseBurnin())
+      startCoarseBurnin();
+
    //print session status to console
    if (m_config.getVerbose())
    {
@@ -150,7 +176,7 @@ bool Session::step()
    // go to the next iteration
    m_iter++;
 
-   bool isStep = m_iter < m_config.getBurnin() + m_config.getNSamples();
+   bool isStep = m_iter < m_burnin + m_nsamples;
 
    if (isStep)
    {
@@ -164,7 +190,15 @@ bool Session::step()
       auto endi = tick();
 
       //WARNING: update is an expensive operation because of sort (when calculating AUC)
-      m_pred->update(m_model, m_iter < m_config.getBurnin());
+      m_pred->update(m_model, m_iter < m_burnin);
+
+      if (m_full_data && m_iter == m_config.getCoarseBurnin() - 1)
+         endCoarseBurnin();
+
+      updateDiagnostics();
+
+      if (m_iter == m_burnin - 1)
+         endBurnin();
 
       m_secs_per_iter = endi - starti;
 
@@ -174,6 +208,10 @@ bool Session::step()
 
       threads::disable();
    }
+   else
+   {
+      join_prior_updates();
+   }
 
    return isStep;
 }
@@ -187,6 +225,20 @@ std::ostream& Session::info(std::ostream &os, std::string indent)
    os << indent << "  Version: " << smurff::SMURFF_VERSION << "\n" ;
    os << indent << "  Iterations: " << m_config.getBurnin() << " burnin + " << m_config.getNSamples() << " samples\n";
 
+   if (m_sgld)
+      os << indent << "  Sampler: sgld, step " << m_sgld_step << ", minibatches of " << m_sgld_batch_size << " entries\n";
+   if (m_config.getCoarseBurnin())
+      os << indent << "  Coarse burnin: " << m_config.getCoarseBurnin() << " iterations on " << m_config.getCoarseFraction() << " of the train data\n";
+   if (m_config.getAutoBurnin())
+      os << indent << "  Auto burnin: until split-Rhat < " << m_config.getMaxRhat() << "\n";
+   if (m_config.getTargetEss() > 0)
+      os << indent << "  Target ESS: " << m_config.getTargetEss() << "\n";
+
+   if (m_config.getWarmStart().size())
+      os << indent << "  Warm start: " << m_config.getWarmStart() << "\n";
+   else if (m_config.getModelInitType() == ModelInitTypes::als)
+      os << indent << "  ALS init: " << m_config.getAlsSweeps() << " sweeps, regularization " << m_config.getAlsReg() << "\n";
+
    if (m_config.getSaveFreq() != 0 || m_config.getCheckpointFreq() != 0)
    {
       if (m_config.getSaveFreq() > 0)
@@ -223,7 +275,7 @@ void Session::save(int iteration)
        !m_config.getCsvStatus().size())
       return;
 
-   std::int32_t isample = iteration - m_config.getBurnin() + 1;
+   std::int32_t isample = iteration - m_burnin + 1;
 
    //save if checkpoint threshold overdue
    if (m_config.getCheckpointFreq() && (tick() - m_lastCheckpointTime) >= m_config.getCheckpointFreq())
@@ -260,7 +312,7 @@ void Session::save(int iteration)
           // don't save
       }
       //save_freq < 0: save last iter - do not save if (final model) mode is selected and not a final iteration
-      else if (m_config.getSaveFreq() < 0 && isample < m_config.getNSamples())
+      else if (m_config.getSaveFreq() < 0 && isample < m_nsamples)
       {
           // don't save
       }
@@ -335,6 +387,171 @@ bool Session::restore(int& iteration)
    }
 }
 
+void Session::warmStart()
+{
+   THROWERROR_FILE_NOT_EXIST(m_config.getWarmStart());
+
+   auto rootFile = std::make_shared<RootFile>(m_config.getWarmStart());
+   std::shared_ptr<StepFile> stepFile = rootFile->openLastStepFile();
+   THROWERROR_ASSERT_MSG(stepFile, "No saved model to warm start from in " + m_config.getWarmStart());
+
+   if (m_config.getVerbose())
+   {
+      std::cout << "-- Warm start from '" << stepFile->getStepFileName() << "'." << std::endl;
+   }
+
+   //entities of the previous run keep their latent vectors, appended entities come last
+   std::vector<int> num_old(model().nmodes());
+   for (std::uint64_t mode = 0; mode < model().nmodes(); mode++)
+   {
+      std::string path = stepFile->getModelFileName(mode);
+      THROWERROR_FILE_NOT_EXIST(path);
+
+      Eigen::MatrixXd U;
+      matrix_io::eigen::read_matrix(path, U);
+
+      THROWERROR_ASSERT_MSG(U.rows() == model().nlatent(),
+         "Warm start model has " + std::to_string(U.rows()) + " latent dimensions, expected " + std::to_string(model().nlatent()));
+      THROWERROR_ASSERT_MSG(U.cols() <= model().U(mode).cols(),
+         "Warm start model has more entities in mode " + std::to_string(mode) + " than the train data");
+
+      model().U(mode).leftCols(U.cols()) = U;
+      num_old[mode] = U.cols();
+   }
+
+   for (std::uint64_t mode = 0; mode < model().nmodes(); mode++)
+      m_priors[mode]->warm_start(stepFile, num_old[mode]);
+}
+
+void Session::alsInit()
+{
+   if (m_config.getVerbose())
+   {
+      std::cout << "-- ALS init: " << m_config.getAlsSweeps() << " sweeps." << std::endl;
+   }
+
+   for (int sweep = 0; sweep < m_config.getAlsSweeps(); sweep++)
+   {
+      for (auto &p : m_priors)
+         p->als_sweep(m_config.getAlsReg());
+   }
+
+   //hyperparameters and noise start from the als solution, like after a gibbs step
+   for (auto &p : m_priors)
+      update_prior(*p);
+
+   update_noise();
+}
+
+void Session::startCoarseBurnin()
+{
+   auto train = std::dynamic_pointer_cast<ScarceMatrixData>(data_ptr);
+   THROWERROR_ASSERT_MSG(train, "Coarse burnin needs a sparse train matrix with missing values (scarce)");
+
+   auto subsample = FoldMatrixData::subsample(*train, m_config.getCoarseFraction());
+   subsample->init();
+
+   m_full_data = data_ptr;
+   data_ptr = subsample;
+
+   if (m_config.getVerbose())
+   {
+      std::cout << "-- Coarse burnin: " << m_config.getCoarseBurnin() << " iterations on " << subsample->nnz()
+                << " of " << m_full_data->nnz() << " train entries." << std::endl;
+   }
+}
+
+void Session::endCoarseBurnin()
+{
+   data_ptr = m_full_data;
+   m_full_data.reset();
+
+   //noise of the full data from the current model
+   data().update(model());
+
+   if (m_config.getVerbose())
+      std::cout << "-- Coarse burnin complete, continuing on all train entries." << std::endl;
+}
+
+void Session::updateDiagnostics()
+{
+   if (!m_config.getRecordDiagnostics())
+      return;
+
+   //the norms of the modes trade scale with each other, only their product is identified
+   double log_norms = .0;
+   for (int i = 0; i < (int)model().nmodes(); ++i)
+      log_norms += std::log(model().U(i).norm());
+
+   std::vector<double> values;
+   values.push_back(log_norms);
+
+   //sgld steps are cheaper than a pass over the train data
+   if (!m_sgld)
+      values.push_back(trainRmse());
+
+   if (m_config.getTest())
+      values.push_back(m_pred->rmse_1sample);
+
+   m_diagnostics.add(m_iter, values);
+
+   int begin, end;
+   diagnosticsWindow(begin, end);
+
+   if (m_iter < m_burnin)
+   {
+      //burnin is over once the two halves of its second half agree
+      if (m_config.getAutoBurnin() && m_diagnostics.rhat(begin, end) < m_config.getMaxRhat())
+         m_burnin = m_iter + 1;
+   }
+   else if (m_config.getTargetEss() > 0 && m_diagnostics.ess(begin, end) >= m_config.getTargetEss())
+   {
+      stopSampling();
+   }
+}
+
+double Session::trainRmse() const
+{
+   if (m_train_rmse_iter != m_iter)
+   {
+      m_train_rmse = data().train_rmse(model());
+      m_train_rmse_iter = m_iter;
+   }
+
+   return m_train_rmse;
+}
+
+void Session::diagnosticsWindow(int& begin, int& end) const
+{
+   end = m_iter + 1;
+   begin = m_iter < m_burnin ? std::max(end / 2, m_config.getCoarseBurnin()) : m_burnin;
+}
+
+void Session::endBurnin()
+{
+   m_burnin = m_iter + 1;
+
+   if (m_config.getVerbose() && m_burnin < m_config.getBurnin())
+      std::cout << "-- Burnin converged after " << m_burnin << " iterations." << std::endl;
+
+   //shrink the model once, at the end of burnin
+   if (m_config.getPruneLatents())
+   {
+      int npruned = BaseSession::prune_latents();
+      m_train_rmse_iter = std::numeric_limits<int>::min();
+      if (m_config.getVerbose() && npruned > 0)
+         std::cout << "-- Pruned " << npruned << " latent dimentions, " << model().nlatent() << " left." << std::endl;
+   }
+}
+
+void Session::stopSampling()
+{
+   m_nsamples = m_iter - m_burnin + 1;
+
+   if (m_config.getVerbose())
+      std::cout << "-- Target ESS reached after " << m_nsamples << " samples." << std::endl;
+}
+
 std::shared_ptr<StatusItem> Session::getStatus() const
 {
     std::shared_ptr<StatusItem> ret = std::make_shared<StatusItem>();
@@ -345,17 +562,17 @@ std::shared_ptr<StatusItem> Session::getStatus() const
         ret->iter = m_iter + 1;
         ret->phase_iter = 0;
     }
-    else if (m_iter < m_config.getBurnin())
+    else if (m_iter < m_burnin)
     {
         ret->phase = "Burnin";
         ret->iter = m_iter + 1;
-        ret->phase_iter = m_config.getBurnin();
+        ret->phase_iter = m_burnin;
     }
     else
     {
         ret->phase = "Sample";
-        ret->iter = m_iter - m_config.getBurnin() + 1;
-        ret->phase_iter = m_config.getNSamples();
+        ret->iter = m_iter - m_burnin + 1;
+        ret->phase_iter = m_nsamples;
     }
 
     for (int i = 0; i < (int)model().nmodes(); ++i)
@@ -363,7 +580,7 @@ std::shared_ptr<StatusItem> Session::getStatus() const
         ret->model_norms.push_back(model().U(i).norm());
     }
 
-    ret->train_rmse = data().train_rmse(model());
+    ret->train_rmse = trainRmse();
 
     ret->rmse_avg = m_pred->rmse_avg;
     ret->rmse_1sample = m_pred->rmse_1sample;
@@ -371,6 +588,16 @@ std::shared_ptr<StatusItem> Session::getStatus() const
     ret->auc_avg = m_pred->auc_avg;
     ret->auc_1sample = m_pred->auc_1sample;
 
+    ret->ess = std::numeric_limits<double>::quiet_NaN();
+    ret->rhat = std::numeric_limits<double>::quiet_NaN();
+    if (m_config.getRecordDiagnostics())
+    {
+        int begin, end;
+        diagnosticsWindow(begin, end);
+        ret->ess = m_diagnostics.ess(begin, end);
+        ret->rhat = m_diagnostics.rhat(begin, end);
+    }
+
     ret->elapsed_iter = m_secs_per_iter;
     ret->nnz_per_sec = (double)(data().nnz()) / m_secs_per_iter;
     ret->samples_per_sec = (double)(model().nsamples()) / m_secs_per_iter;
@@ -394,11 +621,11 @@ void Session::printStatus(std::ostream& output, bool resume)
        {
            output << " ====== Initial phase ====== " << std::endl;
        }
-       else if (m_iter < m_config.getBurnin() && m_iter == 0)
+       else if (m_iter < m_burnin && m_iter == 0)
        {
            output << " ====== Sampling (burning phase) ====== " << std::endl;
        }
-       else if (m_iter == m_config.getBurnin())
+       else if (m_iter == m_burnin)
        {
            output << " ====== Burn-in complete, averaging samples ====== " << std::endl;
        }
@@ -438,8 +665,12 @@ void Session::printStatus(std::ostream& output, bool resume)
        if (m_config.getVerbose() > 1)
        {
            output << std::fixed << std::setprecision(4) << "  RMSE train: " << status_item->train_rmse << std::endl;
+           if (m_config.getRecordDiagnostics())
+               output << std::fixed << std::setprecision(1) << "  ESS: " << status_item->ess
+                   << std::setprecision(4) << " Rhat: " << status_item->rhat << std::endl;
            output << "  Priors:" << std::endl;
 
+           join_prior_updates();
            for(const auto &p : m_priors)
                p->status(output, "     ");
 
@@ -465,15 +696,15 @@ void Session::printStatus(std::ostream& output, bool resume)
 
 std::string StatusItem::getCsvHeader()
 {
-   return "phase;iter;phase_len;rmse_avg;rmse_1samp;train_rmse;auc_avg;auc_1samp;elapsed";
+   return "phase;iter;phase_len;rmse_avg;rmse_1samp;train_rmse;auc_avg;auc_1samp;ess;rhat;elapsed";
 }
 
 std::string StatusItem::asCsvString() const
 {
     char ret[1024];
-    snprintf(ret, 1024, "%s;%d;%d;%.4f;%.4f;%.4f;%.4f;:%.4f;%0.1f",
+    snprintf(ret, 1024, "%s;%d;%d;%.4f;%.4f;%.4f;%.4f;:%.4f;%.1f;%.4f;%0.1f",
                   phase.c_str(), iter, phase_iter, rmse_avg, rmse_1sample, train_rmse,
-                  auc_1sample, auc_avg, elapsed_iter);
+                  auc_1sample, auc_avg, ess, rhat, elapsed_iter);
 
     return ret;
 }
@@ -487,6 +718,11 @@ void Session::initRng()
       init_bmrng();
 }
 
+std::shared_ptr<Data> Session::create_data()
+{
+   return m_config.getTrain()->create(std::make_shared<DataCreator>(shared_from_this()));
+}
+
 std::shared_ptr<IPriorFactory> Session::create_prior_factory() const
 {
    return std::make_shared<PriorFactory>();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <limits>
 #include <memory>
 
 #include "BaseSession.h"
@@ -8,6 +9,7 @@
 #include <SmurffCpp/Configs/Config.h>
 #include <SmurffCpp/Priors/IPriorFactory.h>
 #include <SmurffCpp/Utils/RootFile.h>
+#include <SmurffCpp/Utils/Diagnostics.h>
 #include <SmurffCpp/StatusItem.h>
 
 namespace smurff {
@@ -27,7 +29,13 @@ protected:
 
 private:
    int m_iter = -1; //index of step iteration
+   int m_burnin = 0; //iterations of burnin, fewer than configured once the diagnostics end it
+   int m_nsamples = 0; //iterations of sampling, fewer than configured once the target ESS is reached
+   Diagnostics m_diagnostics; //model norms, train and test rmse of every iteration
+   std::shared_ptr<Data> m_full_data; //train data while the coarse burnin runs on a subsample of it
    int m_secs_per_iter = .0; //time in seconds for last_iter
+   mutable double m_train_rmse = .0; //train rmse of iteration m_train_rmse_iter
+   mutable int m_train_rmse_iter = std::numeric_limits<int>::min(); //none
    double m_lastCheckpointTime;
    int m_lastCheckpointIter;
 
@@ -40,7 +48,7 @@ protected:
 protected:
    void setRestoreFromRootPath(std::string rootPath);
    void setRestoreFromConfig(const Config& cfg, std::string rootPath);
-   void setCreateFromConfig(const Config& cfg);
+   virtual void setCreateFromConfig(const Config& cfg);
    void setFromBase();
 
    // execution of the sampler
@@ -56,23 +64,61 @@ public:
 public:
    std::ostream &info(std::ostream &, std::string indent) override;
 
-private:
+protected:
    //save current iteration
    void save(int iteration);
 
+private:
    void saveInternal(std::shared_ptr<StepFile> stepFile);
 
    //restore last iteration
    bool restore(int& iteration);
 
+   //start from the last sample of the warm start root file
+   void warmStart();
+
+   //refine the random initial model with alternating least squares sweeps
+   void alsInit();
+
+   //runs the first burnin iterations on a random subsample of the train data,
+   //then switches back to all of it
+   void startCoarseBurnin();
+   void endCoarseBurnin();
+
+   //appends this iteration to the diagnostics, ends burnin or sampling when configured
+   void updateDiagnostics();
+
+   //train rmse of this iteration, computed once for the diagnostics and the status
+   double trainRmse() const;
+
+   //iterations [begin, end) the diagnostics are computed on:
+   //the second half of the burnin so far, or all samples
+   void diagnosticsWindow(int& begin, int& end) const;
+
+protected:
+   //makes this iteration the last one of burnin
+   void endBurnin();
+
+   //makes this iteration the last one
+   void stopSampling();
+
+public:
+   const Diagnostics& getDiagnostics() const
+   {
+      return m_diagnostics;
+   }
+
 private:
    void printStatus(std::ostream& output, bool resume = false);
 
 public:
    std::shared_ptr<StatusItem> getStatus() const override;
 
-private:
-   void initRng();
+protected:
+   virtual void initRng();
+
+   // train data as described by the config
+   virtual std::shared_ptr<Data> create_data();
 
 public:
    virtual std::shared_ptr<IPriorFactory> create_prior_factory() const;
@@ -4,6 +4,8 @@
 #include <vector>
 
 #include <SmurffCpp/Sessions/PythonSession.h>
+#include <SmurffCpp/Sessions/MultiChainSession.h>
+#include <SmurffCpp/Sessions/CrossValidationSession.h>
 
 using namespace smurff;
 
@@ -27,7 +29,21 @@ std::shared_ptr<ISession> SessionFactory::create_py_session(const std::string& r
 //for testing only
 std::shared_ptr<ISession> SessionFactory::create_session(Config& cfg)
 {
+   if (cfg.getCVFolds())
+      return std::make_shared<CrossValidationSession>(cfg);
+
+   if (cfg.getNumChains() > 1)
+      return std::make_shared<MultiChainSession>(cfg);
+
    std::shared_ptr<Session> session(new Session());
    session->setCreateFromConfig(cfg);
    return session;
 }
+
+//for testing only, continues from the last step file of the root file
+std::shared_ptr<ISession> SessionFactory::create_session(Config& cfg, const std::string& rootPath)
+{
+   std::shared_ptr<Session> session(new Session());
+   session->setRestoreFromConfig(cfg, rootPath);
+   return session;
+}
@@ -16,6 +16,7 @@ namespace smurff {
 
       //for testing only
       static std::shared_ptr<ISession> create_session(Config& cfg);
+      static std::shared_ptr<ISession> create_session(Config& cfg, const std::string& rootPath);
    };
 
 }
@@ -0,0 +1,276 @@
+#include "SweepSession.h"
+
+#include <iomanip>
+
+#include <SmurffCpp/DataMatrices/Data.h>
+#include <SmurffCpp/Noises/NoiseFactory.h>
+#include <SmurffCpp/IO/INIFile.h>
+
+#include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/StringUtils.h>
+
+#include <SmurffCpp/StatusItem.h>
+
+#define SWEEP_SECTION_TAG "sweep"
+
+#define NUM_LATENT_KEY "num_latent"
+#define BURNIN_KEY "burnin"
+#define NSAMPLES_KEY "nsamples"
+#define PRIOR_KEY_PREFIX "prior_"
+#define NOISE_MODEL_KEY "noise_model"
+#define PRECISION_KEY "precision"
+#define SN_INIT_KEY "sn_init"
+#define SN_MAX_KEY "sn_max"
+#define BETA_PRECISION_KEY "beta_precision"
+
+using namespace smurff;
+
+namespace {
+
+// copy of a train config that does not share its noise config
+std::shared_ptr<TensorConfig> copy_tensor_config(std::shared_ptr<TensorConfig> tc)
+{
+   auto mc = std::dynamic_pointer_cast<MatrixConfig>(tc);
+   if (mc)
+      return std::make_shared<MatrixConfig>(*mc);
+   return std::make_shared<TensorConfig>(*tc);
+}
+
+}
+
+std::shared_ptr<Data> SweepPointSession::create_data()
+{
+   if (!m_shared_data)
+      return Session::create_data();
+
+   // the noise of this point may differ from the one of the first point
+   auto data = m_shared_data->clone();
+   data->setNoiseModel(NoiseFactory::create_noise_model(m_config.getTrain()->getNoiseConfig()));
+   return data;
+}
+
+std::shared_ptr<IPriorFactory> SweepPointSession::create_prior_factory() const
+{
+   return std::make_shared<CachedPriorFactory>(m_side_infos);
+}
+
+//-------
+
+SweepSession::SweepSession(const Config& cfg, const Axes& axes)
+   : m_config(cfg), m_axes(axes)
+{
+   THROWERROR_ASSERT_MSG(m_config.getNumChains() == 1 && !m_config.getCVFolds(), "Sweeps can not be combined with num_chains or cv_folds");
+
+   for (const auto& axis : m_axes)
+   {
+      THROWERROR_ASSERT_MSG(!axis.second.empty(), "No values for sweep option " + axis.first);
+
+      // fail before the first point runs
+      Config check = m_config;
+      for (const auto& value : axis.second)
+         apply(check, axis.first, value);
+   }
+}
+
+std::shared_ptr<SweepSession> SweepSession::create_from_ini(const std::string& iniFile)
+{
+   Config cfg;
+   THROWERROR_ASSERT_MSG(cfg.restore(iniFile), "Could not restore config from " + iniFile);
+
+   INIFile reader;
+   reader.open(iniFile);
+
+   Axes axes;
+   if (reader.hasSection(SWEEP_SECTION_TAG))
+   {
+      for (const auto& key : reader.getFields(SWEEP_SECTION_TAG)->second)
+      {
+         std::vector<std::string> tokens;
+         smurff::split(reader.get(SWEEP_SECTION_TAG, key), tokens, ',');
+
+         for (auto& token : tokens)
+            smurff::trim(token);
+
+         axes.push_back(std::make_pair(key, tokens));
+      }
+   }
+
+   return std::make_shared<SweepSession>(cfg, axes);
+}
+
+std::size_t SweepSession::getNumPoints() const
+{
+   std::size_t num_points = 1;
+   for (const auto& axis : m_axes)
+      num_points *= axis.second.size();
+   return num_points;
+}
+
+std::vector<std::string> SweepSession::getPointValues(std::size_t point) const
+{
+   THROWERROR_ASSERT(point < getNumPoints());
+
+   std::vector<std::string> values(m_axes.size());
+   for (int a = (int)m_axes.size() - 1; a >= 0; a--)
+   {
+      const auto& axis_values = m_axes[a].second;
+      values[a] = axis_values[point % axis_values.size()];
+      point /= axis_values.size();
+   }
+   return values;
+}
+
+Config SweepSession::getPointConfig(std::size_t point) const
+{
+   Config cfg = m_config;
+
+   auto values = getPointValues(point);
+   for (std::size_t a = 0; a < m_axes.size(); a++)
+      apply(cfg, m_axes[a].first, values[a]);
+
+   cfg.setVerbose(0);
+   cfg.setSavePrefix(m_config.getSavePrefix() + "-sweep" + std::to_string(point));
+   if (m_config.getCsvStatus().size())
+      cfg.setCsvStatus(addFileNameSuffix(m_config.getCsvStatus(), "-sweep" + std::to_string(point)));
+
+   return cfg;
+}
+
+void SweepSession::apply(Config& cfg, const std::string& key, const std::string& value)
+{
+   if (key == NUM_LATENT_KEY)
+   {
+      cfg.setNumLatent(_util::convert<int>(value));
+   }
+   else if (key == BURNIN_KEY)
+   {
+      cfg.setBurnin(_util::convert<int>(value));
+   }
+   else if (key == NSAMPLES_KEY)
+   {
+      cfg.setNSamples(_util::convert<int>(value));
+   }
+   else if (startsWith(key, PRIOR_KEY_PREFIX))
+   {
+      std::size_t mode = _util::convert<int>(key.substr(std::string(PRIOR_KEY_PREFIX).size()));
+      auto prior_types = cfg.getPriorTypes();
+      THROWERROR_ASSERT_MSG(mode < prior_types.size(), "No mode for sweep option " + key);
+      prior_types[mode] = stringToPriorType(value);
+      cfg.setPriorTypes(prior_types);
+   }
+   else if (key == NOISE_MODEL_KEY || key == PRECISION_KEY || key == SN_INIT_KEY || key == SN_MAX_KEY)
+   {
+      // train noise
+      auto train = copy_tensor_config(cfg.getTrain());
+      NoiseConfig noise = train->getNoiseConfig();
+
+      if (key == NOISE_MODEL_KEY)
+         noise.setNoiseType(value);
+      else if (key == PRECISION_KEY)
+         noise.setPrecision(_util::convert<double>(value));
+      else if (key == SN_INIT_KEY)
+         noise.setSnInit(_util::convert<double>(value));
+      else
+         noise.setSnMax(_util::convert<double>(value));
+
+      train->setNoiseConfig(noise);
+      cfg.setTrain(train);
+   }
+   else if (key == BETA_PRECISION_KEY)
+   {
+      // noise of every side info, the features themselves stay shared
+      for (const auto& mode_items : cfg.getSideInfoConfigs())
+      {
+         std::vector<std::shared_ptr<SideInfoConfig> > items;
+         for (const auto& item : mode_items.second)
+         {
+            auto side_info = std::make_shared<MatrixConfig>(*item->getSideInfo());
+            NoiseConfig noise = side_info->getNoiseConfig();
+            noise.setPrecision(_util::convert<double>(value));
+            side_info->setNoiseConfig(noise);
+
+            auto copy = std::make_shared<SideInfoConfig>(*item);
+            copy->setSideInfo(side_info);
+            items.push_back(copy);
+         }
+         cfg.setSideInfoConfigs(mode_items.first, items);
+      }
+   }
+   else
+   {
+      THROWERROR("Unknown sweep option: " + key);
+   }
+}
+
+void SweepSession::run(std::ostream& table)
+{
+   m_results.clear();
+
+   table << "point";
+   for (const auto& axis : m_axes)
+      table << "," << axis.first;
+   table << ",rmse_avg,rmse_1samp,auc_avg,elapsed" << std::endl;
+
+   // aux data is not shared, its noise belongs to the blocks of MatricesData
+   bool share_data = m_config.getAuxData().empty();
+
+   std::shared_ptr<Data> shared_data;
+   auto side_infos = std::make_shared<CachedPriorFactory::Cache>();
+
+   for (std::size_t p = 0; p < getNumPoints(); p++)
+   {
+      std::shared_ptr<SweepPointSession> session(new SweepPointSession(shared_data, side_infos));
+      session->setCreateFromConfig(getPointConfig(p));
+
+      double start = tick();
+      session->run();
+
+      auto status = session->getStatus();
+
+      Result result;
+      result.values = getPointValues(p);
+      result.rmse_avg = status->rmse_avg;
+      result.rmse_1sample = status->rmse_1sample;
+      result.auc_avg = status->auc_avg;
+      result.elapsed = tick() - start;
+      m_results.push_back(result);
+
+      if (share_data && !shared_data)
+         shared_data = session->data_ptr;
+
+      table << p;
+      for (const auto& value : result.values)
+         table << "," << value;
+      table << "," << std::to_string(result.rmse_avg)
+            << "," << std::to_string(result.rmse_1sample)
+            << "," << std::to_string(result.auc_avg)
+            << "," << std::to_string(result.elapsed)
+            << std::endl;
+
+      if (m_config.getVerbose())
+      {
+         std::cout << "Sweep point " << p + 1 << "/" << getNumPoints() << ":";
+         for (std::size_t a = 0; a < m_axes.size(); a++)
+            std::cout << " " << m_axes[a].first << "=" << result.values[a];
+         std::cout << " RMSE: " << std::fixed << std::setprecision(4) << result.rmse_avg
+                   << " [took: " << std::fixed << std::setprecision(1) << result.elapsed << "s]"
+                   << std::endl;
+      }
+   }
+}
+
+std::ostream& SweepSession::info(std::ostream &os, std::string indent) const
+{
+   os << indent << "SweepSession {\n";
+   os << indent << "  Points: " << getNumPoints() << " (sharing train data and side info)\n";
+   for (const auto& axis : m_axes)
+   {
+      os << indent << "  " << axis.first << ":";
+      for (const auto& value : axis.second)
+         os << " " << value;
+      os << "\n";
+   }
+   os << indent << "}\n";
+   return os;
+}
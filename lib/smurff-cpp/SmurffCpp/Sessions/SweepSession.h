@@ -0,0 +1,96 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <SmurffCpp/Sessions/Session.h>
+#include <SmurffCpp/Priors/CachedPriorFactory.h>
+
+namespace smurff {
+
+class SweepSession;
+
+// one point of a SweepSession,
+// shares the train data and the side info with the other points
+class SweepPointSession : public Session
+{
+   friend class SweepSession;
+
+private:
+   std::shared_ptr<Data> m_shared_data; //train data of the first point, empty if the data can not be shared
+   std::shared_ptr<CachedPriorFactory::Cache> m_side_infos;
+
+protected:
+   SweepPointSession(std::shared_ptr<Data> shared_data, std::shared_ptr<CachedPriorFactory::Cache> side_infos)
+      : m_shared_data(shared_data), m_side_infos(side_infos)
+   {
+      name = "SweepPointSession";
+   }
+
+protected:
+   std::shared_ptr<Data> create_data() override;
+
+public:
+   std::shared_ptr<IPriorFactory> create_prior_factory() const override;
+};
+
+// runs every combination of the values in the [sweep] section of an ini file,
+// e.g.
+//    [sweep]
+//    num_latent = 8,16,32
+//    beta_precision = 1,10
+// all other options come from the rest of the ini file.
+// Train data, test data and side info are loaded once and shared by all points.
+class SweepSession
+{
+public:
+   typedef std::vector<std::pair<std::string, std::vector<std::string> > > Axes;
+
+   struct Result
+   {
+      std::vector<std::string> values; //value of every axis
+      double rmse_avg;
+      double rmse_1sample;
+      double auc_avg;
+      double elapsed; //seconds
+   };
+
+private:
+   Config m_config;
+   Axes m_axes;
+   std::vector<Result> m_results;
+
+public:
+   SweepSession(const Config& cfg, const Axes& axes);
+
+   static std::shared_ptr<SweepSession> create_from_ini(const std::string& iniFile);
+
+public:
+   std::size_t getNumPoints() const;
+
+   // values of every axis at <point>, the last axis changes fastest
+   std::vector<std::string> getPointValues(std::size_t point) const;
+
+   // config of <point>, its data and side info share storage with the base config
+   Config getPointConfig(std::size_t point) const;
+
+   // runs the points back to back, each one with all threads,
+   // and writes a row of <table> after every point
+   void run(std::ostream& table);
+
+   const std::vector<Result>& getResults() const
+   {
+      return m_results;
+   }
+
+   std::ostream& info(std::ostream &os, std::string indent) const;
+
+public:
+   // sets one sweep option in <cfg>
+   static void apply(Config& cfg, const std::string& key, const std::string& value);
+};
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#ifdef _WINDOWS
+#include <intrin.h>
+#endif
+
+#include <SmurffCpp/Utils/Error.h>
+
+namespace smurff {
+
+inline int popcount64(std::uint64_t w)
+{
+#ifdef _WINDOWS
+   return (int)__popcnt64(w);
+#else
+   return __builtin_popcountll(w);
+#endif
+}
+
+// index of the lowest set bit, w must be non-zero
+inline int lowest_bit64(std::uint64_t w)
+{
+#ifdef _WINDOWS
+   unsigned long idx;
+   _BitScanForward64(&idx, w);
+   return (int)idx;
+#else
+   return __builtin_ctzll(w);
+#endif
+}
+
+// dense binary features (fingerprints) packed in 64-bit words
+// only the column bits are stored: each of the <ncol> features takes <col_words> words,
+// products over the rows are computed from them 64 rows (one word) at a time
+class BitPackedFeat
+{
+public:
+   int nrow;
+   int ncol;
+   int col_words;
+   std::vector<std::uint64_t> Mt;
+
+   BitPackedFeat() : nrow(0), ncol(0), col_words(0) {}
+
+   BitPackedFeat(int nrow, int ncol, long nnz, const int* rows, const int* cols)
+      : nrow(nrow), ncol(ncol)
+   {
+      col_words = (nrow + 63) / 64;
+      Mt.assign((std::size_t)ncol * col_words, 0);
+
+      for (long i = 0; i < nnz; i++)
+      {
+         THROWERROR_ASSERT(rows[i] >= 0 && rows[i] < nrow && cols[i] >= 0 && cols[i] < ncol);
+         Mt[(std::size_t)cols[i] * col_words + rows[i] / 64] |= (std::uint64_t)1 << (rows[i] % 64);
+      }
+   }
+
+   virtual ~BitPackedFeat() {}
+
+   const std::uint64_t* col(int c) const
+   {
+      return Mt.data() + (std::size_t)c * col_words;
+   }
+
+   int nfeat() const
+   {
+      return ncol;
+   }
+
+   int cols() const
+   {
+      return ncol;
+   }
+
+   int nsamples() const
+   {
+      return nrow;
+   }
+
+   int rows() const
+   {
+      return nrow;
+   }
+};
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ISideInfo.h"
+
+#include "BitPackedFeat.h"
+
+#include <memory>
+
+namespace smurff {
+
+class BitPackedFeatSideInfo : public ISideInfo
+{
+private:
+   std::shared_ptr<BitPackedFeat> m_side_info;
+
+public:
+   BitPackedFeatSideInfo(std::shared_ptr<BitPackedFeat> side_info);
+
+public:
+   int cols() const override;
+
+   int rows() const override;
+
+public:
+   std::ostream& print(std::ostream &os) const override;
+
+   bool is_dense() const override;
+
+public:
+   //linop
+
+   void compute_uhat(Eigen::MatrixXd& uhat, Eigen::MatrixXd& beta) override;
+
+   void At_mul_A(Eigen::MatrixXd& out) override;
+
+   void At_mul_A(Eigen::SparseMatrix<double>& out) override;
+
+   void color_cols(std::vector<std::vector<int> >& colors) override;
+
+   Eigen::MatrixXd A_mul_B(Eigen::MatrixXd& A) override;
+
+   void solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) override;
+
+   Eigen::VectorXd col_square_sum() override;
+
+   void At_mul_Bt(Eigen::VectorXd& Y, const int col, Eigen::MatrixXd& B) override;
+
+   void add_Acol_mul_bt(Eigen::MatrixXd& Z, const int col, Eigen::VectorXd& b) override;
+
+   //only for tests
+public:
+   std::shared_ptr<BitPackedFeat> get_features();
+};
+
+}
@@ -0,0 +1,240 @@
+#include "CompositeSideInfo.h"
+
+#include <algorithm>
+
+#include <SmurffCpp/Utils/linop.h>
+#include <SmurffCpp/Utils/Error.h>
+
+using namespace smurff;
+
+CompositeSideInfo::CompositeSideInfo(const std::vector<std::shared_ptr<ISideInfo> >& blocks)
+   : m_blocks(blocks)
+{
+   THROWERROR_ASSERT_MSG(!m_blocks.empty(), "composite side info needs at least one block");
+
+   m_offsets.push_back(0);
+   for (auto& b : m_blocks)
+   {
+      THROWERROR_ASSERT_MSG(b->rows() == m_blocks.front()->rows(), "all side info blocks must have the same number of rows");
+      m_offsets.push_back(m_offsets.back() + b->cols());
+   }
+}
+
+int CompositeSideInfo::cols() const
+{
+   return m_offsets.back();
+}
+
+int CompositeSideInfo::rows() const
+{
+   return m_blocks.front()->rows();
+}
+
+std::ostream& CompositeSideInfo::print(std::ostream &os) const
+{
+   os << "Composite [" << rows() << ", " << cols() << "] of " << m_blocks.size() << " blocks:" << std::endl;
+   for (auto& b : m_blocks)
+   {
+      os << "    ";
+      b->print(os);
+   }
+   return os;
+}
+
+bool CompositeSideInfo::is_dense() const
+{
+   // with a single dense block the dense F'F is needed anyway
+   return std::any_of(m_blocks.begin(), m_blocks.end(), [](const std::shared_ptr<ISideInfo>& b) { return b->is_dense(); });
+}
+
+void CompositeSideInfo::compute_uhat(Eigen::MatrixXd& uhat, Eigen::MatrixXd& beta)
+{
+   THROWERROR_ASSERT(beta.cols() == cols());
+
+   m_blocks[0]->compute_uhat(uhat, block_beta(0, beta));
+   m_block_uhat.resize(uhat.rows(), uhat.cols());
+   for (std::size_t i = 1; i < m_blocks.size(); i++)
+   {
+      m_blocks[i]->compute_uhat(m_block_uhat, block_beta(i, beta));
+      uhat += m_block_uhat;
+   }
+}
+
+void CompositeSideInfo::At_mul_A(Eigen::MatrixXd& out)
+{
+   THROWERROR_ASSERT(out.rows() == cols() && out.cols() == cols());
+
+   // only the lower triangle is filled, as for the other side info types
+   const int chunk = 64;
+   for (std::size_t j = 0; j < m_blocks.size(); j++)
+   {
+      const int nj = m_blocks[j]->cols();
+
+      Eigen::MatrixXd diag(nj, nj);
+      m_blocks[j]->At_mul_A(diag);
+      out.block(m_offsets[j], m_offsets[j], nj, nj).triangularView<Eigen::Lower>() = diag;
+
+      for (int c0 = 0; c0 < nj && j + 1 < m_blocks.size(); c0 += chunk)
+      {
+         const int nc = std::min(chunk, nj - c0);
+         out.block(m_offsets[j + 1], m_offsets[j] + c0, cols() - m_offsets[j + 1], nc) = cross_terms(j, c0, nc);
+      }
+   }
+}
+
+void CompositeSideInfo::At_mul_A(Eigen::SparseMatrix<double>& out)
+{
+   // only for all-sparse blocks (!is_dense()), the cross terms are computed a chunk
+   // of columns at a time as in the dense At_mul_A and only their non-zeros are kept
+   std::vector<Eigen::Triplet<double> > triplets;
+   const int chunk = 64;
+   for (std::size_t j = 0; j < m_blocks.size(); j++)
+   {
+      const int nj = m_blocks[j]->cols();
+
+      Eigen::SparseMatrix<double> diag;
+      m_blocks[j]->At_mul_A(diag);
+      for (int k = 0; k < diag.outerSize(); k++)
+      {
+         for (Eigen::SparseMatrix<double>::InnerIterator it(diag, k); it; ++it)
+         {
+            triplets.emplace_back(m_offsets[j] + it.row(), m_offsets[j] + it.col(), it.value());
+         }
+      }
+
+      for (int c0 = 0; c0 < nj && j + 1 < m_blocks.size(); c0 += chunk)
+      {
+         const int nc = std::min(chunk, nj - c0);
+         const Eigen::MatrixXd cross = cross_terms(j, c0, nc);
+         for (int c = 0; c < nc; c++)
+         {
+            for (int r = 0; r < cross.rows(); r++)
+            {
+               if (cross(r, c) != 0.0)
+               {
+                  triplets.emplace_back(m_offsets[j + 1] + r, m_offsets[j] + c0 + c, cross(r, c));
+               }
+            }
+         }
+      }
+   }
+
+   out.resize(cols(), cols());
+   out.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+void CompositeSideInfo::color_cols(std::vector<std::vector<int> >& colors)
+{
+   // the blocks are colored separately and never share a color, columns of
+   // different blocks are not checked for common rows
+   colors.clear();
+   for (std::size_t i = 0; i < m_blocks.size(); i++)
+   {
+      std::vector<std::vector<int> > block_colors;
+      m_blocks[i]->color_cols(block_colors);
+      for (auto& c : block_colors)
+      {
+         for (int& col : c)
+         {
+            col += m_offsets[i];
+         }
+         colors.push_back(std::move(c));
+      }
+   }
+}
+
+Eigen::MatrixXd CompositeSideInfo::A_mul_B(Eigen::MatrixXd& A)
+{
+   Eigen::MatrixXd out(A.rows(), cols());
+   for (std::size_t i = 0; i < m_blocks.size(); i++)
+   {
+      out.middleCols(m_offsets[i], m_blocks[i]->cols()) = m_blocks[i]->A_mul_B(A);
+   }
+   return out;
+}
+
+void CompositeSideInfo::solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error)
+{
+   smurff::linop::solve_blockcg(X, *this, reg, B, tol, blocksize, excess, throw_on_cholesky_error);
+}
+
+void CompositeSideInfo::AtA_mul_B(Eigen::MatrixXd& out, double reg, Eigen::MatrixXd& B, Eigen::MatrixXd& tmp)
+{
+   // tmp = B * F', out = tmp * F + reg * B
+   compute_uhat(tmp, B);
+   out = A_mul_B(tmp);
+   out += reg * B;
+}
+
+// composite matvec for solve_blockcg, dispatches to the blocks
+void smurff::linop::AtA_mul_B_switch(Eigen::MatrixXd & out, CompositeSideInfo & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp)
+{
+   A.AtA_mul_B(out, reg, B, tmp);
+}
+
+Eigen::VectorXd CompositeSideInfo::col_square_sum()
+{
+   Eigen::VectorXd out(cols());
+   for (std::size_t i = 0; i < m_blocks.size(); i++)
+   {
+      out.segment(m_offsets[i], m_blocks[i]->cols()) = m_blocks[i]->col_square_sum();
+   }
+   return out;
+}
+
+void CompositeSideInfo::At_mul_Bt(Eigen::VectorXd& Y, const int col, Eigen::MatrixXd& B)
+{
+   const std::size_t i = find_block(col);
+   m_blocks[i]->At_mul_Bt(Y, col - m_offsets[i], B);
+}
+
+void CompositeSideInfo::add_Acol_mul_bt(Eigen::MatrixXd& Z, const int col, Eigen::VectorXd& b)
+{
+   const std::size_t i = find_block(col);
+   m_blocks[i]->add_Acol_mul_bt(Z, col - m_offsets[i], b);
+}
+
+std::size_t CompositeSideInfo::nblocks() const
+{
+   return m_blocks.size();
+}
+
+std::shared_ptr<ISideInfo> CompositeSideInfo::block(std::size_t i) const
+{
+   return m_blocks.at(i);
+}
+
+int CompositeSideInfo::block_offset(std::size_t i) const
+{
+   return m_offsets.at(i);
+}
+
+std::size_t CompositeSideInfo::find_block(int col) const
+{
+   THROWERROR_ASSERT(col >= 0 && col < cols());
+   return std::upper_bound(m_offsets.begin(), m_offsets.end(), col) - m_offsets.begin() - 1;
+}
+
+Eigen::MatrixXd CompositeSideInfo::cross_terms(std::size_t j, int c0, int nc)
+{
+   Eigen::MatrixXd Fj_cols = Eigen::MatrixXd::Zero(nc, rows()); // F_j[:, c0:c0+nc]'
+   for (int c = 0; c < nc; c++)
+   {
+      Eigen::VectorXd e = Eigen::VectorXd::Unit(nc, c);
+      m_blocks[j]->add_Acol_mul_bt(Fj_cols, c0 + c, e);
+   }
+
+   Eigen::MatrixXd out(cols() - m_offsets[j + 1], nc);
+   for (std::size_t i = j + 1; i < m_blocks.size(); i++)
+   {
+      out.middleRows(m_offsets[i] - m_offsets[j + 1], m_blocks[i]->cols()) = m_blocks[i]->A_mul_B(Fj_cols).transpose();
+   }
+   return out;
+}
+
+Eigen::MatrixXd& CompositeSideInfo::block_beta(std::size_t i, const Eigen::MatrixXd& beta)
+{
+   m_block_beta.resize(m_blocks.size());
+   m_block_beta[i] = beta.middleCols(m_offsets[i], m_blocks[i]->cols());
+   return m_block_beta[i];
+}
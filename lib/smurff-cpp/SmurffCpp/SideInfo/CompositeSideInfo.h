@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ISideInfo.h"
+
+#include <memory>
+#include <vector>
+
+namespace smurff {
+
+// several side info blocks presented as one horizontal concatenation [F_1 F_2 ... F_n]
+// every operation dispatches to the blocks and works on their slice of the columns
+class CompositeSideInfo : public ISideInfo
+{
+private:
+   std::vector<std::shared_ptr<ISideInfo> > m_blocks;
+   std::vector<int> m_offsets; // first column of each block, m_offsets.back() == cols()
+
+   // the block linops take whole matrices, so the beta slices and partial uhats
+   // go through these buffers, which are sized once and reused between calls
+   std::vector<Eigen::MatrixXd> m_block_beta;
+   Eigen::MatrixXd m_block_uhat;
+
+public:
+   CompositeSideInfo(const std::vector<std::shared_ptr<ISideInfo> >& blocks);
+
+public:
+   int cols() const override;
+
+   int rows() const override;
+
+public:
+   std::ostream& print(std::ostream &os) const override;
+
+   bool is_dense() const override;
+
+public:
+   //linop
+
+   void compute_uhat(Eigen::MatrixXd& uhat, Eigen::MatrixXd& beta) override;
+
+   void At_mul_A(Eigen::MatrixXd& out) override;
+
+   void At_mul_A(Eigen::SparseMatrix<double>& out) override;
+
+   void color_cols(std::vector<std::vector<int> >& colors) override;
+
+   Eigen::MatrixXd A_mul_B(Eigen::MatrixXd& A) override;
+
+   void solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) override;
+
+   Eigen::VectorXd col_square_sum() override;
+
+   void At_mul_Bt(Eigen::VectorXd& Y, const int col, Eigen::MatrixXd& B) override;
+
+   void add_Acol_mul_bt(Eigen::MatrixXd& Z, const int col, Eigen::VectorXd& b) override;
+
+   // out = B * A'A + reg * B, the CG matvec
+   void AtA_mul_B(Eigen::MatrixXd& out, double reg, Eigen::MatrixXd& B, Eigen::MatrixXd& tmp);
+
+public:
+   std::size_t nblocks() const;
+
+   std::shared_ptr<ISideInfo> block(std::size_t i) const;
+
+   int block_offset(std::size_t i) const;
+
+private:
+   // block containing column col
+   std::size_t find_block(int col) const;
+
+   // F_i' F_j[:, c0:c0+nc] of all blocks i > j, stacked over i
+   Eigen::MatrixXd cross_terms(std::size_t j, int c0, int nc);
+
+   // beta[:, block i] in m_block_beta[i]
+   Eigen::MatrixXd& block_beta(std::size_t i, const Eigen::MatrixXd& beta);
+};
+
+}
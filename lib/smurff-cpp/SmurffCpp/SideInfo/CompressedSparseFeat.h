@@ -0,0 +1,49 @@
+#pragma once
+
+#include "LibFastSparseDependency.h"
+
+namespace smurff {
+
+// binary sparse features stored as 64-bit, delta-encoded CSR (see CompressedBinaryCSR)
+class CompressedSparseFeat
+{
+public:
+   CompressedBinaryCSR M;
+   CompressedBinaryCSR Mt;
+
+   CompressedSparseFeat() {}
+
+   CompressedSparseFeat(std::int64_t nrow, std::int64_t ncol, std::int64_t nnz, const std::uint32_t* rows, const std::uint32_t* cols)
+   {
+      new_cbcsr(&M, nnz, nrow, ncol, rows, cols);
+      new_cbcsr(&Mt, nnz, ncol, nrow, cols, rows);
+   }
+
+   virtual ~CompressedSparseFeat()
+   {
+      free_cbcsr(&M);
+      free_cbcsr(&Mt);
+   }
+
+   int nfeat() const
+   {
+      return M.ncol;
+   }
+
+   int cols() const
+   {
+      return M.ncol;
+   }
+
+   int nsamples() const
+   {
+      return M.nrow;
+   }
+
+   int rows() const
+   {
+      return M.nrow;
+   }
+};
+
+}
@@ -0,0 +1,81 @@
+#include "CompressedSparseFeatSideInfo.h"
+
+#include <SmurffCpp/Utils/linop.h>
+
+using namespace smurff;
+
+CompressedSparseFeatSideInfo::CompressedSparseFeatSideInfo(std::shared_ptr<CompressedSparseFeat> side_info)
+   : m_side_info(side_info)
+{
+}
+
+int CompressedSparseFeatSideInfo::cols() const
+{
+   return m_side_info->cols();
+}
+
+int CompressedSparseFeatSideInfo::rows() const
+{
+   return m_side_info->rows();
+}
+
+std::ostream& CompressedSparseFeatSideInfo::print(std::ostream &os) const
+{
+   os << "CompressedSparseBinary [" << m_side_info->rows() << ", " << m_side_info->cols() << "]" << std::endl;
+   return os;
+}
+
+bool CompressedSparseFeatSideInfo::is_dense() const
+{
+   return false;
+}
+
+void CompressedSparseFeatSideInfo::compute_uhat(Eigen::MatrixXd& uhat, Eigen::MatrixXd& beta)
+{
+   smurff::linop::compute_uhat(uhat, *m_side_info, beta);
+}
+
+void CompressedSparseFeatSideInfo::At_mul_A(Eigen::MatrixXd& out)
+{
+   smurff::linop::At_mul_A(out, *m_side_info);
+}
+
+void CompressedSparseFeatSideInfo::At_mul_A(Eigen::SparseMatrix<double>& out)
+{
+   smurff::linop::At_mul_A(out, *m_side_info);
+}
+
+void CompressedSparseFeatSideInfo::color_cols(std::vector<std::vector<int> >& colors)
+{
+   smurff::linop::color_cols(colors, *m_side_info);
+}
+
+Eigen::MatrixXd CompressedSparseFeatSideInfo::A_mul_B(Eigen::MatrixXd& A)
+{
+   return smurff::linop::A_mul_B(A, *m_side_info);
+}
+
+void CompressedSparseFeatSideInfo::solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error)
+{
+   smurff::linop::solve_blockcg(X, *m_side_info, reg, B, tol, blocksize, excess, throw_on_cholesky_error);
+}
+
+Eigen::VectorXd CompressedSparseFeatSideInfo::col_square_sum()
+{
+   return smurff::linop::col_square_sum(*m_side_info);
+}
+
+void CompressedSparseFeatSideInfo::At_mul_Bt(Eigen::VectorXd& Y, const int col, Eigen::MatrixXd& B)
+{
+   smurff::linop::At_mul_Bt(Y, *m_side_info, col, B);
+}
+
+void CompressedSparseFeatSideInfo::add_Acol_mul_bt(Eigen::MatrixXd& Z, const int col, Eigen::VectorXd& b)
+{
+   smurff::linop::add_Acol_mul_bt(Z, *m_side_info, col, b);
+}
+
+std::shared_ptr<CompressedSparseFeat> CompressedSparseFeatSideInfo::get_features()
+{
+   return m_side_info;
+}
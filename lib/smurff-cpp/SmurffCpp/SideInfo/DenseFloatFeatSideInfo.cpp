@@ -0,0 +1,71 @@
+#include "DenseFloatFeatSideInfo.h"
+
+#include <SmurffCpp/Utils/linop.h>
+
+using namespace smurff;
+
+DenseFloatFeatSideInfo::DenseFloatFeatSideInfo(std::shared_ptr<Eigen::MatrixXf> side_info)
+   : m_side_info(side_info)
+{
+}
+
+int DenseFloatFeatSideInfo::cols() const
+{
+   return m_side_info->cols();
+}
+
+int DenseFloatFeatSideInfo::rows() const
+{
+   return m_side_info->rows();
+}
+
+std::ostream& DenseFloatFeatSideInfo::print(std::ostream &os) const
+{
+   os << "DenseFloat [" << m_side_info->rows() << ", " << m_side_info->cols() << "]" << std::endl;
+   return os;
+}
+
+bool DenseFloatFeatSideInfo::is_dense() const
+{
+   return true;
+}
+
+void DenseFloatFeatSideInfo::compute_uhat(Eigen::MatrixXd& uhat, Eigen::MatrixXd& beta)
+{
+   smurff::linop::compute_uhat(uhat, *m_side_info, beta);
+}
+
+void DenseFloatFeatSideInfo::At_mul_A(Eigen::MatrixXd& out)
+{
+   smurff::linop::At_mul_A(out, *m_side_info);
+}
+
+Eigen::MatrixXd DenseFloatFeatSideInfo::A_mul_B(Eigen::MatrixXd& A)
+{
+   return smurff::linop::A_mul_B(A, *m_side_info);
+}
+
+void DenseFloatFeatSideInfo::solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error)
+{
+   smurff::linop::solve_blockcg(X, *m_side_info, reg, B, tol, blocksize, excess, throw_on_cholesky_error);
+}
+
+Eigen::VectorXd DenseFloatFeatSideInfo::col_square_sum()
+{
+   return smurff::linop::col_square_sum(*m_side_info);
+}
+
+void DenseFloatFeatSideInfo::At_mul_Bt(Eigen::VectorXd& Y, const int col, Eigen::MatrixXd& B)
+{
+   smurff::linop::At_mul_Bt(Y, *m_side_info, col, B);
+}
+
+void DenseFloatFeatSideInfo::add_Acol_mul_bt(Eigen::MatrixXd& Z, const int col, Eigen::VectorXd& b)
+{
+   smurff::linop::add_Acol_mul_bt(Z, *m_side_info, col, b);
+}
+
+std::shared_ptr<Eigen::MatrixXf> DenseFloatFeatSideInfo::get_features()
+{
+   return m_side_info;
+}
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <iostream>
+#include <vector>
 
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <SmurffCpp/Utils/Error.h>
 
 namespace smurff {
 
@@ -26,6 +30,18 @@ namespace smurff {
 
       virtual void At_mul_A(Eigen::MatrixXd& out) = 0;
 
+      // lower triangle of A'A, only for sparse side info (!is_dense())
+      virtual void At_mul_A(Eigen::SparseMatrix<double>& out)
+      {
+         THROWERROR_NOTIMPL_MSG("sparse At_mul_A");
+      }
+
+      // groups of columns without a common row, only for sparse side info (!is_dense())
+      virtual void color_cols(std::vector<std::vector<int> >& colors)
+      {
+         THROWERROR_NOTIMPL_MSG("color_cols");
+      }
+
       virtual Eigen::MatrixXd A_mul_B(Eigen::MatrixXd& A) = 0;
 
       virtual void solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) = 0;
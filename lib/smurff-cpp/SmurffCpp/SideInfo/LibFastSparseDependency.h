@@ -8,6 +8,8 @@
 
 #include <memory>
 #include <string.h>
+#include <cstdint>
+#include <algorithm>
 
 #include <SmurffCpp/Utils/Error.h>
 
@@ -247,6 +249,142 @@ inline void csr_A_mul_Bn(double* Y, struct CSR *A, double* X, const int ncol)
    }
  }
 
+/*** compressed binary CSR ***/
+/* 64-bit row pointers into a stream of 16-bit column deltas. Columns within a row
+ * are sorted and each one is stored as the difference to the previous column
+ * (the first one relative to 0). Deltas that do not fit in 16 bits are written as
+ * CBCSR_ESCAPE followed by the absolute 32-bit column (low word, high word). */
+#define CBCSR_ESCAPE 0xFFFF
+
+struct CompressedBinaryCSR
+{
+  std::int64_t nrow;
+  std::int64_t ncol;
+  std::int64_t nnz;
+  std::int64_t nwords;
+  std::int64_t* row_ptr; /* points to the row starts in deltas */
+  std::uint16_t* deltas;
+};
+
+/** decodes the column at position i, moving i to the next encoded column */
+inline std::int64_t cbcsr_next_col(const std::uint16_t* RESTRICT deltas, std::int64_t& i, std::int64_t prev)
+{
+   const std::uint16_t d = deltas[i++];
+   if (d != CBCSR_ESCAPE)
+      return prev + d;
+
+   const std::int64_t col = (std::int64_t)deltas[i] | ((std::int64_t)deltas[i + 1] << 16);
+   i += 2;
+   return col;
+}
+
+inline void free_cbcsr(struct CompressedBinaryCSR* cbcsr)
+{
+   THROWERROR_ASSERT(cbcsr != 0);
+
+   free(cbcsr->row_ptr);
+   free(cbcsr->deltas);
+}
+
+ static inline void new_cbcsr(struct CompressedBinaryCSR* RESTRICT A, std::int64_t nnz, std::int64_t nrow, std::int64_t ncol, const std::uint32_t* rows, const std::uint32_t* cols)
+ {
+   THROWERROR_ASSERT(A != 0);
+   THROWERROR_ASSERT_MSG(ncol <= (std::int64_t)UINT32_MAX, "compressed CSR supports at most 2^32 columns");
+
+   A->nnz  = nnz;
+   A->nrow = nrow;
+   A->ncol = ncol;
+   A->row_ptr = (std::int64_t*)malloc( (nrow + 1) * sizeof(std::int64_t));
+
+   // bucket columns per row (same counting sort as new_bcsr, but 64-bit)
+   std::int64_t* start = (std::int64_t*)calloc(nrow + 1, sizeof(std::int64_t));
+   std::uint32_t* sorted = (std::uint32_t*)malloc(nnz * sizeof(std::uint32_t));
+   for (std::int64_t i = 0; i < nnz; i++) {
+     start[rows[i] + 1]++;
+   }
+   for (std::int64_t row = 0; row < nrow; row++) {
+     start[row + 1] += start[row];
+   }
+   std::int64_t* fill = (std::int64_t*)malloc(nrow * sizeof(std::int64_t));
+   memcpy(fill, start, nrow * sizeof(std::int64_t));
+   for (std::int64_t i = 0; i < nnz; i++) {
+     sorted[fill[rows[i]]++] = cols[i];
+   }
+   free(fill);
+
+   // sort each row and count the number of 16-bit words it needs
+   #pragma omp parallel for schedule(dynamic, 256)
+   for (std::int64_t row = 0; row < nrow; row++) {
+     std::sort(sorted + start[row], sorted + start[row + 1]);
+     std::int64_t words = 0;
+     std::int64_t prev = 0;
+     for (std::int64_t i = start[row]; i < start[row + 1]; i++) {
+       words += ((std::int64_t)sorted[i] - prev < CBCSR_ESCAPE) ? 1 : 3;
+       prev = sorted[i];
+     }
+     A->row_ptr[row + 1] = words;
+   }
+   A->row_ptr[0] = 0;
+   for (std::int64_t row = 0; row < nrow; row++) {
+     A->row_ptr[row + 1] += A->row_ptr[row];
+   }
+   A->nwords = A->row_ptr[nrow];
+   A->deltas = (std::uint16_t*)malloc(A->nwords * sizeof(std::uint16_t));
+
+   // encode
+   #pragma omp parallel for schedule(dynamic, 256)
+   for (std::int64_t row = 0; row < nrow; row++) {
+     std::int64_t w = A->row_ptr[row];
+     std::int64_t prev = 0;
+     for (std::int64_t i = start[row]; i < start[row + 1]; i++) {
+       const std::int64_t delta = (std::int64_t)sorted[i] - prev;
+       if (delta < CBCSR_ESCAPE) {
+         A->deltas[w++] = (std::uint16_t)delta;
+       } else {
+         A->deltas[w++] = CBCSR_ESCAPE;
+         A->deltas[w++] = (std::uint16_t)(sorted[i] & 0xFFFF);
+         A->deltas[w++] = (std::uint16_t)(sorted[i] >> 16);
+       }
+       prev = sorted[i];
+     }
+   }
+
+   free(sorted);
+   free(start);
+ }
+
+/** Y = A * X, where Y and X have <ncol> columns and are row-ordered */
+inline void cbcsr_A_mul_Bn(double* Y, struct CompressedBinaryCSR *A, double* X, const int ncol)
+{
+   const std::int64_t* row_ptr = A->row_ptr;
+   const std::uint16_t* deltas = A->deltas;
+   #pragma omp parallel
+   {
+     double* tmp = (double*)malloc(ncol * sizeof(double));
+     #pragma omp for schedule(dynamic, 256)
+     for (std::int64_t row = 0; row < A->nrow; row++)
+     {
+       memset(tmp, 0, ncol * sizeof(double));
+       std::int64_t c = 0;
+       for (std::int64_t i = row_ptr[row], end = row_ptr[row + 1]; i < end; )
+       {
+         c = cbcsr_next_col(deltas, i, c);
+         const double* x = X + c * ncol;
+         for (int j = 0; j < ncol; j++)
+         {
+            tmp[j] += x[j];
+         }
+       }
+       double* y = Y + row * ncol;
+       for (int j = 0; j < ncol; j++)
+       {
+         y[j] = tmp[j];
+       }
+     }
+     free(tmp);
+   }
+}
+
 struct SparseBinaryMatrix
 {
   int nrow;
@@ -40,6 +40,16 @@ void SparseFeatSideInfo::At_mul_A(Eigen::MatrixXd& out)
    smurff::linop::At_mul_A(out, *m_side_info);
 }
 
+void SparseFeatSideInfo::At_mul_A(Eigen::SparseMatrix<double>& out)
+{
+   smurff::linop::At_mul_A(out, *m_side_info);
+}
+
+void SparseFeatSideInfo::color_cols(std::vector<std::vector<int> >& colors)
+{
+   smurff::linop::color_cols(colors, *m_side_info);
+}
+
 Eigen::MatrixXd SparseFeatSideInfo::A_mul_B(Eigen::MatrixXd& A)
 {
    return smurff::linop::A_mul_B(A, *m_side_info);
@@ -33,6 +33,10 @@ public:
 
    void At_mul_A(Eigen::MatrixXd& out) override;
 
+   void At_mul_A(Eigen::SparseMatrix<double>& out) override;
+
+   void color_cols(std::vector<std::vector<int> >& colors) override;
+
    Eigen::MatrixXd A_mul_B(Eigen::MatrixXd& A) override;
 
    void solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) override;
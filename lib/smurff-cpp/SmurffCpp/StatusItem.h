@@ -19,6 +19,10 @@ struct StatusItem
     double auc_1sample;
     double auc_avg;
 
+    // convergence diagnostics: on the second half of the burnin so far, or on all samples
+    double ess;
+    double rhat;
+
     double elapsed_iter;
     double nnz_per_sec;
     double samples_per_sec;
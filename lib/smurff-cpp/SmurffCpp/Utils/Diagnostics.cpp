@@ -0,0 +1,182 @@
+#include "Diagnostics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <SmurffCpp/Utils/Error.h>
+
+using namespace smurff;
+
+void Diagnostics::add(int iter, const std::vector<double>& values)
+{
+   if (m_first_iter < 0)
+   {
+      m_first_iter = iter;
+      m_traces.resize(values.size());
+   }
+
+   THROWERROR_ASSERT(values.size() == m_traces.size());
+   THROWERROR_ASSERT(iter == m_first_iter + (int)m_traces.front().size());
+
+   for (std::size_t i = 0; i < values.size(); i++)
+      m_traces[i].push_back(values[i]);
+}
+
+bool Diagnostics::window(int& begin, int& end) const
+{
+   if (m_traces.empty())
+      return false;
+
+   begin = std::max(begin, m_first_iter) - m_first_iter;
+   end = std::min<int>(end - m_first_iter, m_traces.front().size());
+
+   return end - begin >= 2 * MIN_HALF_LENGTH;
+}
+
+double Diagnostics::ess(int begin, int end) const
+{
+   return ess({ this }, begin, end);
+}
+
+double Diagnostics::rhat(int begin, int end) const
+{
+   return rhat({ this }, begin, end);
+}
+
+double Diagnostics::ess(const std::vector<const Diagnostics*>& chains, int begin, int end)
+{
+   double ret = std::numeric_limits<double>::quiet_NaN();
+
+   for (int t = 0; t < chains.front()->getNumTraces(); t++)
+   {
+      double sum = .0;
+      for (auto chain : chains)
+      {
+         int b = begin, e = end;
+         if (!chain->window(b, e))
+            return std::numeric_limits<double>::quiet_NaN();
+
+         sum += ess(chain->m_traces[t].data() + b, e - b);
+      }
+
+      // NaN until the first trace is done
+      if (!(ret <= sum))
+         ret = sum;
+   }
+
+   return ret;
+}
+
+double Diagnostics::rhat(const std::vector<const Diagnostics*>& chains, int begin, int end)
+{
+   double ret = std::numeric_limits<double>::quiet_NaN();
+
+   for (int t = 0; t < chains.front()->getNumTraces(); t++)
+   {
+      std::vector<const double*> x;
+      int n = std::numeric_limits<int>::max();
+      for (auto chain : chains)
+      {
+         int b = begin, e = end;
+         if (!chain->window(b, e))
+            return std::numeric_limits<double>::quiet_NaN();
+
+         x.push_back(chain->m_traces[t].data() + b);
+         n = std::min(n, e - b);
+      }
+
+      double r = split_rhat(x, n);
+      if (!(ret >= r))
+         ret = r;
+   }
+
+   return ret;
+}
+
+double Diagnostics::ess(const double* x, int n)
+{
+   if (n < 4)
+      return std::numeric_limits<double>::quiet_NaN();
+
+   double mean = .0;
+   for (int i = 0; i < n; i++)
+      mean += x[i];
+   mean /= n;
+
+   auto autocov = [x, n, mean](int lag)
+   {
+      double sum = .0;
+      for (int i = 0; i + lag < n; i++)
+         sum += (x[i] - mean) * (x[i + lag] - mean);
+      return sum / n;
+   };
+
+   const double gamma0 = autocov(0);
+   if (gamma0 <= 0.0)
+      return n; // constant trace
+
+   // sum of the autocovariance pairs while they stay positive,
+   // forced to decrease to damp the noise of the large lags
+   double tau = -gamma0;
+   double prev = std::numeric_limits<double>::infinity();
+   for (int lag = 0; lag + 1 < n; lag += 2)
+   {
+      double pair = (lag == 0 ? gamma0 : autocov(lag)) + autocov(lag + 1);
+      if (pair <= 0.0)
+         break;
+      pair = std::min(pair, prev);
+      tau += 2 * pair;
+      prev = pair;
+   }
+
+   // anti-correlated traces are not credited more than n * log10(n)
+   return std::min(n * gamma0 / tau, n * std::log10((double)n));
+}
+
+double Diagnostics::split_rhat(const std::vector<const double*>& x, int n)
+{
+   const int half = n / 2;
+   if (half < 2)
+      return std::numeric_limits<double>::quiet_NaN();
+
+   // means and variances of the halves of every sequence
+   std::vector<double> means, vars;
+   for (auto seq : x)
+   {
+      for (int h = 0; h < 2; h++)
+      {
+         const double* s = seq + (n - 2 * half) + h * half; // an odd first value is dropped
+         double mean = .0;
+         for (int i = 0; i < half; i++)
+            mean += s[i];
+         mean /= half;
+
+         double var = .0;
+         for (int i = 0; i < half; i++)
+            var += (s[i] - mean) * (s[i] - mean);
+         var /= half - 1;
+
+         means.push_back(mean);
+         vars.push_back(var);
+      }
+   }
+
+   const int m = means.size();
+   double mean_of_means = .0, W = .0;
+   for (int j = 0; j < m; j++)
+   {
+      mean_of_means += means[j] / m;
+      W += vars[j] / m;
+   }
+
+   double B_n = .0; // between sequence variance / half
+   for (int j = 0; j < m; j++)
+      B_n += (means[j] - mean_of_means) * (means[j] - mean_of_means) / (m - 1);
+
+   if (W <= 0.0)
+      return B_n > 0.0 ? std::numeric_limits<double>::infinity() : 1.0;
+
+   double var_plus = (half - 1.0) / half * W + B_n;
+   return std::sqrt(var_plus / W);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+namespace smurff {
+
+// streaming convergence diagnostics over a few scalar traces of a chain,
+// e.g. the model norms and the rmse of every iteration
+class Diagnostics
+{
+public:
+   // split-Rhat and the ESS need at least this many iterations in each half of a window
+   static const int MIN_HALF_LENGTH = 10;
+
+private:
+   int m_first_iter = -1; //iteration of the first values
+   std::vector<std::vector<double> > m_traces;
+
+public:
+   // appends the values of all traces at iteration <iter>
+   void add(int iter, const std::vector<double>& values);
+
+   int getNumTraces() const
+   {
+      return m_traces.size();
+   }
+
+   // smallest effective sample size over the traces on iterations [begin, end), NaN if too short
+   double ess(int begin, int end) const;
+
+   // largest split-Rhat over the traces on iterations [begin, end), NaN if too short
+   double rhat(int begin, int end) const;
+
+   // same over several chains with the same traces: the ESS is summed, every chain is split for Rhat
+   static double ess(const std::vector<const Diagnostics*>& chains, int begin, int end);
+   static double rhat(const std::vector<const Diagnostics*>& chains, int begin, int end);
+
+   // effective sample size of x[0 .. n), Geyer's initial monotone sequence estimator
+   static double ess(const double* x, int n);
+
+   // split-Rhat of the sequences x[c][0 .. n), every sequence is split into two halves
+   static double split_rhat(const std::vector<const double*>& x, int n);
+
+private:
+   // clamps [begin, end) to the stored iterations, returns false if it is too short
+   bool window(int& begin, int& end) const;
+};
+
+}
@@ -11,6 +11,7 @@
 #include "ThreadVector.hpp"
 
 #include "omp_util.h"
+#include "Error.h"
 
 using namespace std;
 using namespace Eigen;
@@ -29,6 +30,8 @@ using namespace std::chrono;
 #endif
 
 static smurff::thread_vector<MERSENNE_TWISTER> *bmrngs;
+static smurff::thread_vector<MERSENNE_TWISTER> *private_bmrngs;
+static bool private_bmrngs_used = false;
 
 double smurff::randn0()
 {
@@ -137,17 +140,62 @@ void smurff::init_bmrng()
    smurff::init_bmrng(ms);
 }
 
-void smurff::init_bmrng(int seed) 
+static smurff::thread_vector<MERSENNE_TWISTER> *create_bmrngs(int seed)
 {
     std::vector<MERSENNE_TWISTER> v;
-    for (int i = 0; i < threads::get_max_threads(); i++)
+    for (int i = 0; i < smurff::threads::get_max_threads(); i++)
     {
         v.push_back(MERSENNE_TWISTER(seed + i * 1999));
     }
-    bmrngs = new smurff::thread_vector<MERSENNE_TWISTER>();
-    bmrngs->init(v);
+    auto rngs = new smurff::thread_vector<MERSENNE_TWISTER>();
+    rngs->init(v);
+    return rngs;
+}
+
+void smurff::init_bmrng(int seed) 
+{
+    THROWERROR_ASSERT(!private_bmrngs_used);
+    bmrngs = create_bmrngs(seed);
+}
+
+void smurff::init_private_bmrng(int seed)
+{
+    THROWERROR_ASSERT(!private_bmrngs_used);
+    private_bmrngs = create_bmrngs(seed);
+}
+
+void smurff::use_private_bmrng(bool value)
+{
+    THROWERROR_ASSERT(private_bmrngs);
+    if (value == private_bmrngs_used)
+        return;
+
+    std::swap(bmrngs, private_bmrngs);
+    private_bmrngs_used = value;
 }
    
+struct smurff::bmrng_state
+{
+    smurff::thread_vector<MERSENNE_TWISTER> *rngs;
+
+    ~bmrng_state()
+    {
+        delete rngs;
+    }
+};
+
+std::shared_ptr<smurff::bmrng_state> smurff::create_bmrng_state(int seed)
+{
+    auto state = std::make_shared<bmrng_state>();
+    state->rngs = create_bmrngs(seed);
+    return state;
+}
+
+void smurff::swap_bmrng(bmrng_state& state)
+{
+    std::swap(bmrngs, state.rngs);
+}
+
 double smurff::rand_unif() 
 {
    UNIFORM_REAL_DISTRIBUTION unif(0.0, 1.0);
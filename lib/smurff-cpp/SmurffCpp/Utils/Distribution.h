@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
@@ -20,6 +21,17 @@ namespace smurff
    
    void init_bmrng();
    void init_bmrng(int seed);
+
+   // a second set of generators for the draws that differ between processes,
+   // use_private_bmrng switches all draws to it and back
+   void init_private_bmrng(int seed);
+   void use_private_bmrng(bool value);
+
+   // an independent set of generators, e.g. of one chain of a multi-chain session,
+   // swap_bmrng exchanges it with the generators all draws come from
+   struct bmrng_state;
+   std::shared_ptr<bmrng_state> create_bmrng_state(int seed);
+   void swap_bmrng(bmrng_state& state);
    
    double rand_unif();
    double rand_unif(double low, double high);
@@ -4,6 +4,14 @@
 #include <string>
 #include <sstream>
 
+namespace smurff {
+   // a linear solver (Cholesky, BlockCG) failed on its system, another solver may still succeed
+   class solver_error : public std::runtime_error
+   {
+   public:
+      using std::runtime_error::runtime_error;
+   };
+}
 
 #define CONCAT_VAR(n1, n2) n1 ## n2
 
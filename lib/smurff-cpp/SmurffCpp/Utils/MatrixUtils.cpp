@@ -1,5 +1,6 @@
 #include "MatrixUtils.h"
 
+#include <algorithm>
 #include <numeric>
 #include <set>
 #include <unsupported/Eigen/SparseExtra>
@@ -84,6 +85,103 @@ Eigen::MatrixXd smurff::matrix_utils::sparse_to_dense(const SparseDoubleMatrix&
     return out;
 }
 
+void smurff::matrix_utils::feature_hash(std::uint32_t col, std::uint32_t nbuckets, std::uint32_t seed, std::uint32_t& bucket, double& sign)
+{
+   // splitmix64 finalizer on (seed, col): low word picks the bucket, top bit the sign
+   std::uint64_t h = ((std::uint64_t)seed << 32) | col;
+   h += 0x9E3779B97F4A7C15ULL;
+   h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+   h = h ^ (h >> 31);
+
+   bucket = (std::uint32_t)(h & 0xFFFFFFFF) % nbuckets;
+   sign = (h >> 63) ? -1.0 : 1.0;
+}
+
+std::shared_ptr<smurff::MatrixConfig> smurff::matrix_utils::hash_columns(const smurff::MatrixConfig& in, std::uint32_t nbuckets, std::uint32_t seed)
+{
+   THROWERROR_ASSERT_MSG(!in.isDense(), "feature hashing needs sparse side info");
+   THROWERROR_ASSERT_MSG(nbuckets > 0, "number of hash buckets should be positive");
+
+   const std::vector<std::uint32_t>& rows = in.getRows();
+   const std::vector<std::uint32_t>& cols = in.getCols();
+   const std::vector<double>& values = in.getValues();
+   const std::uint64_t nnz = in.getNNZ();
+
+   // (row, bucket) packed into one key, so that sorting groups the collisions
+   std::vector<std::uint64_t> keys(nnz);
+   std::vector<double> signed_values(nnz);
+   #pragma omp parallel for schedule(static)
+   for (std::int64_t i = 0; i < (std::int64_t)nnz; i++)
+   {
+      std::uint32_t bucket;
+      double sign;
+      feature_hash(cols[i], nbuckets, seed, bucket, sign);
+      keys[i] = ((std::uint64_t)rows[i] << 32) | bucket;
+      signed_values[i] = sign * values[i];
+   }
+
+   std::vector<std::uint64_t> order(nnz);
+   std::iota(order.begin(), order.end(), 0);
+   std::sort(order.begin(), order.end(), [&keys](std::uint64_t a, std::uint64_t b) { return keys[a] < keys[b]; });
+
+   std::vector<std::uint32_t> out_rows;
+   std::vector<std::uint32_t> out_cols;
+   std::vector<double> out_values;
+   for (std::uint64_t i = 0; i < nnz; )
+   {
+      const std::uint64_t key = keys[order[i]];
+      double sum = 0.0;
+      for (; i < nnz && keys[order[i]] == key; i++)
+         sum += signed_values[order[i]];
+
+      // features of opposite sign in the same bucket can cancel out
+      if (sum == 0.0)
+         continue;
+
+      out_rows.push_back((std::uint32_t)(key >> 32));
+      out_cols.push_back((std::uint32_t)(key & 0xFFFFFFFF));
+      out_values.push_back(sum);
+   }
+
+   return std::make_shared<MatrixConfig>(in.getNRow(), nbuckets, std::move(out_rows), std::move(out_cols), std::move(out_values), in.getNoiseConfig(), false);
+}
+
+std::shared_ptr<smurff::MatrixConfig> smurff::matrix_utils::row_slice(const smurff::MatrixConfig& m, std::uint64_t begin, std::uint64_t end)
+{
+   const std::uint64_t nrow = end - begin;
+   const std::uint64_t ncol = m.getNCol();
+
+   if (m.isDense())
+   {
+      // dense values are stored column-major
+      const std::vector<double>& values = m.getValues();
+      std::vector<double> slice;
+      slice.reserve(nrow * ncol);
+      for (std::uint64_t c = 0; c < ncol; c++)
+         slice.insert(slice.end(), values.begin() + c * m.getNRow() + begin, values.begin() + c * m.getNRow() + end);
+      return std::make_shared<smurff::MatrixConfig>(nrow, ncol, std::move(slice), m.getNoiseConfig());
+   }
+
+   const std::vector<std::uint32_t>& rows = m.getRows();
+   const std::vector<std::uint32_t>& cols = m.getCols();
+   std::vector<std::uint32_t> sliceRows, sliceCols;
+   std::vector<double> sliceValues;
+   for (std::uint64_t i = 0; i < m.getNNZ(); i++)
+   {
+      if (rows[i] < begin || rows[i] >= end)
+         continue;
+      sliceRows.push_back(rows[i] - begin);
+      sliceCols.push_back(cols[i]);
+      if (!m.isBinary())
+         sliceValues.push_back(m.getValues()[i]);
+   }
+
+   if (m.isBinary())
+      return std::make_shared<smurff::MatrixConfig>(nrow, ncol, std::move(sliceRows), std::move(sliceCols), m.getNoiseConfig(), m.isScarce());
+   return std::make_shared<smurff::MatrixConfig>(nrow, ncol, std::move(sliceRows), std::move(sliceCols), std::move(sliceValues), m.getNoiseConfig(), m.isScarce());
+}
+
 std::ostream& smurff::matrix_utils::operator << (std::ostream& os, const MatrixConfig& mc)
 {
    const std::vector<std::uint32_t>& rows = mc.getRows();
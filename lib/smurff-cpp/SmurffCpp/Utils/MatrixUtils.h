@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
@@ -33,4 +36,38 @@ namespace smurff { namespace matrix_utils {
    bool equals(const Eigen::MatrixXd& m1, const Eigen::MatrixXd& m2, double precision = std::numeric_limits<double>::epsilon());
 
    bool equals_vector(const Eigen::VectorXd& v1, const Eigen::VectorXd& v2, double precision = std::numeric_limits<double>::epsilon() * 100);
+
+   // Feature hashing of side info: feature id col goes to column bucket with the given sign.
+   // The sign makes colliding features cancel out in expectation instead of adding up.
+
+   void feature_hash(std::uint32_t col, std::uint32_t nbuckets, std::uint32_t seed, std::uint32_t& bucket, double& sign);
+
+   // nrow x nbuckets sparse matrix with the hashed columns of in, colliding entries are summed
+
+   std::shared_ptr<MatrixConfig> hash_columns(const MatrixConfig& in, std::uint32_t nbuckets, std::uint32_t seed);
+
+   // rows [begin, end) of m, in the same format (dense, sparse or binary)
+
+   std::shared_ptr<MatrixConfig> row_slice(const MatrixConfig& m, std::uint64_t begin, std::uint64_t end);
+
+   // keeps only the rows listed in keep, in that order
+   template<typename T>
+   void keep_rows(T& m, const std::vector<int>& keep)
+   {
+      T out(keep.size(), m.cols());
+      for (std::size_t i = 0; i < keep.size(); i++)
+         out.row(i) = m.row(keep[i]);
+      m.swap(out);
+   }
+
+   // keeps only the rows and columns listed in keep, in that order
+   template<typename T>
+   void keep_rows_cols(T& m, const std::vector<int>& keep)
+   {
+      T out(keep.size(), keep.size());
+      for (std::size_t j = 0; j < keep.size(); j++)
+         for (std::size_t i = 0; i < keep.size(); i++)
+            out(i, j) = m(keep[i], keep[j]);
+      m.swap(out);
+   }
 }}
@@ -9,6 +9,8 @@
 #define OPTIONS_TAG "options"
 #define CHECKPOINT_STEP_PREFIX "checkpoint_step_"
 #define SAMPLE_STEP_PREFIX "sample_step_"
+#define CHAIN_ROOT_PREFIX "chain_root_"
+#define COMBINED_PRED_TAG "combined_pred"
 
 using namespace smurff;
 
@@ -212,6 +214,35 @@ std::shared_ptr<StepFile> RootFile::openSampleStepFile(std::string path) const
 }
 */
 
+void RootFile::addChainRootFile(int chain, std::string path) const
+{
+   appendToRootFile(std::string(), CHAIN_ROOT_PREFIX + std::to_string(chain), path);
+}
+
+std::vector<std::shared_ptr<RootFile>> RootFile::openChainRootFiles() const
+{
+   std::vector<std::shared_ptr<RootFile>> chains;
+
+   for (auto& section : m_iniReader->getSections())
+   {
+      auto fieldsIt = m_iniReader->getFields(section);
+      for (auto& field : fieldsIt->second)
+      {
+         if (!startsWith(field, CHAIN_ROOT_PREFIX))
+            continue;
+
+         chains.push_back(std::make_shared<RootFile>(m_iniReader->get(section, field)));
+      }
+   }
+
+   return chains;
+}
+
+void RootFile::addCombinedPredFile(std::string path) const
+{
+   appendToRootFile(std::string(), COMBINED_PRED_TAG, path);
+}
+
 void RootFile::flushLast() const
 {
    m_iniReader->flush();
@@ -76,6 +76,14 @@ public:
    std::shared_ptr<StepFile> openSampleStepFile(std::string path) const;
 */
 
+public:
+   //multi-chain sessions refer to the root file of every chain and to the combined predictions
+   void addChainRootFile(int chain, std::string path) const;
+
+   std::vector<std::shared_ptr<RootFile>> openChainRootFiles() const;
+
+   void addCombinedPredFile(std::string path) const;
+
 public:
    void flushLast() const;
 
@@ -1,6 +1,9 @@
 #include <SmurffCpp/Utils/StepFile.h>
 
+#include <cmath>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include <SmurffCpp/Model.h>
 #include <SmurffCpp/result.h>
@@ -17,9 +20,12 @@
 #define PRIOR_PREFIX "prior_"
 
 #define NUM_MODELS_TAG "num_models"
+#define ACTIVE_LATENTS_TAG "active_latents"
 #define NUM_PRIORS_TAG "num_priors"
 #define PRED_TAG "pred"
 #define PRED_STATE_TAG "pred_state"
+#define SOLVER_PREFIX "solver_"
+#define NOISE_PRECISION_TAG "noise_precision"
 
 using namespace smurff;
 
@@ -113,6 +119,18 @@ std::string StepFile::getLinkMatrixFileName(std::uint32_t mode) const
    return prefix + "-F" + std::to_string(mode) + "-link" + m_extension;
 }
 
+std::string StepFile::getMuFileName(std::uint32_t mode) const
+{
+   std::string prefix = getStepPrefix();
+   return prefix + "-F" + std::to_string(mode) + "-mu" + m_extension;
+}
+
+std::string StepFile::getLambdaFileName(std::uint32_t mode) const
+{
+   std::string prefix = getStepPrefix();
+   return prefix + "-F" + std::to_string(mode) + "-Lambda" + m_extension;
+}
+
 std::string StepFile::getPredFileName() const
 {
    std::string prefix = getStepPrefix();
@@ -125,6 +143,11 @@ std::string StepFile::getPredStateFileName() const
    return prefix + "-predictions-state.ini";
 }
 
+std::string StepFile::getSolverTag(std::uint32_t mode) const
+{
+   return SOLVER_PREFIX + std::to_string(mode);
+}
+
 //save methods
 
 void StepFile::saveModel(std::shared_ptr<const Model> model) const
@@ -141,6 +164,15 @@ void StepFile::saveModel(std::shared_ptr<const Model> model) const
       std::string path = getModelFileName(mIndex);
       appendToStepFile(std::string(), MODEL_PREFIX + std::to_string(mIndex), path);
    }
+
+   //original index of every row in the models
+   if (model->isPruned())
+   {
+      std::stringstream ss;
+      for (std::size_t i = 0; i < model->getActiveLatents().size(); i++)
+         ss << (i ? "," : "") << model->getActiveLatents()[i];
+      appendToStepFile(std::string(), ACTIVE_LATENTS_TAG, ss.str());
+   }
 }
 
 void StepFile::savePred(std::shared_ptr<const Result> m_pred) const
@@ -247,6 +279,7 @@ void StepFile::removeModel() const
       removeFromStepFile(MODEL_PREFIX + std::to_string(i));
 
    removeFromStepFile(NUM_MODELS_TAG);
+   removeFromStepFile(ACTIVE_LATENTS_TAG);
 }
 
 void StepFile::removePred() const
@@ -272,7 +305,14 @@ void StepFile::removePriors() const
 
    std::int32_t nPriors = getNPriors();
    for (std::int32_t i = 0; i < nPriors; i++)
+   {
+      std::remove(getMuFileName(i).c_str());
+      std::remove(getLambdaFileName(i).c_str());
       removeFromStepFile(PRIOR_PREFIX + std::to_string(i));
+      removeFromStepFile(getSolverTag(i));
+   }
+
+   removeFromStepFile(NOISE_PRECISION_TAG);
 
    removeFromStepFile(NUM_PRIORS_TAG);
 }
@@ -322,6 +362,38 @@ std::int32_t StepFile::getNPriors() const
    return std::stoi(getIniValueBase(NUM_PRIORS_TAG));
 }
 
+std::vector<int> StepFile::getActiveLatents() const
+{
+   std::vector<int> active_latents;
+
+   auto activeIt = tryGetIniValueBase(ACTIVE_LATENTS_TAG);
+   if (!activeIt.first)
+      return active_latents;
+
+   std::stringstream ss(activeIt.second);
+   std::string token;
+   while (std::getline(ss, token, ','))
+      active_latents.push_back(std::stoi(token));
+
+   return active_latents;
+}
+
+void StepFile::saveNoisePrecision(double alpha) const
+{
+   std::stringstream ss;
+   ss << std::setprecision(17) << alpha;
+   appendToStepFile(std::string(), NOISE_PRECISION_TAG, ss.str());
+}
+
+double StepFile::getNoisePrecision() const
+{
+   auto alphaIt = tryGetIniValueBase(NOISE_PRECISION_TAG);
+   if (!alphaIt.first)
+      return NAN;
+
+   return std::stod(alphaIt.second);
+}
+
 //ini methods
 
 std::string StepFile::getIniValueBase(const std::string& tag) const
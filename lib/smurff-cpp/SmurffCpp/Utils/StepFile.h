@@ -42,10 +42,15 @@ namespace smurff {
    public:
       std::string getModelFileName(std::uint64_t index) const;
       std::string getLinkMatrixFileName(std::uint32_t mode) const;
+      std::string getMuFileName(std::uint32_t mode) const;
+      std::string getLambdaFileName(std::uint32_t mode) const;
       std::string getPredFileName() const;
 
       std::string getPredStateFileName() const;
 
+      //ini tag of the solver picked by an autotuned macau prior
+      std::string getSolverTag(std::uint32_t mode) const;
+
    public:
       void saveModel(std::shared_ptr<const Model> model) const;
       void savePred(std::shared_ptr<const Result> m_pred) const;
@@ -77,6 +82,16 @@ namespace smurff {
 
       std::int32_t getNPriors() const;
 
+      //original indices of the latent dimentions in the models, empty if the model is not pruned
+      std::vector<int> getActiveLatents() const;
+
+   public:
+      //precision of the gaussian noise of the train data, saved with the hyperparameters
+      void saveNoisePrecision(double alpha) const;
+
+      //NaN if the step file has no noise precision
+      double getNoisePrecision() const;
+
    public:
       std::string getIniValueBase(const std::string& tag) const;
 
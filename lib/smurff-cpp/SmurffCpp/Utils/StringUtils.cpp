@@ -49,3 +49,13 @@ bool smurff::startsWith(const std::string& str, const std::string& prefix)
 
    return std::equal(prefix.begin(), prefix.end(), str.begin());
 }
+
+std::string smurff::addFileNameSuffix(const std::string& name, const std::string& suffix)
+{
+   std::size_t dot = name.find_last_of('.');
+   std::size_t slash = name.find_last_of('/');
+   if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+      return name + suffix;
+
+   return name.substr(0, dot) + suffix + name.substr(dot);
+}
@@ -40,4 +40,7 @@ namespace smurff
    }
 
    bool startsWith(const std::string& str, const std::string& prefix);
+
+   //name.csv -> name<suffix>.csv
+   std::string addFileNameSuffix(const std::string& name, const std::string& suffix);
 }
@@ -23,7 +23,7 @@ void chol_decomp(double* A, int n)
    dpotrf_(&lower, &n, A, &n, &info);
    if(info != 0)
    { 
-      THROWERROR("c++ error: Cholesky decomp failed"); 
+      THROWERROR_SPEC(smurff::solver_error, "c++ error: Cholesky decomp failed"); 
    }
 }
 
@@ -35,7 +35,7 @@ void chol_decomp(Eigen::MatrixXd & A)
    {
       std::stringstream ss;
       ss << std::string("c++ error: Cholesky decomp failed (for ") << std::to_string(n) << " x " << std::to_string(n) << " eigen matrix)";
-      THROWERROR(ss.str());
+      THROWERROR_SPEC(smurff::solver_error, ss.str());
    }
 }
 
@@ -1,6 +1,8 @@
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
 
 //#define EIGEN_USE_BLAS
 
@@ -15,12 +17,19 @@
 using namespace Eigen;
 using namespace std;
 
+// length of the inner dimension blocks of the single precision products,
+// only partial sums within a block are accumulated in float
+static const int SGEMM_BLOCK = 1024;
+
 #ifndef EIGEN_USE_MKL_ALL
 extern "C" void dsyrk_(char *uplo, char *trans, int *m, int *n, double *alpha, double a[],
             int *lda, double *beta, double c[], int *ldc);
 extern "C" void dgemm_(char *transa, char *transb, int *m, int *n, int *k, double *alpha,
             double a[], int *lda, double b[], int *ldb, double *beta, double c[],
             int *ldc);
+extern "C" void sgemm_(char *transa, char *transb, int *m, int *n, int *k, float *alpha,
+            float a[], int *lda, float b[], int *ldb, float *beta, float c[],
+            int *ldc);
 
 /*
 extern "C" void dsymm_(char *side, char *uplo, int *m, int *n, double *alpha, double a[],
@@ -62,6 +71,79 @@ void smurff::linop::A_mul_Bt(Eigen::MatrixXd & out, CSR & csr, Eigen::MatrixXd &
   csr_A_mul_Bn( out.data(), & csr, B.data(), B.rows() );
 }
 
+// OUT' = cbcsr * B' (for matrices)
+void smurff::linop::A_mul_Bt(Eigen::MatrixXd & out, CompressedBinaryCSR & csr, Eigen::MatrixXd & B) 
+{
+  if (csr.nrow != out.cols()) {THROWERROR("csr.nrow must equal out.cols()");}
+  if (csr.ncol != B.cols())   {THROWERROR("csr.ncol must equal b.cols()");}
+  if (out.rows() != B.rows()) {THROWERROR("out.rows() must equal B.rows()");}
+  cbcsr_A_mul_Bn( out.data(), & csr, B.data(), B.rows() );
+}
+
+// Y = bits * X, Y and X have <ncol> columns and are row-ordered
+static void bitpacked_A_mul_Bn(double* Y, const std::uint64_t* bits, const int nwords, const int nrow, const double* X, const int ncol)
+{
+  #pragma omp parallel
+  {
+    std::vector<double> tmp(ncol);
+    #pragma omp for schedule(dynamic, 64)
+    for (int row = 0; row < nrow; row++) 
+    {
+      std::fill(tmp.begin(), tmp.end(), 0.0);
+      const std::uint64_t* rbits = bits + (std::size_t)row * nwords;
+      for (int w = 0; w < nwords; w++) 
+      {
+        for (std::uint64_t word = rbits[w]; word; word &= word - 1) 
+        {
+          const double* x = X + ((std::int64_t)w * 64 + smurff::lowest_bit64(word)) * ncol;
+          for (int j = 0; j < ncol; j++) 
+          {
+            tmp[j] += x[j];
+          }
+        }
+      }
+      std::copy(tmp.begin(), tmp.end(), Y + (std::int64_t)row * ncol);
+    }
+  }
+}
+
+// Y = bits' * X, the <nrow> rows of Y are filled one 64-bit word (64 rows) per thread
+static void bitpacked_At_mul_Bn(double* Y, const std::uint64_t* bits, const int nwords, const int nbits, const int nrow, const double* X, const int ncol)
+{
+  #pragma omp parallel
+  {
+    std::vector<double> tmp(64 * ncol);
+    #pragma omp for schedule(dynamic, 1)
+    for (int w = 0; w < nwords; w++) 
+    {
+      std::fill(tmp.begin(), tmp.end(), 0.0);
+      for (int b = 0; b < nbits; b++) 
+      {
+        const double* x = X + (std::int64_t)b * ncol;
+        for (std::uint64_t word = bits[(std::size_t)b * nwords + w]; word; word &= word - 1) 
+        {
+          double* t = tmp.data() + smurff::lowest_bit64(word) * ncol;
+          for (int j = 0; j < ncol; j++) 
+          {
+            t[j] += x[j];
+          }
+        }
+      }
+      const int nr = std::min(64, nrow - w * 64);
+      std::copy(tmp.begin(), tmp.begin() + nr * ncol, Y + (std::int64_t)w * 64 * ncol);
+    }
+  }
+}
+
+// OUT' = A * B' (for matrices)
+void smurff::linop::A_mul_Bt(Eigen::MatrixXd & out, BitPackedFeat & A, Eigen::MatrixXd & B) 
+{
+  if (A.nrow != out.cols())   {THROWERROR("A.nrow must equal out.cols()");}
+  if (A.ncol != B.cols())     {THROWERROR("A.ncol must equal b.cols()");}
+  if (out.rows() != B.rows()) {THROWERROR("out.rows() must equal B.rows()");}
+  bitpacked_At_mul_Bn( out.data(), A.Mt.data(), A.col_words, A.ncol, A.nrow, B.data(), B.rows() );
+}
+
 //method is identical
 
 //X = A * B
@@ -72,6 +154,13 @@ Eigen::MatrixXd smurff::linop::A_mul_B(Eigen::MatrixXd & A, Eigen::MatrixXd & B)
    return out;
 }
 
+Eigen::MatrixXd smurff::linop::A_mul_B(Eigen::MatrixXd & A, Eigen::MatrixXf & B) 
+{
+   Eigen::MatrixXd out(A.rows(), B.cols());
+   A_mul_B_sgemm(out, A, B);
+   return out;
+}
+
 //method is identical
  
 Eigen::MatrixXd smurff::linop::A_mul_B(Eigen::MatrixXd & A, SparseFeat & B) 
@@ -90,6 +179,159 @@ Eigen::MatrixXd smurff::linop::A_mul_B(Eigen::MatrixXd & A, SparseDoubleFeat & B
    return out;
 }
 
+//method is identical
+ 
+Eigen::MatrixXd smurff::linop::A_mul_B(Eigen::MatrixXd & A, CompressedSparseFeat & B) 
+{
+   Eigen::MatrixXd out(A.rows(), B.cols());
+   A_mul_Bt(out, B.Mt, A);
+   return out;
+}
+
+Eigen::MatrixXd smurff::linop::A_mul_B(Eigen::MatrixXd & A, BitPackedFeat & B) 
+{
+   if (A.cols() != B.rows()) {THROWERROR("A.cols() must equal B.rows()");}
+   Eigen::MatrixXd out(A.rows(), B.cols());
+   bitpacked_A_mul_Bn( out.data(), B.Mt.data(), B.col_words, B.ncol, A.data(), A.rows() );
+   return out;
+}
+
+namespace {
+
+// splits the features [0, cost.size()) into contiguous blocks of about equal
+// total cost, returns the block boundaries
+std::vector<int> balanced_blocks(const std::vector<std::int64_t> & cost, const int nblocks)
+{
+  std::int64_t total = 0;
+  for (auto c : cost) 
+  {
+    total += c;
+  }
+  const std::int64_t target = std::max<std::int64_t>(1, total / std::max(1, nblocks));
+
+  std::vector<int> bounds(1, 0);
+  std::int64_t acc = 0;
+  for (int f = 0; f < (int)cost.size(); f++) 
+  {
+    acc += cost[f];
+    if (acc >= target) 
+    {
+      bounds.push_back(f + 1);
+      acc = 0;
+    }
+  }
+  if (bounds.back() != (int)cost.size()) 
+  {
+    bounds.push_back(cost.size());
+  }
+  return bounds;
+}
+
+// runs body(f) for all features, in blocks of balanced cost scheduled over the threads
+template<typename Body>
+void for_balanced_features(const std::vector<std::int64_t> & cost, Body body)
+{
+  const std::vector<int> bounds = balanced_blocks(cost, 16 * smurff::threads::get_max_threads());
+  const int nblocks = bounds.size() - 1;
+
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (int b = 0; b < nblocks; b++) 
+  {
+    for (int f = bounds[b]; f < bounds[b + 1]; f++) 
+    {
+      body(f);
+    }
+  }
+}
+
+// rows of M with sorted column indices, rebuilt from Mt by a counting sort,
+// so the part of a row at or right of the diagonal is found by binary search
+struct SortedRows
+{
+  std::vector<int> row_ptr;
+  std::vector<int> cols;
+  std::vector<double> vals; // empty for binary features
+
+  SortedRows(const int nrow, const int ncol, const int* t_row_ptr, const int* t_cols, const double* t_vals = 0)
+    : row_ptr(nrow + 1, 0), cols(t_row_ptr[ncol])
+  {
+    const int nnz = t_row_ptr[ncol];
+    for (int i = 0; i < nnz; i++) 
+    {
+      row_ptr[t_cols[i] + 1]++;
+    }
+    for (int r = 0; r < nrow; r++) 
+    {
+      row_ptr[r + 1] += row_ptr[r];
+    }
+    if (t_vals) 
+    {
+      vals.resize(nnz);
+    }
+
+    std::vector<int> fill(row_ptr.begin(), row_ptr.end() - 1);
+    for (int f = 0; f < ncol; f++) 
+    {
+      for (int i = t_row_ptr[f]; i < t_row_ptr[f + 1]; i++) 
+      {
+        const int p = fill[t_cols[i]]++;
+        cols[p] = f;
+        if (t_vals) 
+        {
+          vals[p] = t_vals[i];
+        }
+      }
+    }
+  }
+
+  // first position in row r with a column >= f
+  int lower(const int r, const int f) const
+  {
+    return std::lower_bound(cols.begin() + row_ptr[r], cols.begin() + row_ptr[r + 1], f) - cols.begin();
+  }
+
+  // number of pairs (f, f2 >= f) feature f contributes to A'A
+  std::vector<std::int64_t> pair_cost(const int ncol, const int* t_row_ptr, const int* t_cols) const
+  {
+    std::vector<std::int64_t> cost(ncol);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int f = 0; f < ncol; f++) 
+    {
+      std::int64_t c = 1;
+      for (int i = t_row_ptr[f]; i < t_row_ptr[f + 1]; i++) 
+      {
+        c += row_ptr[t_cols[i] + 1] - lower(t_cols[i], f);
+      }
+      cost[f] = c;
+    }
+    return cost;
+  }
+};
+
+// cost of the features of a (transposed) CSR: total length of the rows they touch
+template<typename RowPtr, typename NextRow>
+std::vector<std::int64_t> row_length_cost(const int ncol, const RowPtr* t_row_ptr, const RowPtr* row_ptr, NextRow next_row)
+{
+  std::vector<std::int64_t> cost(ncol);
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (int f = 0; f < ncol; f++) 
+  {
+    std::int64_t c = 1;
+    std::int64_t r = 0;
+    for (std::int64_t i = t_row_ptr[f], end = t_row_ptr[f + 1]; i < end; ) 
+    {
+      r = next_row(i, r);
+      c += row_ptr[r + 1] - row_ptr[r];
+    }
+    cost[f] = c;
+  }
+  return cost;
+}
+
+}
+
+// column f1 of the lower triangle only gets the pairs (f1, f2 >= f1), which are
+// contiguous in the sorted rows
 void smurff::linop::At_mul_A(Eigen::MatrixXd & out, SparseFeat & A) {
   if (out.cols() != A.cols()) {
    THROWERROR("At_mul_A(SparseFeat): out.cols() must equal A.cols()");
@@ -100,32 +342,383 @@ void smurff::linop::At_mul_A(Eigen::MatrixXd & out, SparseFeat & A) {
 
   out.setZero();
   const int nfeat = A.M.ncol;
+  const SortedRows M(A.M.nrow, nfeat, A.Mt.row_ptr, A.Mt.cols);
 
-  #pragma omp parallel for schedule(dynamic, 8)
-  for (int f1 = 0; f1 < nfeat; f1++) 
+  for_balanced_features(M.pair_cost(nfeat, A.Mt.row_ptr, A.Mt.cols), [&](int f1)
   {
-    int end = A.Mt.row_ptr[f1 + 1];
-    out(f1, f1) = end - A.Mt.row_ptr[f1];
+    double* col = out.col(f1).data();
     // looping over all non-zero rows of f1
-    for (int i = A.Mt.row_ptr[f1]; i < end; i++) 
+    for (int i = A.Mt.row_ptr[f1], end = A.Mt.row_ptr[f1 + 1]; i < end; i++) 
     {
       int Mrow = A.Mt.cols[i]; /* row in M */
-      int end2 = A.M.row_ptr[Mrow + 1];
-      for (int j = A.M.row_ptr[Mrow]; j < end2; j++) 
+      for (int j = M.lower(Mrow, f1), end2 = M.row_ptr[Mrow + 1]; j < end2; j++) 
+      {
+        col[M.cols[j]] += 1;
+      }
+    }
+  });
+}
+
+void smurff::linop::At_mul_A(Eigen::MatrixXd & out, CompressedSparseFeat & A) {
+  if (out.cols() != A.cols()) {
+   THROWERROR("At_mul_A(CompressedSparseFeat): out.cols() must equal A.cols()");
+  }
+  if (out.cols() != out.rows()) {
+   THROWERROR("At_mul_A(CompressedSparseFeat): out must be square matrix.)");
+  }
+
+  out.setZero();
+  const std::int64_t nfeat = A.M.ncol;
+  auto next_row = [&A](std::int64_t & i, std::int64_t r) { return cbcsr_next_col(A.Mt.deltas, i, r); };
+
+  for_balanced_features(row_length_cost(nfeat, A.Mt.row_ptr, A.M.row_ptr, next_row), [&](int f1)
+  {
+    // looping over all non-zero rows of f1
+    std::int64_t Mrow = 0;
+    for (std::int64_t i = A.Mt.row_ptr[f1], end = A.Mt.row_ptr[f1 + 1]; i < end; ) 
+    {
+      Mrow = cbcsr_next_col(A.Mt.deltas, i, Mrow); /* row in M */
+      out(f1, f1) += 1;
+      std::int64_t f2 = 0;
+      for (std::int64_t j = A.M.row_ptr[Mrow], end2 = A.M.row_ptr[Mrow + 1]; j < end2; ) 
       {
-        int f2 = A.M.cols[j];
+        f2 = cbcsr_next_col(A.M.deltas, j, f2);
         if (f1 < f2) 
         {
           out(f2, f1) += 1;
         }
       }
     }
+  });
+}
+
+// A'A of binary columns is the popcount of the AND-ed columns
+void smurff::linop::At_mul_A(Eigen::MatrixXd & out, BitPackedFeat & A) {
+  if (out.cols() != A.cols()) {
+   THROWERROR("At_mul_A(BitPackedFeat): out.cols() must equal A.cols()");
   }
+  if (out.cols() != out.rows()) {
+   THROWERROR("At_mul_A(BitPackedFeat): out must be square matrix.)");
+  }
+
+  const int nfeat = A.ncol;
+  const int nwords = A.col_words;
+
+  // column f1 of the lower triangle has nfeat - f1 entries
+  std::vector<std::int64_t> cost(nfeat);
+  for (int f = 0; f < nfeat; f++) 
+  {
+    cost[f] = nfeat - f;
+  }
+
+  for_balanced_features(cost, [&](int f1)
+  {
+    const std::uint64_t* c1 = A.col(f1);
+    for (int f2 = f1; f2 < nfeat; f2++) 
+    {
+      const std::uint64_t* c2 = A.col(f2);
+      int count = 0;
+      for (int w = 0; w < nwords; w++) 
+      {
+        count += popcount64(c1[w] & c2[w]);
+      }
+      out(f2, f1) = count;
+    }
+  });
+}
+
+namespace {
+
+// sparse accumulator for one column of a sparse matrix product
+struct SparseAccumulator
+{
+   std::vector<double> values;
+   std::vector<char> used;
+   std::vector<int> pattern;
+
+   SparseAccumulator(int n) : values(n), used(n, 0) {}
+
+   void add(int i, double v)
+   {
+      if (!used[i])
+      {
+         used[i] = 1;
+         values[i] = v;
+         pattern.push_back(i);
+      }
+      else
+      {
+         values[i] += v;
+      }
+   }
+
+   // moves the accumulated column to out (sorted by row) and resets
+   void flush(std::vector<std::pair<int, double> > & out)
+   {
+      std::sort(pattern.begin(), pattern.end());
+      out.reserve(pattern.size());
+      for (int i : pattern)
+      {
+         out.push_back(std::make_pair(i, values[i]));
+         used[i] = 0;
+      }
+      pattern.clear();
+   }
+};
+
+// assembles the lower triangle of A'A, column f1 is accumulated by add_column(f1, spa)
+template<typename AddColumn>
+void At_mul_A_sparse(Eigen::SparseMatrix<double> & out, const std::vector<std::int64_t> & cost, AddColumn add_column)
+{
+  const int nfeat = cost.size();
+  std::vector<std::vector<std::pair<int, double> > > columns(nfeat);
+
+  const std::vector<int> bounds = balanced_blocks(cost, 16 * smurff::threads::get_max_threads());
+  const int nblocks = bounds.size() - 1;
+
+  #pragma omp parallel
+  {
+    SparseAccumulator spa(nfeat);
+    #pragma omp for schedule(dynamic, 1)
+    for (int b = 0; b < nblocks; b++) 
+    {
+      for (int f1 = bounds[b]; f1 < bounds[b + 1]; f1++) 
+      {
+        add_column(f1, spa);
+        spa.flush(columns[f1]);
+      }
+    }
+  }
+
+  Eigen::VectorXi nnz_per_col(nfeat);
+  for (int f = 0; f < nfeat; f++) 
+  {
+    nnz_per_col(f) = columns[f].size();
+  }
+
+  out.resize(nfeat, nfeat);
+  out.setZero();
+  out.reserve(nnz_per_col);
+  for (int f = 0; f < nfeat; f++) 
+  {
+    for (auto & e : columns[f]) 
+    {
+      out.insert(e.first, f) = e.second;
+    }
+    std::vector<std::pair<int, double> >().swap(columns[f]);
+  }
+  out.makeCompressed();
+}
+
+// first-fit coloring, add_neighbours(f, nb) appends every column sharing a row with f to nb
+template<typename AddNeighbours>
+void color_cols_greedy(std::vector<std::vector<int> > & colors, const int nfeat, AddNeighbours add_neighbours)
+{
+  std::vector<int> color(nfeat, -1);
+  std::vector<int> taken; // taken[c] == f if a neighbour of f has color c
+  std::vector<int> nb;
+
+  for (int f = 0; f < nfeat; f++) 
+  {
+    nb.clear();
+    add_neighbours(f, nb);
+    for (int g : nb) 
+    {
+      if (color[g] >= 0) 
+      {
+        taken[color[g]] = f;
+      }
+    }
+
+    int c = 0;
+    while (c < (int)taken.size() && taken[c] == f) 
+    {
+      c++;
+    }
+    if (c == (int)taken.size()) 
+    {
+      taken.push_back(-1);
+    }
+    color[f] = c;
+  }
+
+  colors.assign(taken.size(), std::vector<int>());
+  for (int f = 0; f < nfeat; f++) 
+  {
+    colors[color[f]].push_back(f);
+  }
+}
+
+}
+
+void smurff::linop::At_mul_A(Eigen::SparseMatrix<double> & out, SparseFeat & A) {
+  const SortedRows M(A.M.nrow, A.M.ncol, A.Mt.row_ptr, A.Mt.cols);
+  At_mul_A_sparse(out, M.pair_cost(A.M.ncol, A.Mt.row_ptr, A.Mt.cols), [&A, &M](int f1, SparseAccumulator & spa)
+  {
+    for (int i = A.Mt.row_ptr[f1], end = A.Mt.row_ptr[f1 + 1]; i < end; i++) 
+    {
+      int Mrow = A.Mt.cols[i]; /* row in M */
+      for (int j = M.lower(Mrow, f1), end2 = M.row_ptr[Mrow + 1]; j < end2; j++) 
+      {
+        spa.add(M.cols[j], 1.0);
+      }
+    }
+  });
+}
+
+void smurff::linop::At_mul_A(Eigen::SparseMatrix<double> & out, SparseDoubleFeat & A) {
+  const SortedRows M(A.M.nrow, A.M.ncol, A.Mt.row_ptr, A.Mt.cols, A.Mt.vals);
+  At_mul_A_sparse(out, M.pair_cost(A.M.ncol, A.Mt.row_ptr, A.Mt.cols), [&A, &M](int f1, SparseAccumulator & spa)
+  {
+    for (int i = A.Mt.row_ptr[f1], end = A.Mt.row_ptr[f1 + 1]; i < end; i++) 
+    {
+      int Mrow    = A.Mt.cols[i]; /* row in M */
+      double val1 = A.Mt.vals[i]; /* value for Mrow */
+      for (int j = M.lower(Mrow, f1), end2 = M.row_ptr[Mrow + 1]; j < end2; j++) 
+      {
+        spa.add(M.cols[j], M.vals[j] * val1);
+      }
+    }
+  });
+}
+
+void smurff::linop::At_mul_A(Eigen::SparseMatrix<double> & out, CompressedSparseFeat & A) {
+  auto next_row = [&A](std::int64_t & i, std::int64_t r) { return cbcsr_next_col(A.Mt.deltas, i, r); };
+  At_mul_A_sparse(out, row_length_cost(A.cols(), A.Mt.row_ptr, A.M.row_ptr, next_row), [&A](int f1, SparseAccumulator & spa)
+  {
+    std::int64_t Mrow = 0;
+    for (std::int64_t i = A.Mt.row_ptr[f1], end = A.Mt.row_ptr[f1 + 1]; i < end; ) 
+    {
+      Mrow = cbcsr_next_col(A.Mt.deltas, i, Mrow); /* row in M */
+      std::int64_t f2 = 0;
+      for (std::int64_t j = A.M.row_ptr[Mrow], end2 = A.M.row_ptr[Mrow + 1]; j < end2; ) 
+      {
+        f2 = cbcsr_next_col(A.M.deltas, j, f2);
+        if (f1 <= f2) 
+        {
+          spa.add(f2, 1.0);
+        }
+      }
+    }
+  });
+}
+
+// the lower triangle of A'A has an entry wherever two columns share a set bit
+void smurff::linop::At_mul_A(Eigen::SparseMatrix<double> & out, BitPackedFeat & A) {
+  const int nfeat = A.ncol;
+  std::vector<std::int64_t> cost(nfeat);
+  for (int f = 0; f < nfeat; f++) 
+  {
+    cost[f] = nfeat - f;
+  }
+
+  At_mul_A_sparse(out, cost, [&A, nfeat](int f1, SparseAccumulator & spa)
+  {
+    const std::uint64_t* c1 = A.col(f1);
+    for (int f2 = f1; f2 < nfeat; f2++) 
+    {
+      const std::uint64_t* c2 = A.col(f2);
+      int count = 0;
+      for (int w = 0; w < A.col_words; w++) 
+      {
+        count += popcount64(c1[w] & c2[w]);
+      }
+      if (count) 
+      {
+        spa.add(f2, count);
+      }
+    }
+  });
+}
+
+void smurff::linop::color_cols(std::vector<std::vector<int> > & colors, SparseFeat & A) {
+  color_cols_greedy(colors, A.cols(), [&A](int f, std::vector<int> & nb)
+  {
+    for (int i = A.Mt.row_ptr[f], end = A.Mt.row_ptr[f + 1]; i < end; i++) 
+    {
+      int Mrow = A.Mt.cols[i];
+      for (int j = A.M.row_ptr[Mrow], end2 = A.M.row_ptr[Mrow + 1]; j < end2; j++) 
+      {
+        nb.push_back(A.M.cols[j]);
+      }
+    }
+  });
+}
+
+void smurff::linop::color_cols(std::vector<std::vector<int> > & colors, SparseDoubleFeat & A) {
+  color_cols_greedy(colors, A.cols(), [&A](int f, std::vector<int> & nb)
+  {
+    for (int i = A.Mt.row_ptr[f], end = A.Mt.row_ptr[f + 1]; i < end; i++) 
+    {
+      int Mrow = A.Mt.cols[i];
+      for (int j = A.M.row_ptr[Mrow], end2 = A.M.row_ptr[Mrow + 1]; j < end2; j++) 
+      {
+        nb.push_back(A.M.cols[j]);
+      }
+    }
+  });
+}
+
+void smurff::linop::color_cols(std::vector<std::vector<int> > & colors, CompressedSparseFeat & A) {
+  color_cols_greedy(colors, A.cols(), [&A](int f, std::vector<int> & nb)
+  {
+    std::int64_t Mrow = 0;
+    for (std::int64_t i = A.Mt.row_ptr[f], end = A.Mt.row_ptr[f + 1]; i < end; ) 
+    {
+      Mrow = cbcsr_next_col(A.Mt.deltas, i, Mrow);
+      std::int64_t g = 0;
+      for (std::int64_t j = A.M.row_ptr[Mrow], end2 = A.M.row_ptr[Mrow + 1]; j < end2; ) 
+      {
+        g = cbcsr_next_col(A.M.deltas, j, g);
+        nb.push_back(g);
+      }
+    }
+  });
+}
+
+void smurff::linop::color_cols(std::vector<std::vector<int> > & colors, BitPackedFeat & A) {
+  color_cols_greedy(colors, A.cols(), [&A](int f, std::vector<int> & nb)
+  {
+    const std::uint64_t* c1 = A.col(f);
+    for (int g = 0; g < A.ncol; g++) 
+    {
+      const std::uint64_t* c2 = A.col(g);
+      for (int w = 0; w < A.col_words; w++) 
+      {
+        if (c1[w] & c2[w]) 
+        {
+          nb.push_back(g);
+          break;
+        }
+      }
+    }
+  });
 }
 
 void smurff::linop::At_mul_A(Eigen::MatrixXd & out, Eigen::MatrixXd & A) {
-  // TODO: use blas
-  out.triangularView<Eigen::Lower>() = A.transpose() * A;
+  if (out.cols() != A.cols() || out.rows() != A.cols()) {
+   THROWERROR("At_mul_A(MatrixXd): out must be A.cols() x A.cols()");
+  }
+  At_mul_A_blas(A, out.data());
+}
+
+// A'A is accumulated in double, converting a block of rows of A at a time
+void smurff::linop::At_mul_A(Eigen::MatrixXd & out, Eigen::MatrixXf & A) {
+  if (out.cols() != A.cols() || out.rows() != A.cols()) {
+   THROWERROR("At_mul_A(MatrixXf): out must be A.cols() x A.cols()");
+  }
+  out.setZero();
+  char lower  = 'L';
+  char trans  = 'T';
+  int  m      = A.cols();
+  double one  = 1.0;
+  Eigen::MatrixXd Ablock;
+  for (int start = 0; start < A.rows(); start += SGEMM_BLOCK) {
+    int n = std::min(SGEMM_BLOCK, (int)A.rows() - start);
+    Ablock = A.middleRows(start, n).cast<double>();
+    dsyrk_(&lower, &trans, &m, &n, &one, Ablock.data(),
+           &n, &one, out.data(), &m);
+  }
 }
 
 void smurff::linop::At_mul_A(Eigen::MatrixXd & out, SparseDoubleFeat & A) {
@@ -137,26 +730,23 @@ void smurff::linop::At_mul_A(Eigen::MatrixXd & out, SparseDoubleFeat & A) {
   }
   out.setZero();
   const int nfeat = A.M.ncol;
+  const SortedRows M(A.M.nrow, nfeat, A.Mt.row_ptr, A.Mt.cols, A.Mt.vals);
 
-  #pragma omp parallel for schedule(dynamic, 8)
-  for (int f1 = 0; f1 < nfeat; f1++) 
+  for_balanced_features(M.pair_cost(nfeat, A.Mt.row_ptr, A.Mt.cols), [&](int f1)
   {
+    double* col = out.col(f1).data();
     // looping over all non-zero rows of f1
     for (int i = A.Mt.row_ptr[f1], end = A.Mt.row_ptr[f1 + 1]; i < end; i++) 
     {
       int Mrow     = A.Mt.cols[i]; /* row in M */
       double val1  = A.Mt.vals[i]; /* value for Mrow */
 
-      for (int j = A.M.row_ptr[Mrow], end2 = A.M.row_ptr[Mrow + 1]; j < end2; j++) 
+      for (int j = M.lower(Mrow, f1), end2 = M.row_ptr[Mrow + 1]; j < end2; j++) 
       {
-        int f2 = A.M.cols[j];
-        if (f1 <= f2) 
-        {
-          out(f2, f1) += A.M.vals[j] * val1;
-        }
+        col[M.cols[j]] += M.vals[j] * val1;
       }
     }
-  }
+  });
 }
 
 void smurff::linop::At_mul_A_blas(Eigen::MatrixXd & A, double* AtA) {
@@ -222,6 +812,54 @@ void smurff::linop::A_mul_Bt_blas(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eige
   double beta  = 0.0;
   dgemm_(&transA, &transB, &m, &n, &k, &alpha, A.data(), &m, B.data(), &n, &beta, Y.data(), &m);
 }
+void smurff::linop::A_mul_B_sgemm(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eigen::MatrixXf & B) {
+  if (Y.rows() != A.rows()) {THROWERROR("A.rows() must equal Y.rows()");}
+  if (Y.cols() != B.cols()) {THROWERROR("B.cols() must equal Y.cols()");}
+  if (A.cols() != B.rows()) {THROWERROR("B.rows() must equal A.cols()");}
+  int m   = A.rows();
+  int n   = B.cols();
+  int ldb = B.rows();
+  char transA = 'N';
+  char transB = 'N';
+  float alpha = 1.0f;
+  float beta  = 0.0f;
+  Eigen::MatrixXf Ablock, Yblock(m, n);
+  Y.setZero();
+  for (int start = 0; start < A.cols(); start += SGEMM_BLOCK) {
+    int k = std::min(SGEMM_BLOCK, (int)A.cols() - start);
+    Ablock = A.middleCols(start, k).cast<float>();
+    sgemm_(&transA, &transB, &m, &n, &k, &alpha, Ablock.data(), &m, B.data() + start, &ldb, &beta, Yblock.data(), &m);
+    Y += Yblock.cast<double>();
+  }
+}
+
+void smurff::linop::A_mul_Bt_sgemm(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eigen::MatrixXf & B) {
+  if (Y.rows() != A.rows()) {THROWERROR("A.rows() must equal Y.rows()");}
+  if (Y.cols() != B.rows()) {THROWERROR("B.rows() must equal Y.cols()");}
+  if (A.cols() != B.cols()) {THROWERROR("B.cols() must equal A.cols()");}
+  int m = A.rows();
+  int n = B.rows();
+  char transA = 'N';
+  char transB = 'T';
+  float alpha = 1.0f;
+  float beta  = 0.0f;
+  Eigen::MatrixXf Ablock, Yblock(m, n);
+  Y.setZero();
+  for (int start = 0; start < A.cols(); start += SGEMM_BLOCK) {
+    int k = std::min(SGEMM_BLOCK, (int)A.cols() - start);
+    Ablock = A.middleCols(start, k).cast<float>();
+    sgemm_(&transA, &transB, &m, &n, &k, &alpha, Ablock.data(), &m, B.data() + (std::int64_t)start * n, &n, &beta, Yblock.data(), &m);
+    Y += Yblock.cast<double>();
+  }
+}
+
+// out = (B * A') * A + reg * B, both products stream A in single precision
+void smurff::linop::AtA_mul_B_switch(Eigen::MatrixXd & out, Eigen::MatrixXf & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp) {
+  A_mul_Bt_sgemm(tmp, B, A);
+  A_mul_B_sgemm(out, tmp, A);
+  out += reg * B;
+}
+
 /*
 void smurff::linop::Asym_mul_B_left(double beta, Eigen::MatrixXd & Y, double alpha, Eigen::MatrixXd & A, Eigen::MatrixXd & B) {
   cblas_dsymm(CblasColMajor, CblasLeft, CblasLower, Y.rows(), Y.cols(), alpha, A.data(), A.rows(), B.data(), B.rows(), beta, Y.data(), Y.rows());
@@ -268,6 +906,23 @@ void smurff::linop::AtA_mul_B(Eigen::MatrixXd & out, SparseDoubleFeat & A, doubl
   }
 }
 
+template<>
+void smurff::linop::AtA_mul_B(Eigen::MatrixXd & out, CompressedSparseFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp) {
+  // solution update:
+  A_mul_Bt(tmp, A.M, B);
+  A_mul_Bt(out, A.Mt, tmp);
+
+  int ncol = out.cols(), nrow = out.rows();
+  #pragma omp parallel for schedule(static)
+  for (int col = 0; col < ncol; col++) 
+  {
+    for (int row = 0; row < nrow; row++) 
+    {
+      out(row, col) += reg * B(row, col);
+    }
+  }
+}
+
 template<>
 void smurff::linop::AtA_mul_B(Eigen::MatrixXd & out, Eigen::MatrixXd & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp) {
   // solution update:
@@ -445,6 +1100,42 @@ Eigen::VectorXd smurff::linop::col_square_sum(SparseDoubleFeat & A)
    return out;
 }
 
+Eigen::VectorXd smurff::linop::col_square_sum(CompressedSparseFeat & A) 
+{
+   const int ncol = A.cols();
+   VectorXd out(ncol);
+   #pragma omp parallel for schedule(dynamic, 256)
+   for (int col = 0; col < ncol; col++)
+   {
+      // the number of entries is not stored, count the decoded columns
+      std::int64_t n = 0, c = 0;
+      for (std::int64_t i = A.Mt.row_ptr[col], end = A.Mt.row_ptr[col + 1]; i < end; n++)
+      {
+         c = cbcsr_next_col(A.Mt.deltas, i, c);
+      }
+      out(col) = n;
+   }
+   return out;
+}
+
+Eigen::VectorXd smurff::linop::col_square_sum(BitPackedFeat & A) 
+{
+   const int ncol = A.cols();
+   VectorXd out(ncol);
+   #pragma omp parallel for schedule(static)
+   for (int col = 0; col < ncol; col++)
+   {
+      const std::uint64_t* bits = A.col(col);
+      int count = 0;
+      for (int w = 0; w < A.col_words; w++)
+      {
+         count += popcount64(bits[w]);
+      }
+      out(col) = count;
+   }
+   return out;
+}
+
 Eigen::VectorXd smurff::linop::col_square_sum(Eigen::MatrixXd & A) 
 {
    const int ncol = A.cols();
@@ -457,3 +1148,15 @@ Eigen::VectorXd smurff::linop::col_square_sum(Eigen::MatrixXd & A)
    return out;
 }
 
+Eigen::VectorXd smurff::linop::col_square_sum(Eigen::MatrixXf & A) 
+{
+   const int ncol = A.cols();
+   VectorXd out(ncol);
+   #pragma omp parallel for schedule(static)
+   for (int col = 0; col < ncol; col++) 
+   {
+      out(col) = A.col(col).cast<double>().squaredNorm();
+   }
+   return out;
+}
+
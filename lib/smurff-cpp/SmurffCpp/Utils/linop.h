@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 
 #include <SmurffCpp/Utils/chol.h>
 #include <SmurffCpp/Utils/MatrixUtils.h>
@@ -8,8 +9,15 @@
 
 #include <SmurffCpp/SideInfo/SparseFeat.h>
 #include <SmurffCpp/SideInfo/SparseDoubleFeat.h>
+#include <SmurffCpp/SideInfo/CompressedSparseFeat.h>
+#include <SmurffCpp/SideInfo/BitPackedFeat.h>
 
-namespace smurff { namespace linop {
+namespace smurff {
+
+class CompositeSideInfo;
+class MPIRowSideInfo; // SmurffMPI
+
+namespace linop {
 
 template<typename T>
 void  solve_blockcg(Eigen::MatrixXd & X, T & t, double reg, Eigen::MatrixXd & B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false);
@@ -18,11 +26,29 @@ int  solve_blockcg(Eigen::MatrixXd & X, T & t, double reg, Eigen::MatrixXd & B,
 
 void At_mul_A(Eigen::MatrixXd & out, SparseFeat & A);
 void At_mul_A(Eigen::MatrixXd & out, SparseDoubleFeat & A);
+void At_mul_A(Eigen::MatrixXd & out, CompressedSparseFeat & A);
+void At_mul_A(Eigen::MatrixXd & out, BitPackedFeat & A);
 void At_mul_A(Eigen::MatrixXd & out, Eigen::MatrixXd & A);
+void At_mul_A(Eigen::MatrixXd & out, Eigen::MatrixXf & A);
+
+// sparse lower triangle of A'A
+void At_mul_A(Eigen::SparseMatrix<double> & out, SparseFeat & A);
+void At_mul_A(Eigen::SparseMatrix<double> & out, SparseDoubleFeat & A);
+void At_mul_A(Eigen::SparseMatrix<double> & out, CompressedSparseFeat & A);
+void At_mul_A(Eigen::SparseMatrix<double> & out, BitPackedFeat & A);
+
+// greedy coloring of the columns of A, columns of one color have no row in common
+void color_cols(std::vector<std::vector<int> > & colors, SparseFeat & A);
+void color_cols(std::vector<std::vector<int> > & colors, SparseDoubleFeat & A);
+void color_cols(std::vector<std::vector<int> > & colors, CompressedSparseFeat & A);
+void color_cols(std::vector<std::vector<int> > & colors, BitPackedFeat & A);
 
 Eigen::VectorXd col_square_sum(SparseFeat & A);
 Eigen::VectorXd col_square_sum(SparseDoubleFeat & A);
+Eigen::VectorXd col_square_sum(CompressedSparseFeat & A);
+Eigen::VectorXd col_square_sum(BitPackedFeat & A);
 Eigen::VectorXd col_square_sum(Eigen::MatrixXd & A);
+Eigen::VectorXd col_square_sum(Eigen::MatrixXf & A);
 
 template<typename T>
 void compute_uhat(Eigen::MatrixXd & uhat, T & feat, Eigen::MatrixXd & beta);
@@ -35,23 +61,125 @@ void AtA_mul_B(Eigen::MatrixXd & out, SparseFeat & A, double reg, Eigen::MatrixX
 template<>
 void AtA_mul_B(Eigen::MatrixXd & out, SparseDoubleFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
 
+template<>
+void AtA_mul_B(Eigen::MatrixXd & out, CompressedSparseFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
+
 template<>
 void AtA_mul_B(Eigen::MatrixXd & out, Eigen::MatrixXd & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
 
 // compile-time optimized versions (N - number of RHSs)
+// decodes the column deltas on the fly, see CompressedBinaryCSR
+template<int N>
+void A_mul_Bx(Eigen::MatrixXd & out, CompressedBinaryCSR & A, Eigen::MatrixXd & B) {
+   THROWERROR_ASSERT(N == out.rows());
+   THROWERROR_ASSERT(N == B.rows());
+   THROWERROR_ASSERT(A.ncol == B.cols());
+   THROWERROR_ASSERT(A.nrow == out.cols());
+
+  const std::int64_t* row_ptr = A.row_ptr;
+  const std::uint16_t* deltas = A.deltas;
+  const std::int64_t nrow     = A.nrow;
+  double* Y = out.data();
+  double* X = B.data();
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (std::int64_t row = 0; row < nrow; row++) 
+  {
+    double tmp[N] = { 0 };
+    const std::int64_t end = row_ptr[row + 1];
+    std::int64_t c = 0;
+    for (std::int64_t i = row_ptr[row]; i < end; ) 
+    {
+      c = cbcsr_next_col(deltas, i, c);
+      const std::int64_t col = c * N;
+      for (int j = 0; j < N; j++) 
+      {
+         tmp[j] += X[col + j];
+      }
+    }
+    const std::int64_t r = row * N;
+    for (int j = 0; j < N; j++) 
+    {
+      Y[r + j] = tmp[j];
+    }
+  }
+}
+
+// tmp += sum of the N-wide rows of X selected by the set bits
+template<int N>
+inline void bits_add_rows(double* tmp, const std::uint64_t* bits, const int nwords, const double* X)
+{
+  for (int w = 0; w < nwords; w++) 
+  {
+    for (std::uint64_t word = bits[w]; word; word &= word - 1) 
+    {
+      const std::int64_t col = ((std::int64_t)w * 64 + lowest_bit64(word)) * N;
+      for (int j = 0; j < N; j++) 
+      {
+         tmp[j] += X[col + j];
+      }
+    }
+  }
+}
+
+// only the column bits are stored, so every thread sums the rows of one 64-bit word
+// over all columns and no two threads write the same row of out
+template<int N>
+void A_mul_Bx(Eigen::MatrixXd & out, BitPackedFeat & A, Eigen::MatrixXd & B) {
+   THROWERROR_ASSERT(N == out.rows());
+   THROWERROR_ASSERT(N == B.rows());
+   THROWERROR_ASSERT(A.ncol == B.cols());
+   THROWERROR_ASSERT(A.nrow == out.cols());
+
+  const int nrow = A.nrow;
+  const int ncol = A.ncol;
+  const int nwords = A.col_words;
+  double* Y = out.data();
+  double* X = B.data();
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (int w = 0; w < nwords; w++) 
+  {
+    double tmp[64 * N] = { 0 };
+    for (int col = 0; col < ncol; col++) 
+    {
+      const double* x = X + (std::int64_t)col * N;
+      for (std::uint64_t word = A.col(col)[w]; word; word &= word - 1) 
+      {
+        double* t = tmp + lowest_bit64(word) * N;
+        for (int j = 0; j < N; j++) 
+        {
+          t[j] += x[j];
+        }
+      }
+    }
+    const int nr = std::min(64, nrow - w * 64);
+    std::copy(tmp, tmp + nr * N, Y + (std::int64_t)w * 64 * N);
+  }
+}
+
 template<typename T>
 inline void AtA_mul_B_switch(Eigen::MatrixXd & out, T & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
 inline void AtA_mul_B_switch(Eigen::MatrixXd & out, Eigen::MatrixXd & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
+void AtA_mul_B_switch(Eigen::MatrixXd & out, Eigen::MatrixXf & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
+void AtA_mul_B_switch(Eigen::MatrixXd & out, CompositeSideInfo & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
+void AtA_mul_B_switch(Eigen::MatrixXd & out, MPIRowSideInfo & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
 
 template<int N>
 void AtA_mul_Bx(Eigen::MatrixXd & out, SparseFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
 template<int N>
 void AtA_mul_Bx(Eigen::MatrixXd & out, SparseDoubleFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
+template<int N>
+void AtA_mul_Bx(Eigen::MatrixXd & out, CompressedSparseFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
+template<int N>
+void AtA_mul_Bx(Eigen::MatrixXd & out, BitPackedFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp);
 
 template<int N>
 void A_mul_Bx(Eigen::MatrixXd & out, BinaryCSR & A, Eigen::MatrixXd & B);
 template<int N>
 void A_mul_Bx(Eigen::MatrixXd & out, CSR & A, Eigen::MatrixXd & B);
+template<int N>
+void A_mul_Bx(Eigen::MatrixXd & out, CompressedBinaryCSR & A, Eigen::MatrixXd & B);
+template<int N>
+void A_mul_Bx(Eigen::MatrixXd & out, BitPackedFeat & A, Eigen::MatrixXd & B);
 
 
 void At_mul_B_blas(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eigen::MatrixXd & B);
@@ -60,6 +188,11 @@ void A_mul_At_blas(Eigen::MatrixXd & A, double* AAt);
 void A_mul_B_blas(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eigen::MatrixXd & B);
 void A_mul_Bt_blas(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eigen::MatrixXd & B);
 
+// Y = A * B and Y = A * B' with B in single precision (sgemm), partial products
+// over blocks of the inner dimension are summed in double
+void A_mul_B_sgemm(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eigen::MatrixXf & B);
+void A_mul_Bt_sgemm(Eigen::MatrixXd & Y, Eigen::MatrixXd & A, Eigen::MatrixXf & B);
+
 inline void A_mul_B_omp(double alpha, Eigen::MatrixXd & out, double beta, Eigen::MatrixXd & A, Eigen::MatrixXd & B);
 
 void A_mul_At_combo(Eigen::MatrixXd & out, Eigen::MatrixXd & A);
@@ -72,12 +205,17 @@ void A_mul_B(  Eigen::VectorXd & out, BinaryCSR & csr, Eigen::VectorXd & b);
 void A_mul_Bt( Eigen::MatrixXd & out, BinaryCSR & csr, Eigen::MatrixXd & B);
 void A_mul_B(  Eigen::VectorXd & out, CSR & csr, Eigen::VectorXd & b);
 void A_mul_Bt( Eigen::MatrixXd & out, CSR & csr, Eigen::MatrixXd & B);
+void A_mul_Bt( Eigen::MatrixXd & out, CompressedBinaryCSR & csr, Eigen::MatrixXd & B);
+void A_mul_Bt( Eigen::MatrixXd & out, BitPackedFeat & A, Eigen::MatrixXd & B);
 void A_mul_B(  Eigen::VectorXd & out, Eigen::MatrixXd & m, Eigen::VectorXd & b);
 void A_mul_Bt( Eigen::MatrixXd & out, Eigen::MatrixXd & m, Eigen::MatrixXd & B);
 
 Eigen::MatrixXd A_mul_B(Eigen::MatrixXd & A, Eigen::MatrixXd & B);
+Eigen::MatrixXd A_mul_B(Eigen::MatrixXd & A, Eigen::MatrixXf & B);
 Eigen::MatrixXd A_mul_B(Eigen::MatrixXd & A, SparseFeat & B);
 Eigen::MatrixXd A_mul_B(Eigen::MatrixXd & A, SparseDoubleFeat & B);
+Eigen::MatrixXd A_mul_B(Eigen::MatrixXd & A, CompressedSparseFeat & B);
+Eigen::MatrixXd A_mul_B(Eigen::MatrixXd & A, BitPackedFeat & B);
 
 void makeSymmetric(Eigen::MatrixXd & A);
 
@@ -120,6 +258,45 @@ inline void At_mul_Bt(Eigen::VectorXd & Y, SparseDoubleFeat & X, const int col,
    }
 }
 
+// Y = X[:,col]' * B'
+inline void At_mul_Bt(Eigen::VectorXd & Y, CompressedSparseFeat & X, const int col, Eigen::MatrixXd & B) 
+{
+   const std::uint16_t* deltas = X.Mt.deltas;
+   const std::int64_t end      = X.Mt.row_ptr[col + 1];
+   const int D                 = Y.size();
+   Y.setZero();
+
+   std::int64_t c = 0;
+   for (std::int64_t i = X.Mt.row_ptr[col]; i < end; ) 
+   {
+      c = cbcsr_next_col(deltas, i, c);
+      for (int d = 0; d < D; d++) 
+      {
+         Y(d) += B(d, c);
+      }
+   }
+}
+
+// Y = X[:,col]' * B'
+inline void At_mul_Bt(Eigen::VectorXd & Y, BitPackedFeat & X, const int col, Eigen::MatrixXd & B) 
+{
+   const std::uint64_t* bits = X.col(col);
+   const int D               = Y.size();
+   Y.setZero();
+
+   for (int w = 0; w < X.col_words; w++) 
+   {
+      for (std::uint64_t word = bits[w]; word; word &= word - 1) 
+      {
+         const int c = w * 64 + lowest_bit64(word);
+         for (int d = 0; d < D; d++) 
+         {
+            Y(d) += B(d, c);
+         }
+      }
+   }
+}
+
 inline void At_mul_Bt(Eigen::VectorXd & Y, Eigen::MatrixXd & X, const int col, Eigen::MatrixXd & B) 
 {
    Y.setZero();
@@ -166,6 +343,43 @@ inline void add_Acol_mul_bt(Eigen::MatrixXd & Z, SparseDoubleFeat & A, const int
    }
 }
 
+// computes Z += A[:,col] * b', where a and b are vectors
+inline void add_Acol_mul_bt(Eigen::MatrixXd & Z, CompressedSparseFeat & A, const int col, Eigen::VectorXd & b) 
+{
+   const std::uint16_t* deltas = A.Mt.deltas;
+   const std::int64_t end      = A.Mt.row_ptr[col + 1];
+   const int D                 = b.size();
+
+   std::int64_t c = 0;
+   for (std::int64_t i = A.Mt.row_ptr[col]; i < end; ) 
+   {
+      c = cbcsr_next_col(deltas, i, c);
+      for (int d = 0; d < D; d++) 
+      {
+         Z(d, c) += b(d);
+      }
+   }
+}
+
+// computes Z += A[:,col] * b', where a and b are vectors
+inline void add_Acol_mul_bt(Eigen::MatrixXd & Z, BitPackedFeat & A, const int col, Eigen::VectorXd & b) 
+{
+   const std::uint64_t* bits = A.col(col);
+   const int D               = b.size();
+
+   for (int w = 0; w < A.col_words; w++) 
+   {
+      for (std::uint64_t word = bits[w]; word; word &= word - 1) 
+      {
+         const int c = w * 64 + lowest_bit64(word);
+         for (int d = 0; d < D; d++) 
+         {
+            Z(d, c) += b(d);
+         }
+      }
+   }
+}
+
 //
 // computes Z += A[:,col] * b', where a and b are vectors
 inline void add_Acol_mul_bt(Eigen::MatrixXd & Z, Eigen::MatrixXd & A, const int col, Eigen::VectorXd & b) 
@@ -176,6 +390,25 @@ inline void add_Acol_mul_bt(Eigen::MatrixXd & Z, Eigen::MatrixXd & A, const int
    }
 }
 
+inline void At_mul_Bt(Eigen::VectorXd & Y, Eigen::MatrixXf & X, const int col, Eigen::MatrixXd & B) 
+{
+   const Eigen::VectorXd x = X.col(col).cast<double>();
+   for (int row = 0; row < B.rows(); row++)
+   {
+      Y(row) = x.dot(B.row(row));
+   }
+}
+
+// computes Z += A[:,col] * b', where a and b are vectors
+inline void add_Acol_mul_bt(Eigen::MatrixXd & Z, Eigen::MatrixXf & A, const int col, Eigen::VectorXd & b) 
+{
+   const Eigen::VectorXd a = A.col(col).cast<double>();
+   for (int row = 0; row < b.size(); row++)
+   {
+      Z.row(row) += (a * b(row)).transpose();
+   }
+}
+
 ///////////////////////////////////
 //     Template functions
 ///////////////////////////////////
@@ -196,11 +429,23 @@ template<> inline void compute_uhat(Eigen::MatrixXd & uhat, SparseDoubleFeat & f
   A_mul_Bt(uhat, feat.M, beta);
 }
 
+template<> inline void compute_uhat(Eigen::MatrixXd & uhat, CompressedSparseFeat & feat, Eigen::MatrixXd & beta) {
+  A_mul_Bt(uhat, feat.M, beta);
+}
+
+template<> inline void compute_uhat(Eigen::MatrixXd & uhat, BitPackedFeat & feat, Eigen::MatrixXd & beta) {
+  A_mul_Bt(uhat, feat, beta);
+}
+
 /** computes uhat = denseFeat * beta, where beta and uhat are row ordered */
 template<> inline void compute_uhat(Eigen::MatrixXd & uhat, Eigen::MatrixXd & denseFeat, Eigen::MatrixXd & beta) {
   A_mul_Bt_blas(uhat, beta, denseFeat);
 }
 
+template<> inline void compute_uhat(Eigen::MatrixXd & uhat, Eigen::MatrixXf & denseFeat, Eigen::MatrixXd & beta) {
+  A_mul_Bt_sgemm(uhat, beta, denseFeat);
+}
+
 /** good values for solve_blockcg are blocksize=32 an excess=8 */
 template<typename T>
 inline void solve_blockcg(Eigen::MatrixXd & X, T & K, double reg, Eigen::MatrixXd & B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error) {
@@ -296,8 +541,8 @@ inline int solve_blockcg(Eigen::MatrixXd & X, T & K, double reg, Eigen::MatrixXd
     A_mul_Bt_omp_sym(PtKP, P, KP);
 
     auto chol_PtKP = PtKP.llt();
-    THROWERROR_ASSERT_MSG(!throw_on_cholesky_error || chol_PtKP.info() != Eigen::NumericalIssue, "Cholesky Decomposition failed! (Numerical Issue)");
-    THROWERROR_ASSERT_MSG(!throw_on_cholesky_error || chol_PtKP.info() != Eigen::InvalidInput, "Cholesky Decomposition failed! (Invalid Input)");
+    THROWERROR_SPEC_COND(smurff::solver_error, "Cholesky Decomposition failed! (Numerical Issue)", !throw_on_cholesky_error || chol_PtKP.info() != Eigen::NumericalIssue);
+    THROWERROR_SPEC_COND(smurff::solver_error, "Cholesky Decomposition failed! (Invalid Input)", !throw_on_cholesky_error || chol_PtKP.info() != Eigen::InvalidInput);
     A = chol_PtKP.solve(*RtR);
 
     A.transposeInPlace();
@@ -321,14 +566,16 @@ inline int solve_blockcg(Eigen::MatrixXd & X, T & K, double reg, Eigen::MatrixXd
     makeSymmetric(*RtR2);
 
     Eigen::VectorXd d = RtR2->diagonal();
+    // the block Krylov space can collapse before all residuals reach tol, after that R is garbage
+    THROWERROR_SPEC_COND(smurff::solver_error, "BlockCG broke down before reaching the tolerance", d.allFinite());
     //std::cout << "[ iter " << iter << "] " << d.cwiseSqrt() << "\n";
     if ( (d.array() < tolsq).all()) {
       break;
     }
     // Psi = (R R') \ R2 R2'
     auto chol_RtR = RtR->llt();
-    THROWERROR_ASSERT_MSG(!throw_on_cholesky_error || chol_RtR.info() != Eigen::NumericalIssue, "Cholesky Decomposition failed! (Numerical Issue)");
-    THROWERROR_ASSERT_MSG(!throw_on_cholesky_error || chol_RtR.info() != Eigen::InvalidInput, "Cholesky Decomposition failed! (Invalid Input)");
+    THROWERROR_SPEC_COND(smurff::solver_error, "Cholesky Decomposition failed! (Numerical Issue)", !throw_on_cholesky_error || chol_RtR.info() != Eigen::NumericalIssue);
+    THROWERROR_SPEC_COND(smurff::solver_error, "Cholesky Decomposition failed! (Invalid Input)", !throw_on_cholesky_error || chol_RtR.info() != Eigen::InvalidInput);
     Psi  = chol_RtR.solve(*RtR2);
     Psi.transposeInPlace();
     ////double t5 = tick();
@@ -574,6 +821,72 @@ void AtA_mul_Bx(Eigen::MatrixXd & out, SparseDoubleFeat & A, double reg, Eigen::
   }
 }
 
+template<int N>
+void AtA_mul_Bx(Eigen::MatrixXd & out, CompressedSparseFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & inner) {
+   THROWERROR_ASSERT(N == out.rows());
+   THROWERROR_ASSERT(N == B.rows());
+   THROWERROR_ASSERT(A.cols() == B.cols());
+   THROWERROR_ASSERT(A.cols() == out.cols());
+   THROWERROR_ASSERT(A.rows() == inner.cols());
+
+  A_mul_Bx<N>(inner, A.M,  B);
+
+  const std::int64_t* row_ptr = A.Mt.row_ptr;
+  const std::uint16_t* deltas = A.Mt.deltas;
+  const std::int64_t nrow     = A.Mt.nrow;
+  double* Y      = out.data();
+  double* X      = inner.data();
+  double* Braw   = B.data();
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (std::int64_t row = 0; row < nrow; row++) 
+  {
+    double tmp[N] = { 0 };
+    const std::int64_t end = row_ptr[row + 1];
+    std::int64_t c = 0;
+    for (std::int64_t i = row_ptr[row]; i < end; ) 
+    {
+      c = cbcsr_next_col(deltas, i, c);
+      const std::int64_t col = c * N;
+      for (int j = 0; j < N; j++) 
+      {
+         tmp[j] += X[col + j];
+      }
+    }
+    const std::int64_t r = row * N;
+    for (int j = 0; j < N; j++) 
+    {
+      Y[r + j] = tmp[j] + reg * Braw[r + j];
+    }
+  }
+}
+
+template<int N>
+void AtA_mul_Bx(Eigen::MatrixXd & out, BitPackedFeat & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & inner) {
+   THROWERROR_ASSERT(N == out.rows());
+   THROWERROR_ASSERT(N == B.rows());
+   THROWERROR_ASSERT(A.cols() == B.cols());
+   THROWERROR_ASSERT(A.cols() == out.cols());
+   THROWERROR_ASSERT(A.rows() == inner.cols());
+
+  A_mul_Bx<N>(inner, A, B);
+
+  const int ncol = A.ncol;
+  double* Y      = out.data();
+  double* X      = inner.data();
+  double* Braw   = B.data();
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (int col = 0; col < ncol; col++) 
+  {
+    double tmp[N] = { 0 };
+    bits_add_rows<N>(tmp, A.col(col), A.col_words, X);
+    const std::int64_t r = (std::int64_t)col * N;
+    for (int j = 0; j < N; j++) 
+    {
+      Y[r + j] = tmp[j] + reg * Braw[r + j];
+    }
+  }
+}
+
 // computes out = alpha * out + beta * A * B
 inline void A_mul_B_omp(
     double alpha,
@@ -1,6 +1,7 @@
 #include "MPIMacauPrior.h"
 
 #include <SmurffCpp/Utils/Distribution.h>
+#include <SmurffCpp/Utils/Error.h>
 
 using namespace smurff;
 
@@ -17,6 +18,9 @@ MPIMacauPrior::~MPIMacauPrior()
 
 void MPIMacauPrior::init()
 {
+   // beta is always sampled with BlockCG, F'F would not be used
+   use_FtF = false;
+
    MacauPrior::init();
 
    rhs_for_rank = new int[world_size];
@@ -38,13 +42,31 @@ std::ostream& MPIMacauPrior::info(std::ostream &os, std::string indent)
 {
    if (world_rank == 0) {
       MacauPrior::info(os, indent);
-      os << indent << " MPI version with " << world_size << " ranks\n";
+      os << indent << " MPI version with " << world_size << " ranks";
+      if (partition_rows)
+         os << ", side info rows partitioned";
+      os << "\n";
    }
    return os;
 }
 
+void MPIMacauPrior::announce_update()
+{
+   int mode = m_mode;
+   MPI_Bcast(&mode, 1, MPI_INT, 0, MPI_COMM_WORLD);
+}
+
 void MPIMacauPrior::sample_beta()
 {
+   if (world_rank == 0)
+      announce_update();
+
+   if (partition_rows)
+   {
+      sample_beta_partitioned();
+      return;
+   }
+
    const int num_latent = this->beta.rows();
    const int num_feat = this->beta.cols();
 
@@ -87,9 +109,38 @@ void MPIMacauPrior::sample_beta()
    }
 }
 
+void MPIMacauPrior::sample_beta_partitioned()
+{
+   // Ft_y and the CG matvecs are summed over the row slices of all ranks (collective linops)
+   this->compute_Ft_y_omp(this->Ft_y);
+   this->Features->solve_blockcg(this->beta, this->beta_precision, this->Ft_y, this->tol, this->cg_blocksize, this->cg_excess, this->throw_on_cholesky_error);
+}
+
+std::function<void()> MPIMacauPrior::start_update_prior()
+{
+   update_prior();
+   return std::function<void()>();
+}
+
+void MPIMacauPrior::prune_latents(const std::vector<int>& keep)
+{
+   THROWERROR_NOTIMPL_MSG("Pruning latent dimentions is not supported by the MPI prior");
+}
+
 bool MPIMacauPrior::run_slave()
 {
-   sample_beta();
+   if (partition_rows)
+   {
+      // the same collective linops as rank 0 in sample_beta_partitioned and update_prior
+      Eigen::MatrixXd none;
+      this->Features->A_mul_B(none);
+      this->Features->solve_blockcg(this->beta, this->beta_precision, none, this->tol, this->cg_blocksize, this->cg_excess);
+      this->Features->compute_uhat(this->Uhat, this->beta);
+   }
+   else
+   {
+      sample_beta();
+   }
    return true;
 }
 
@@ -21,6 +21,10 @@ public:
    int world_rank;
    int world_size;
 
+   // Features is an MPIRowSideInfo: every rank holds a slice of the rows
+   // and all ranks solve for all latent dimensions together
+   bool partition_rows = false;
+
 private:
    int* rhs_for_rank = NULL;
    double* rec     = NULL;
@@ -39,11 +43,24 @@ public:
        
    void sample_beta() override;
 
+   // sample_beta communicates with the other ranks, so it cannot be pipelined
+   std::function<void()> start_update_prior() override;
+
+   // the work split over the ranks depends on num_latent
+   void prune_latents(const std::vector<int>& keep) override;
+
+   // one beta update on a rank other than 0, see MPISession::run
    bool run_slave() override;
 
    int rhs() const;
 
    void split_work_mpi(int num_latent, int num_nodes, int* work);
+
+private:
+   // tells the other ranks that this prior starts a beta update
+   void announce_update();
+
+   void sample_beta_partitioned();
 };
 
 }
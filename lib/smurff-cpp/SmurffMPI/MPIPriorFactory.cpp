@@ -2,16 +2,52 @@
 
 #include <SmurffCpp/Configs/Config.h>
 #include <SmurffCpp/Priors/ILatentPrior.h>
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/MatrixUtils.h>
 #include <SmurffMPI/MPIPriorFactory.h>
 #include <SmurffMPI/MPIMacauPrior.h>
+#include <SmurffMPI/MPIRowSideInfo.h>
 
 using namespace smurff;
 
+std::shared_ptr<ISideInfo> MPIPriorFactory::create_side_info(std::shared_ptr<SideInfoConfig> item, int mode)
+{
+   if (!item->getPartitionRows())
+      return PriorFactory::create_side_info(item, mode);
+
+   int world_rank, world_size;
+   MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+   MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+   const int nrow = item->getNRow();
+   THROWERROR_ASSERT_MSG(nrow >= world_size, "Row-partitioned side info needs at least one row per rank");
+
+   int begin, end;
+   MPIRowSideInfo::row_range(nrow, world_rank, world_size, begin, end);
+
+   // side info restored from a file only has the rows of this rank already,
+   // a matrix set in the config is sliced here
+   if (!item->isRowSlice())
+      item->setSideInfoRows(matrix_utils::row_slice(*item->getSideInfo(), begin, end), begin, nrow);
+
+   THROWERROR_ASSERT_MSG(item->getRowBegin() == (std::uint64_t)begin && item->getSideInfo()->getNRow() == (std::uint64_t)(end - begin),
+                         "Side info slice does not match the rows of this rank");
+
+   auto local = PriorFactory::create_side_info(item, mode);
+   return std::make_shared<MPIRowSideInfo>(local, nrow);
+}
+
 std::shared_ptr<ILatentPrior> MPIPriorFactory::create_macau_prior(std::shared_ptr<Session> session, PriorTypes prior_type, 
                                                                   const std::vector<std::shared_ptr<ISideInfo> >& side_infos,
                                                                   const std::vector<std::shared_ptr<SideInfoConfig> >& config_items)
 {
-   return PriorFactory::create_macau_prior<MPIMacauPrior>(session, side_infos, config_items);
+   // MPIMacauPrior always samples beta with BlockCG split over the ranks, there is no solver to choose
+   THROWERROR_ASSERT_MSG(!config_items.front()->getAutotune(), "Autotuning the beta solver is not supported with MPI");
+
+   auto prior = PriorFactory::create_macau_prior<MPIMacauPrior>(session, side_infos, config_items);
+   std::dynamic_pointer_cast<MacauPrior>(prior)->projection_rank = config_items.front()->getProjectionRank();
+   std::dynamic_pointer_cast<MPIMacauPrior>(prior)->partition_rows = config_items.front()->getPartitionRows();
+   return prior;
 }
 
 std::shared_ptr<ILatentPrior> MPIPriorFactory::create_prior(std::shared_ptr<Session> session, int mode)
@@ -12,6 +12,9 @@ namespace smurff {
    class MPIPriorFactory : public PriorFactory
    {
    public:
+      // with partition_rows, only the rows of this rank are kept, wrapped in an MPIRowSideInfo
+      std::shared_ptr<ISideInfo> create_side_info(std::shared_ptr<SideInfoConfig> item, int mode) override;
+
       std::shared_ptr<ILatentPrior> create_macau_prior(std::shared_ptr<Session> session, PriorTypes prior_type,
                                                        const std::vector<std::shared_ptr<ISideInfo> >& side_infos,
                                                        const std::vector<std::shared_ptr<SideInfoConfig> >& config_items);
@@ -0,0 +1,193 @@
+#include "MPIRowSideInfo.h"
+
+#include <SmurffCpp/Utils/linop.h>
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Configs/SideInfoConfig.h>
+
+using namespace smurff;
+
+MPIRowSideInfo::MPIRowSideInfo(std::shared_ptr<ISideInfo> local, int rows)
+   : m_local(local), m_rows(rows)
+{
+   MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+   MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+   for (int r = 0; r < world_size; r++)
+   {
+      int begin, end;
+      row_range(m_rows, r, world_size, begin, end);
+      m_counts.push_back(end - begin);
+      m_displs.push_back(begin);
+   }
+
+   THROWERROR_ASSERT_MSG(m_local->rows() == m_counts[world_rank], "Side info slice does not match the rows of this rank");
+}
+
+void MPIRowSideInfo::row_range(int rows, int rank, int size, int& begin, int& end)
+{
+   begin = (int)((std::int64_t)rows * rank / size);
+   end = (int)((std::int64_t)rows * (rank + 1) / size);
+}
+
+void MPIRowSideInfo::restore_own_rows()
+{
+   int rank, size;
+   MPI_Comm_size(MPI_COMM_WORLD, &size);
+   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+   SideInfoConfig::setRowRange([rank, size](std::uint64_t nrow, std::uint64_t& begin, std::uint64_t& end)
+   {
+      int b, e;
+      row_range(nrow, rank, size, b, e);
+      begin = b;
+      end = e;
+   });
+}
+
+int MPIRowSideInfo::cols() const
+{
+   return m_local->cols();
+}
+
+int MPIRowSideInfo::rows() const
+{
+   return m_rows;
+}
+
+std::ostream& MPIRowSideInfo::print(std::ostream &os) const
+{
+   os << "MPI rows [" << m_rows << ", " << cols() << "] over " << world_size << " ranks, rank " << world_rank << ": ";
+   return m_local->print(os);
+}
+
+bool MPIRowSideInfo::is_dense() const
+{
+   return m_local->is_dense();
+}
+
+void MPIRowSideInfo::compute_uhat(Eigen::MatrixXd& uhat, Eigen::MatrixXd& beta)
+{
+   int dims[2] = { (int)beta.rows(), (int)beta.cols() };
+   MPI_Bcast(dims, 2, MPI_INT, 0, MPI_COMM_WORLD);
+   if (world_rank != 0)
+      beta.resize(dims[0], dims[1]);
+   MPI_Bcast(beta.data(), dims[0] * dims[1], MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+   Eigen::MatrixXd local(dims[0], m_local->rows());
+   m_local->compute_uhat(local, beta);
+
+   // uhat is column-major, the columns of a rank are contiguous
+   std::vector<int> counts(world_size), displs(world_size);
+   for (int r = 0; r < world_size; r++)
+   {
+      counts[r] = m_counts[r] * dims[0];
+      displs[r] = m_displs[r] * dims[0];
+   }
+
+   if (world_rank == 0)
+      THROWERROR_ASSERT(uhat.rows() == dims[0] && uhat.cols() == m_rows);
+
+   MPI_Gatherv(local.data(), local.size(), MPI_DOUBLE, uhat.data(), counts.data(), displs.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+}
+
+void MPIRowSideInfo::At_mul_A(Eigen::MatrixXd& out)
+{
+   Eigen::MatrixXd partial(cols(), cols());
+   m_local->At_mul_A(partial);
+   MPI_Reduce(partial.data(), out.data(), partial.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+}
+
+Eigen::MatrixXd MPIRowSideInfo::A_mul_B(Eigen::MatrixXd& A)
+{
+   int nrow = A.rows();
+   MPI_Bcast(&nrow, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+   if (world_rank == 0)
+      THROWERROR_ASSERT(A.cols() == m_rows);
+
+   std::vector<int> counts(world_size), displs(world_size);
+   for (int r = 0; r < world_size; r++)
+   {
+      counts[r] = m_counts[r] * nrow;
+      displs[r] = m_displs[r] * nrow;
+   }
+
+   Eigen::MatrixXd local(nrow, m_local->rows());
+   MPI_Scatterv(A.data(), counts.data(), displs.data(), MPI_DOUBLE, local.data(), local.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+   Eigen::MatrixXd partial = m_local->A_mul_B(local);
+   Eigen::MatrixXd out(nrow, cols());
+   MPI_Reduce(partial.data(), out.data(), partial.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+   return out;
+}
+
+void MPIRowSideInfo::solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error)
+{
+   // only rank 0 iterates, so the ranks can not disagree on convergence
+   if (world_rank == 0)
+   {
+      smurff::linop::solve_blockcg(X, *this, reg, B, tol, blocksize, excess, throw_on_cholesky_error);
+
+      int done = 0;
+      MPI_Bcast(&done, 1, MPI_INT, 0, MPI_COMM_WORLD);
+   }
+   else
+   {
+      Eigen::MatrixXd P, out;
+      while (true)
+      {
+         int nrhs;
+         MPI_Bcast(&nrhs, 1, MPI_INT, 0, MPI_COMM_WORLD);
+         if (nrhs == 0)
+            break;
+
+         P.resize(nrhs, cols());
+         reduce_AtA_mul_B(out, P);
+      }
+   }
+}
+
+void MPIRowSideInfo::AtA_mul_B(Eigen::MatrixXd& out, double reg, Eigen::MatrixXd& B, Eigen::MatrixXd& tmp)
+{
+   int nrhs = B.rows();
+   MPI_Bcast(&nrhs, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+   reduce_AtA_mul_B(out, B);
+   out += reg * B;
+}
+
+void MPIRowSideInfo::reduce_AtA_mul_B(Eigen::MatrixXd& out, Eigen::MatrixXd& B)
+{
+   MPI_Bcast(B.data(), B.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+   // tmp = B * F_r', partial = tmp * F_r
+   Eigen::MatrixXd tmp(B.rows(), m_local->rows());
+   m_local->compute_uhat(tmp, B);
+   Eigen::MatrixXd partial = m_local->A_mul_B(tmp);
+
+   if (world_rank == 0)
+      out.resize(B.rows(), cols());
+
+   MPI_Reduce(partial.data(), out.data(), partial.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+}
+
+// row-partitioned matvec for solve_blockcg
+void smurff::linop::AtA_mul_B_switch(Eigen::MatrixXd & out, MPIRowSideInfo & A, double reg, Eigen::MatrixXd & B, Eigen::MatrixXd & tmp)
+{
+   A.AtA_mul_B(out, reg, B, tmp);
+}
+
+Eigen::VectorXd MPIRowSideInfo::col_square_sum()
+{
+   THROWERROR_NOTIMPL_MSG("Row-partitioned side info is only supported by the macau prior");
+}
+
+void MPIRowSideInfo::At_mul_Bt(Eigen::VectorXd& Y, const int col, Eigen::MatrixXd& B)
+{
+   THROWERROR_NOTIMPL_MSG("Row-partitioned side info is only supported by the macau prior");
+}
+
+void MPIRowSideInfo::add_Acol_mul_bt(Eigen::MatrixXd& Z, const int col, Eigen::VectorXd& b)
+{
+   THROWERROR_NOTIMPL_MSG("Row-partitioned side info is only supported by the macau prior");
+}
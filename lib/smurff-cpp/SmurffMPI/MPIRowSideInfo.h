@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <mpi.h>
+
+#include <SmurffCpp/SideInfo/ISideInfo.h>
+
+namespace smurff {
+
+// side info split by rows over the MPI ranks, every rank only holds its own rows F_r
+// F'F and F'Y are sums over the ranks
+// the linops are collective: rank 0 drives them, the other ranks have to call the same
+// linops in the same order (see MPIMacauPrior::run_slave), their arguments are ignored
+class MPIRowSideInfo : public ISideInfo
+{
+private:
+   std::shared_ptr<ISideInfo> m_local; // rows of F owned by this rank
+   int m_rows;                         // rows of the full F
+   int world_rank;
+   int world_size;
+   std::vector<int> m_counts;          // rows per rank
+   std::vector<int> m_displs;          // first row of each rank
+
+public:
+   MPIRowSideInfo(std::shared_ptr<ISideInfo> local, int rows);
+
+   // rows [begin, end) of <rank> when <rows> rows are split over <size> ranks
+   static void row_range(int rows, int rank, int size, int& begin, int& end);
+
+   // restoring a config from a file then only reads the rows of this rank of row-partitioned side info
+   static void restore_own_rows();
+
+public:
+   int cols() const override;
+
+   int rows() const override;
+
+public:
+   std::ostream& print(std::ostream &os) const override;
+
+   bool is_dense() const override;
+
+public:
+   //linop
+
+   // uhat = beta * F', beta is sent from rank 0, uhat is gathered on rank 0
+   void compute_uhat(Eigen::MatrixXd& uhat, Eigen::MatrixXd& beta) override;
+
+   void At_mul_A(Eigen::MatrixXd& out) override;
+
+   // A * F, the columns of A are scattered from rank 0, the result is summed on rank 0
+   Eigen::MatrixXd A_mul_B(Eigen::MatrixXd& A) override;
+
+   // rank 0 runs the BlockCG iteration, the other ranks serve the matvecs until it is done
+   void solve_blockcg(Eigen::MatrixXd& X, double reg, Eigen::MatrixXd& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) override;
+
+   Eigen::VectorXd col_square_sum() override;
+
+   void At_mul_Bt(Eigen::VectorXd& Y, const int col, Eigen::MatrixXd& B) override;
+
+   void add_Acol_mul_bt(Eigen::MatrixXd& Z, const int col, Eigen::VectorXd& b) override;
+
+   // out = B * F'F + reg * B, the CG matvec, only called on rank 0
+   void AtA_mul_B(Eigen::MatrixXd& out, double reg, Eigen::MatrixXd& B, Eigen::MatrixXd& tmp);
+
+private:
+   // B * F_r'F_r summed over the ranks into out on rank 0
+   void reduce_AtA_mul_B(Eigen::MatrixXd& out, Eigen::MatrixXd& B);
+};
+
+}
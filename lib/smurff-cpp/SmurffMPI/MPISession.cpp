@@ -2,40 +2,271 @@
 
 #include "MPISession.h"
 #include "MPIPriorFactory.h"
+#include "MPIRowSideInfo.h"
 
+#include <algorithm>
+#include <chrono>
+
+#include <SmurffCpp/Model.h>
+#include <SmurffCpp/Configs/MatrixConfig.h>
+#include <SmurffCpp/DataMatrices/Data.h>
 #include <SmurffCpp/Priors/ILatentPrior.h>
 
+#include <SmurffCpp/Utils/Distribution.h>
 #include <SmurffCpp/Utils/Error.h>
 
 using namespace smurff;
 
+namespace {
+
+// sends an array of rank 0 to the other ranks
+void bcast_from_root(double* data, std::size_t size)
+{
+   MPI_Bcast(data, size, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+}
+
+// the entries of train in which the coordinate of some mode m lies in [begin[m], end[m])
+std::shared_ptr<TensorConfig> own_entries(const TensorConfig& train, const std::vector<int>& begin, const std::vector<int>& end)
+{
+   const std::uint64_t nnz = train.getNNZ();
+   const std::uint64_t nmodes = train.getNModes();
+   const std::vector<std::uint32_t>& columns = train.getColumns();
+
+   std::vector<std::uint64_t> keep;
+   for (std::uint64_t i = 0; i < nnz; i++)
+   {
+      for (std::uint64_t m = 0; m < nmodes; m++)
+      {
+         const int c = columns[m * nnz + i];
+         if (c >= begin[m] && c < end[m])
+         {
+            keep.push_back(i);
+            break;
+         }
+      }
+   }
+
+   std::vector<std::uint32_t> ownColumns(keep.size() * nmodes);
+   for (std::uint64_t m = 0; m < nmodes; m++)
+      for (std::size_t k = 0; k < keep.size(); k++)
+         ownColumns[m * keep.size() + k] = columns[m * nnz + keep[k]];
+
+   std::vector<double> ownValues;
+   if (!train.isBinary())
+   {
+      ownValues.reserve(keep.size());
+      for (std::uint64_t i : keep)
+         ownValues.push_back(train.getValues()[i]);
+   }
+
+   const std::vector<std::uint64_t>& dims = train.getDims();
+   if (nmodes == 2 && train.isBinary())
+      return std::make_shared<MatrixConfig>(dims[0], dims[1], std::move(ownColumns), train.getNoiseConfig(), train.isScarce());
+   if (nmodes == 2)
+      return std::make_shared<MatrixConfig>(dims[0], dims[1], std::move(ownColumns), std::move(ownValues), train.getNoiseConfig(), train.isScarce());
+   if (train.isBinary())
+      return std::make_shared<TensorConfig>(dims, ownColumns, train.getNoiseConfig(), train.isScarce());
+   return std::make_shared<TensorConfig>(dims, ownColumns, ownValues, train.getNoiseConfig(), train.isScarce());
+}
+
+}
+
 MPISession::MPISession()
 {
    name = "MPISession";
 
    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+   MPIRowSideInfo::restore_own_rows();
 }
 
-void MPISession::run()
+void MPISession::setCreateFromConfig(const Config& cfg)
 {
+   THROWERROR_ASSERT_MSG(cfg.getNumChains() == 1 && !cfg.getCVFolds(), "mpi_smurff samples a single chain");
+
+   // the other ranks only join the beta updates of an MPI macau prior from their loop in run,
+   // not the prior updates that init runs to start from a previous model or an als fit
+   const std::vector<PriorTypes>& priorTypes = cfg.getPriorTypes();
+   bool mpiMacau = !cfg.getDataParallel() && std::find(priorTypes.begin(), priorTypes.end(), PriorTypes::macau) != priorTypes.end();
+   THROWERROR_ASSERT_MSG(!mpiMacau || cfg.getWarmStart().empty(), "Warm start of a macau prior is only supported with --data-parallel in mpi_smurff");
+   THROWERROR_ASSERT_MSG(!mpiMacau || cfg.getModelInitType() != ModelInitTypes::als, "The als init of a macau prior is only supported with --data-parallel in mpi_smurff");
+
    if (world_rank == 0)
    {
+      Session::setCreateFromConfig(cfg);
+      return;
+   }
+
+   // only rank 0 reports and saves
+   Config slaveConfig = cfg;
+   slaveConfig.setVerbose(0);
+   slaveConfig.setCsvStatus(std::string());
+   slaveConfig.setSaveFreq(0);
+   slaveConfig.setCheckpointFreq(0);
+
+   // data-parallel: only keep the train entries that the columns sampled by this rank touch,
+   // dense train data and aux data are still held in full
+   if (cfg.getDataParallel() && !cfg.getTrain()->isDense() && cfg.getAuxData().empty())
+   {
+      std::shared_ptr<TensorConfig> train = cfg.getTrain();
+      std::vector<int> begin(train->getNModes()), end(train->getNModes());
+      for (std::uint64_t m = 0; m < train->getNModes(); m++)
+         MPIRowSideInfo::row_range(train->getDims()[m], world_rank, world_size, begin[m], end[m]);
+      slaveConfig.setTrain(own_entries(*train, begin, end));
+   }
+
+   Session::setCreateFromConfig(slaveConfig);
+}
+
+void MPISession::initRng()
+{
+   if (!m_config.getDataParallel())
+   {
+      Session::initRng();
+      return;
+   }
+
+   // rank 0 draws the prior and noise updates from the shared stream,
+   // all ranks derive their streams from its seed
+   int seed = m_config.getRandomSeed();
+   if (!m_config.getRandomSeedSet())
+      seed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+   MPI_Bcast(&seed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+   init_bmrng(seed);
+
+   // the latents of every rank are sampled from a stream of its own
+   init_private_bmrng(seed + (world_rank + 1) * 1000003);
+}
+
+void MPISession::init()
+{
+   Session::init();
+
+   if (!m_config.getDataParallel())
+      return;
+
+   // the other ranks start from the model, the hyperparameters and the noise of rank 0
+   for (std::uint64_t mode = 0; mode < model().nmodes(); mode++)
+   {
+      Eigen::MatrixXd& U = model().U(mode);
+      bcast_from_root(U.data(), U.size());
+   }
+
+   for (auto &p : m_priors)
+      p->for_each_hyper(bcast_from_root);
+
+   data().for_each_noise_param(bcast_from_root);
+}
+
+void MPISession::begin_sample_latents(int mode, int& begin, int& end)
+{
+   if (!m_config.getDataParallel())
+   {
+      Session::begin_sample_latents(mode, begin, end);
+      return;
+   }
+
+   MPIRowSideInfo::row_range(model().U(mode).cols(), world_rank, world_size, begin, end);
+   use_private_bmrng(true);
+}
+
+void MPISession::end_sample_latents(int mode, Eigen::VectorXd& Usum, Eigen::MatrixXd& UUsum)
+{
+   if (!m_config.getDataParallel())
+      return;
+
+   use_private_bmrng(false);
+
+   // columns are contiguous in U, so the slice of a rank is one block
+   Eigen::MatrixXd& U = model().U(mode);
+   int num_latent = U.rows();
+
+   std::vector<int> counts, displs;
+   for (int r = 0; r < world_size; r++)
+   {
+      int begin, end;
+      MPIRowSideInfo::row_range(U.cols(), r, world_size, begin, end);
+      counts.push_back((end - begin) * num_latent);
+      displs.push_back(begin * num_latent);
+   }
+
+   MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, U.data(), counts.data(), displs.data(), MPI_DOUBLE, MPI_COMM_WORLD);
+   MPI_Allreduce(MPI_IN_PLACE, Usum.data(), Usum.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   MPI_Allreduce(MPI_IN_PLACE, UUsum.data(), UUsum.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+}
+
+void MPISession::run()
+{
+   if (m_config.getDataParallel())
+   {
+      // every rank runs the whole sampler, only rank 0 reports and saves
       Session::run();
    }
+   else if (world_rank == 0)
+   {
+      Session::run();
+
+      int done = -1;
+      MPI_Bcast(&done, 1, MPI_INT, 0, MPI_COMM_WORLD);
+   }
    else
    {
-      bool work_done = false;
+      m_config.setVerbose(0);
+      m_config.setCsvStatus(std::string());
+      init();
 
-      for(auto &p : m_priors)
-         work_done |= p->run_slave();
+      // rank 0 sends the mode of every MPI prior that starts a beta update, -1 when done
+      while (true)
+      {
+         int mode;
+         MPI_Bcast(&mode, 1, MPI_INT, 0, MPI_COMM_WORLD);
+         if (mode < 0)
+            break;
 
-      THROWERROR_ASSERT(work_done);
+         bool work_done = m_priors.at(mode)->run_slave();
+         THROWERROR_ASSERT(work_done);
+      }
    }
 }
 
+void MPISession::update_prior(ILatentPrior& prior)
+{
+   if (!m_config.getDataParallel())
+   {
+      Session::update_prior(prior);
+      return;
+   }
+
+   // one update instead of one per rank, which would drift apart in the
+   // order of the OpenMP reductions
+   if (world_rank == 0)
+      prior.update_prior();
+
+   prior.for_each_hyper(bcast_from_root);
+}
+
+void MPISession::update_noise()
+{
+   if (!m_config.getDataParallel())
+   {
+      Session::update_noise();
+      return;
+   }
+
+   // rank 0 holds all train entries
+   if (world_rank == 0)
+      Session::update_noise();
+
+   data().for_each_noise_param(bcast_from_root);
+}
+
 std::shared_ptr<IPriorFactory> MPISession::create_prior_factory() const
 {
+   if (m_config.getDataParallel())
+      return Session::create_prior_factory();
+
    return std::make_shared<MPIPriorFactory>();
 }
 
@@ -46,4 +277,12 @@ std::shared_ptr<ISession> smurff::create_mpi_session(int argc, char** argv)
    std::shared_ptr<MPISession> session(new MPISession());
    session->setFromArgs(argc, argv);
    return session;
+}
+
+//for testing only
+std::shared_ptr<ISession> smurff::create_mpi_session(const Config& cfg)
+{
+   std::shared_ptr<MPISession> session(new MPISession());
+   session->setCreateFromConfig(cfg);
+   return session;
 }
\ No newline at end of file
@@ -9,6 +9,8 @@ namespace smurff {
 
 class MPISession : public CmdSession
 {
+   friend std::shared_ptr<ISession> create_mpi_session(const Config& cfg);
+
 public:
    int world_rank;
    int world_size;
@@ -16,12 +18,34 @@ public:
 public:
    MPISession();
 
+   void init() override;
+
    void run() override;
 
+protected:
+   void setCreateFromConfig(const Config& cfg) override;
+
+   void initRng() override;
+
+public:
+   // data-parallel: every rank samples its own slice of the columns and only holds the train
+   // entries these columns touch, the model is replicated on every rank
+   void begin_sample_latents(int mode, int& begin, int& end) override;
+
+   void end_sample_latents(int mode, Eigen::VectorXd& Usum, Eigen::MatrixXd& UUsum) override;
+
+   // data-parallel: rank 0 updates the hyperparameters and the noise, the other ranks receive them
+   void update_prior(ILatentPrior& prior) override;
+
+   void update_noise() override;
+
 public:
    std::shared_ptr<IPriorFactory> create_prior_factory() const override;
 };
 
 std::shared_ptr<ISession> create_mpi_session(int argc, char** argv);
 
+//for testing only
+std::shared_ptr<ISession> create_mpi_session(const Config& cfg);
+
 }
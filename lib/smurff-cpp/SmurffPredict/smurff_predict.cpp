@@ -0,0 +1,199 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_BOOST
+#include <boost/program_options.hpp>
+#endif
+
+#include <SmurffCpp/IO/MatrixIO.h>
+#include <SmurffCpp/Sessions/PredictSession.h>
+#include <SmurffCpp/Utils/Distribution.h>
+#include <SmurffCpp/Utils/omp_util.h>
+
+#define HELP_NAME "help"
+#define ROOT_NAME "root"
+#define SIDE_INFO_NAME "side-info"
+#define OBSERVATIONS_NAME "observations"
+#define FOLD_IN_ITERS_NAME "fold-in-iters"
+#define MODE_NAME "mode"
+#define TOPK_NAME "topk"
+#define OUT_NAME "out"
+#define NUM_THREADS_NAME "num-threads"
+#define SEED_NAME "seed"
+
+using namespace smurff;
+
+struct PredictOptions
+{
+   std::string root;
+   std::vector<std::string> side_info;
+   std::string observations;
+   int fold_in_iters = 10;
+   int mode = 0;
+   int topk = 0;
+   std::string out;
+   int num_threads = 0;
+   int seed = -1;
+};
+
+static bool parse_options(int argc, char** argv, PredictOptions& opts)
+{
+   #ifdef HAVE_BOOST
+   boost::program_options::options_description desc("smurff_predict: predictions for new rows of side info and/or observations");
+   desc.add_options()
+      (HELP_NAME, "show this help information")
+      (ROOT_NAME, boost::program_options::value<std::string>(), "root .ini file of a saved macau session")
+      (SIDE_INFO_NAME, boost::program_options::value<std::vector<std::string> >(), "side info of the new entities (.sdm, .sbm, .ddm, ...), repeat once per side info item of the mode")
+      (OBSERVATIONS_NAME, boost::program_options::value<std::string>(), "observations of the new entities against the other mode (.sdm, .mtx, ...), folds them in")
+      (FOLD_IN_ITERS_NAME, boost::program_options::value<int>()->default_value(10), "gibbs steps per saved sample when folding in with adaptive noise")
+      (MODE_NAME, boost::program_options::value<int>()->default_value(0), "mode of the new entities")
+      (TOPK_NAME, boost::program_options::value<int>()->default_value(0), "only output the k best matches of every new entity (0 = all predictions)")
+      (OUT_NAME, boost::program_options::value<std::string>(), "output .csv file (default: stdout)")
+      (NUM_THREADS_NAME, boost::program_options::value<int>()->default_value(0), "number of threads (0 = default by OpenMP)")
+      (SEED_NAME, boost::program_options::value<int>(), "random number generator seed for fold-in (default: time based)");
+
+   try
+   {
+      boost::program_options::variables_map vm;
+      boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+      boost::program_options::notify(vm);
+
+      if (vm.count(HELP_NAME) || !vm.count(ROOT_NAME) || (!vm.count(SIDE_INFO_NAME) && !vm.count(OBSERVATIONS_NAME)))
+      {
+         std::cerr << desc << std::endl;
+         return false;
+      }
+
+      opts.root = vm[ROOT_NAME].as<std::string>();
+      if (vm.count(SIDE_INFO_NAME))
+         opts.side_info = vm[SIDE_INFO_NAME].as<std::vector<std::string> >();
+      if (vm.count(OBSERVATIONS_NAME))
+         opts.observations = vm[OBSERVATIONS_NAME].as<std::string>();
+      opts.fold_in_iters = vm[FOLD_IN_ITERS_NAME].as<int>();
+      opts.mode = vm[MODE_NAME].as<int>();
+      opts.topk = vm[TOPK_NAME].as<int>();
+      opts.num_threads = vm[NUM_THREADS_NAME].as<int>();
+      if (vm.count(SEED_NAME))
+         opts.seed = vm[SEED_NAME].as<int>();
+      if (vm.count(OUT_NAME))
+         opts.out = vm[OUT_NAME].as<std::string>();
+   }
+   catch (boost::program_options::error& ex)
+   {
+      std::cerr << "Failed to parse command line arguments: " << std::endl;
+      std::cerr << ex.what() << std::endl;
+      return false;
+   }
+   #else
+   if (argc != 5 || std::string(argv[1]) != "--" ROOT_NAME || std::string(argv[3]) != "--" SIDE_INFO_NAME)
+   {
+      std::cerr << "Usage:\n\tsmurff_predict --root <root.ini> --side-info <side_info>\n\n(Limited smurff_predict compiled w/o boost program options)" << std::endl;
+      return false;
+   }
+
+   opts.root = argv[2];
+   opts.side_info.push_back(argv[4]);
+   #endif
+
+   return true;
+}
+
+static void write_predictions(std::ostream& os, const Eigen::MatrixXd& mean, const Eigen::MatrixXd& std)
+{
+   os << "new,other,pred_avg,std" << std::endl;
+   for (int i = 0; i < mean.rows(); i++)
+      for (int j = 0; j < mean.cols(); j++)
+         os << i << "," << j << "," << mean(i, j) << "," << std(i, j) << std::endl;
+}
+
+static void write_fold_in(std::ostream& os, const Eigen::MatrixXd& mean, const Eigen::MatrixXd& var)
+{
+   os << "new,other,pred_avg,var" << std::endl;
+   for (int i = 0; i < mean.rows(); i++)
+      for (int j = 0; j < mean.cols(); j++)
+         os << i << "," << j << "," << mean(i, j) << "," << var(i, j) << std::endl;
+}
+
+static void write_topk(std::ostream& os, const Eigen::MatrixXi& index, const Eigen::MatrixXd& score)
+{
+   os << "new,rank,other,pred_avg" << std::endl;
+   for (int i = 0; i < index.rows(); i++)
+      for (int r = 0; r < index.cols(); r++)
+         os << i << "," << r + 1 << "," << index(i, r) << "," << score(i, r) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+   PredictOptions opts;
+   if (!parse_options(argc, argv, opts))
+      return 1;
+
+   try
+   {
+      threads::init(0, opts.num_threads);
+
+      if (opts.seed >= 0)
+         init_bmrng(opts.seed);
+      else
+         init_bmrng();
+
+      PredictSession session(opts.root);
+      std::shared_ptr<ISideInfo> features;
+      if (!opts.side_info.empty())
+      {
+         std::vector<std::shared_ptr<MatrixConfig> > items;
+         for (const auto& file : opts.side_info)
+            items.push_back(matrix_io::read_matrix(file, false));
+         features = session.createSideInfo(opts.mode, items);
+      }
+
+      Eigen::MatrixXd mean, std, var;
+      if (opts.observations.empty())
+      {
+         session.predict(opts.mode, features, mean, std);
+      }
+      else
+      {
+         Eigen::SparseMatrix<double> observations;
+         matrix_io::eigen::read_matrix(opts.observations, observations);
+         session.foldIn(opts.mode, observations, features, opts.fold_in_iters, mean, var);
+      }
+
+      std::ofstream file;
+      if (!opts.out.empty())
+      {
+         file.open(opts.out);
+         if (!file)
+         {
+            std::cerr << "Could not open '" << opts.out << "' for writing" << std::endl;
+            return 1;
+         }
+      }
+      std::ostream& os = opts.out.empty() ? std::cout : file;
+
+      if (opts.topk > 0)
+      {
+         Eigen::MatrixXi index;
+         Eigen::MatrixXd score;
+         PredictSession::topK(mean, opts.topk, index, score);
+         write_topk(os, index, score);
+      }
+      else if (opts.observations.empty())
+      {
+         write_predictions(os, mean, std);
+      }
+      else
+      {
+         write_fold_in(os, mean, var);
+      }
+   }
+   catch (std::exception& ex)
+   {
+      std::cerr << ex.what() << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
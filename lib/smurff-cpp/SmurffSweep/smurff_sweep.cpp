@@ -0,0 +1,99 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef HAVE_BOOST
+#include <boost/program_options.hpp>
+#endif
+
+#include <SmurffCpp/Sessions/SweepSession.h>
+
+#define HELP_NAME "help"
+#define INI_NAME "ini"
+#define OUT_NAME "out"
+
+using namespace smurff;
+
+struct SweepOptions
+{
+   std::string ini;
+   std::string out;
+};
+
+static bool parse_options(int argc, char** argv, SweepOptions& opts)
+{
+   #ifdef HAVE_BOOST
+   boost::program_options::options_description desc("smurff_sweep: runs every combination of the options in the [sweep] section of an ini file");
+   desc.add_options()
+      (HELP_NAME, "show this help information")
+      (INI_NAME, boost::program_options::value<std::string>(), "ini file with the base config and a [sweep] section of comma separated values")
+      (OUT_NAME, boost::program_options::value<std::string>(), "output .csv file with one row per point (default: stdout)");
+
+   try
+   {
+      boost::program_options::variables_map vm;
+      boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+      boost::program_options::notify(vm);
+
+      if (vm.count(HELP_NAME) || !vm.count(INI_NAME))
+      {
+         std::cerr << desc << std::endl;
+         return false;
+      }
+
+      opts.ini = vm[INI_NAME].as<std::string>();
+      if (vm.count(OUT_NAME))
+         opts.out = vm[OUT_NAME].as<std::string>();
+   }
+   catch (boost::program_options::error& ex)
+   {
+      std::cerr << "Failed to parse command line arguments: " << std::endl;
+      std::cerr << ex.what() << std::endl;
+      return false;
+   }
+   #else
+   if (argc != 3 || std::string(argv[1]) != "--" INI_NAME)
+   {
+      std::cerr << "Usage:\n\tsmurff_sweep --ini <sweep.ini>\n\n(Limited smurff_sweep compiled w/o boost program options)" << std::endl;
+      return false;
+   }
+
+   opts.ini = argv[2];
+   #endif
+
+   return true;
+}
+
+int main(int argc, char** argv)
+{
+   SweepOptions opts;
+   if (!parse_options(argc, argv, opts))
+      return 1;
+
+   try
+   {
+      auto session = SweepSession::create_from_ini(opts.ini);
+
+      std::ofstream file;
+      if (!opts.out.empty())
+      {
+         file.open(opts.out);
+         if (!file)
+         {
+            std::cerr << "Could not open '" << opts.out << "' for writing" << std::endl;
+            return 1;
+         }
+      }
+      std::ostream& os = opts.out.empty() ? std::cout : file;
+
+      session->info(std::cerr, "");
+      session->run(os);
+   }
+   catch (std::exception& ex)
+   {
+      std::cerr << ex.what() << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
@@ -3,10 +3,21 @@
 #include <SmurffCpp/Utils/linop.h>
 #include <SmurffCpp/Utils/Distribution.h>
 
+#include <SmurffCpp/SideInfo/CompositeSideInfo.h>
+#include <SmurffCpp/SideInfo/SparseFeatSideInfo.h>
+#include <SmurffCpp/SideInfo/DenseDoubleFeatSideInfo.h>
+#include <SmurffCpp/SideInfo/DenseFloatFeatSideInfo.h>
+
 using namespace smurff;
 
 static NoiseConfig fixed_ncfg(NoiseTypes::fixed);
 
+// CompressedSparseFeat takes the uint32 indices of a MatrixConfig
+static std::vector<std::uint32_t> to_uint32(const int* idx, int n)
+{
+   return std::vector<std::uint32_t>(idx, idx + n);
+}
+
 TEST_CASE( "SparseFeat/At_mul_A_bcsr", "[At_mul_A] for BinaryCSR" ) 
 {
    int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
@@ -59,6 +70,108 @@ TEST_CASE( "SparseFeat/At_mul_A_csr", "[At_mul_A] for CSR" )
    REQUIRE( AA(3,2) == 0 );
 }
 
+TEST_CASE( "SparseFeat/At_mul_A_sparse", "sparse [At_mul_A] matches the dense one" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   double vals[9] = { 0.6 , -0.76,  1.48,  1.19,  2.44,  1.95, -0.82,  0.06,  2.54 };
+   SparseFeat sf(6, 4, 9, rows, cols);
+   SparseDoubleFeat sdf(6, 4, 9, rows, cols, vals);
+   CompressedSparseFeat csf(6, 4, 9, to_uint32(rows, 9).data(), to_uint32(cols, 9).data());
+ 
+   Eigen::MatrixXd AA(4, 4);
+   Eigen::SparseMatrix<double> SAA;
+ 
+   smurff::linop::At_mul_A(AA, sf);
+   smurff::linop::At_mul_A(SAA, sf);
+   REQUIRE( SAA.nonZeros() == 6 );
+   REQUIRE( (Eigen::MatrixXd(SAA) - Eigen::MatrixXd(AA.triangularView<Eigen::Lower>())).norm() == Approx(0) );
+ 
+   smurff::linop::At_mul_A(SAA, csf);
+   REQUIRE( (Eigen::MatrixXd(SAA) - Eigen::MatrixXd(AA.triangularView<Eigen::Lower>())).norm() == Approx(0) );
+ 
+   smurff::linop::At_mul_A(AA, sdf);
+   smurff::linop::At_mul_A(SAA, sdf);
+   REQUIRE( (Eigen::MatrixXd(SAA) - Eigen::MatrixXd(AA.triangularView<Eigen::Lower>())).norm() == Approx(0) );
+}
+
+TEST_CASE( "SparseFeat/At_mul_A_balanced", "[At_mul_A] over many balanced blocks with unsorted rows" ) 
+{
+   // entries in descending column order, with a few very frequent features
+   std::vector<int> rows, cols;
+   std::vector<double> vals;
+   for (int f = 149; f >= 0; f--) 
+   {
+      for (int r = 0; r < 200; r++) 
+      {
+         if (f < 3 || (r * 31 + f * 17) % 23 == 0) 
+         {
+            rows.push_back(r);
+            cols.push_back(f);
+            vals.push_back(0.01 * ((r + 3 * f) % 17) - 0.08);
+         }
+      }
+   }
+   const int nnz = rows.size();
+   SparseFeat sf(200, 150, nnz, rows.data(), cols.data());
+   SparseDoubleFeat sdf(200, 150, nnz, rows.data(), cols.data(), vals.data());
+   CompressedSparseFeat csf(200, 150, nnz, to_uint32(rows.data(), nnz).data(), to_uint32(cols.data(), nnz).data());
+
+   Eigen::MatrixXd F = Eigen::MatrixXd::Zero(200, 150), Fv = Eigen::MatrixXd::Zero(200, 150);
+   for (int i = 0; i < nnz; i++) 
+   {
+      F(rows[i], cols[i]) = 1.0;
+      Fv(rows[i], cols[i]) = vals[i];
+   }
+   Eigen::MatrixXd FtF_true = F.transpose() * F;
+   Eigen::MatrixXd FvtFv_true = Fv.transpose() * Fv;
+   auto lower = [](const Eigen::MatrixXd & m) { return Eigen::MatrixXd(m.triangularView<Eigen::Lower>()); };
+
+   Eigen::MatrixXd AA(150, 150);
+   Eigen::SparseMatrix<double> SAA;
+
+   smurff::linop::At_mul_A(AA, sf);
+   REQUIRE( (lower(AA) - lower(FtF_true)).norm() == Approx(0) );
+   smurff::linop::At_mul_A(SAA, sf);
+   REQUIRE( (Eigen::MatrixXd(SAA) - lower(FtF_true)).norm() == Approx(0) );
+
+   smurff::linop::At_mul_A(AA, csf);
+   REQUIRE( (lower(AA) - lower(FtF_true)).norm() == Approx(0) );
+   smurff::linop::At_mul_A(SAA, csf);
+   REQUIRE( (Eigen::MatrixXd(SAA) - lower(FtF_true)).norm() == Approx(0) );
+
+   smurff::linop::At_mul_A(AA, sdf);
+   REQUIRE( (lower(AA) - lower(FvtFv_true)).norm() == Approx(0) );
+   smurff::linop::At_mul_A(SAA, sdf);
+   REQUIRE( (Eigen::MatrixXd(SAA) - lower(FvtFv_true)).norm() == Approx(0) );
+
+   smurff::linop::At_mul_A(AA, Fv);
+   REQUIRE( (lower(AA) - lower(FvtFv_true)).norm() == Approx(0) );
+}
+
+TEST_CASE( "SparseFeat/color_cols", "columns of one color share no row" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   double vals[9] = { 0.6 , -0.76,  1.48,  1.19,  2.44,  1.95, -0.82,  0.06,  2.54 };
+   SparseFeat sf(6, 4, 9, rows, cols);
+   SparseDoubleFeat sdf(6, 4, 9, rows, cols, vals);
+   CompressedSparseFeat csf(6, 4, 9, to_uint32(rows, 9).data(), to_uint32(cols, 9).data());
+
+   // column 0 and 2 share rows 3 and 4, column 1 and 3 share row 2
+   std::vector<std::vector<int> > expected = { { 0, 1 }, { 2, 3 } };
+   std::vector<std::vector<int> > colors;
+
+   smurff::linop::color_cols(colors, sf);
+   REQUIRE( colors == expected );
+
+   smurff::linop::color_cols(colors, sdf);
+   REQUIRE( colors == expected );
+
+   smurff::linop::color_cols(colors, csf);
+   REQUIRE( colors == expected );
+}
+
 TEST_CASE( "linop/A_mul_Bx(csr)", "A_mul_Bx for CSR" ) 
 {
    int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
@@ -159,6 +272,303 @@ TEST_CASE( "SparseFeat/solve_blockcg_1_0", "BlockCG solver (3rhs separately)" )
    }
 }
 
+TEST_CASE( "CompressedSparseFeat/At_mul_A", "[At_mul_A] for CompressedBinaryCSR" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   SparseFeat sf(6, 4, 9, rows, cols);
+   CompressedSparseFeat csf(6, 4, 9, to_uint32(rows, 9).data(), to_uint32(cols, 9).data());
+ 
+   REQUIRE( csf.M.nrow == 6 );
+   REQUIRE( csf.M.ncol == 4 );
+   REQUIRE( csf.M.nwords == 9 );
+ 
+   Eigen::MatrixXd AA(4, 4), CAA(4, 4);
+   smurff::linop::At_mul_A(AA, sf);
+   smurff::linop::At_mul_A(CAA, csf);
+   REQUIRE( (AA - CAA).norm() == Approx(0) );
+   REQUIRE( (smurff::linop::col_square_sum(sf) - smurff::linop::col_square_sum(csf)).norm() == Approx(0) );
+}
+
+TEST_CASE( "CompressedSparseFeat/AtA_mul_Bx", "A_mul_Bx and AtA_mul_Bx for CompressedBinaryCSR" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   SparseFeat sf(6, 4, 9, rows, cols);
+   CompressedSparseFeat csf(6, 4, 9, to_uint32(rows, 9).data(), to_uint32(cols, 9).data());
+   Eigen::MatrixXd B(2, 4), X(2, 6), Xtr(2, 6), tmp(2, 6), out(2, 4), outtr(2, 4);
+   B << -1.38,  1.04, -0.28, -0.18,
+         0.03,  0.88,  1.32, -0.31;
+ 
+   smurff::linop::A_mul_Bx<2>(Xtr, sf.M, B);
+   smurff::linop::A_mul_Bx<2>(X, csf.M, B);
+   REQUIRE( (X - Xtr).norm() == Approx(0) );
+ 
+   smurff::linop::AtA_mul_Bx<2>(outtr, sf, 0.6, B, tmp);
+   smurff::linop::AtA_mul_Bx<2>(out, csf, 0.6, B, tmp);
+   REQUIRE( (out - outtr).norm() == Approx(0) );
+}
+
+TEST_CASE( "CompressedSparseFeat/compute_uhat", "compute_uhat for CompressedSparseFeat" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   CompressedSparseFeat csf(6, 4, 9, to_uint32(rows, 9).data(), to_uint32(cols, 9).data());
+   Eigen::MatrixXd beta(3, 4), uhat(3, 6), uhat_true(3, 6);
+ 
+   beta << 0.56,  0.55,  0.3 , -1.78,
+           1.63, -0.71,  0.8 , -0.28,
+           0.47,  0.37, -1.36,  0.86;
+   uhat_true <<  0.55,  0.55, -1.23,  0.86,  0.86, -1.78,
+                -0.71, -0.71, -0.99,  2.43,  2.43, -0.28,
+                 0.37,  0.37,  1.23, -0.89, -0.89,  0.86;
+ 
+   smurff::linop::compute_uhat(uhat, csf, beta);
+   REQUIRE( (uhat - uhat_true).norm() == Approx(0) );
+}
+
+TEST_CASE( "CompressedSparseFeat/solve_blockcg", "BlockCG solver for CompressedSparseFeat (3rhs separately)" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   CompressedSparseFeat csf(6, 4, 9, to_uint32(rows, 9).data(), to_uint32(cols, 9).data());
+   Eigen::MatrixXd B(3, 4), X(3, 4), X_true(3, 4);
+ 
+   B << 0.56,  0.55,  0.3 , -1.78,
+        0.34,  0.05, -1.48,  1.11,
+        0.09,  0.51, -0.63,  1.59;
+ 
+   X_true << 0.35555556,  0.40709677, -0.16444444, -0.87483871,
+             1.69333333, -0.12709677, -1.94666667,  0.49483871,
+             0.66      , -0.04064516, -0.78      ,  0.65225806;
+ 
+   smurff::linop::solve_blockcg(X, csf, 0.5, B, 1e-6, 1, 0);
+   for (int i = 0; i < X.rows(); i++) {
+     for (int j = 0; j < X.cols(); j++) {
+       REQUIRE( X(i,j) == Approx(X_true(i,j)) );
+     }
+   }
+}
+
+TEST_CASE( "CompressedSparseFeat/escape", "column deltas larger than 16 bits are escaped" ) 
+{
+   int rows[5] = { 0, 0, 0, 1, 1 };
+   int cols[5] = { 199999, 3, 70000, 70000, 0 };
+   CompressedSparseFeat csf(2, 200000, 5, to_uint32(rows, 5).data(), to_uint32(cols, 5).data());
+ 
+   // row 0: 3, escape(70000), escape(199999); row 1: 0, escape(70000)
+   REQUIRE( csf.M.nwords == 7 + 4 );
+   REQUIRE( csf.M.row_ptr[1] == 7 );
+ 
+   Eigen::MatrixXd B(1, 200000), X(1, 2);
+   for (int i = 0; i < B.cols(); i++) B(0, i) = i;
+   smurff::linop::A_mul_Bx<1>(X, csf.M, B);
+   REQUIRE( X(0, 0) == Approx(199999 + 3 + 70000) );
+   REQUIRE( X(0, 1) == Approx(70000) );
+ 
+   Eigen::VectorXd col_sq = smurff::linop::col_square_sum(csf);
+   REQUIRE( col_sq(70000) == 2 );
+   REQUIRE( col_sq(199999) == 1 );
+   REQUIRE( col_sq.sum() == 5 );
+}
+
+TEST_CASE( "BitPackedFeat/At_mul_A", "[At_mul_A] for BitPackedFeat" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   SparseFeat sf(6, 4, 9, rows, cols);
+   BitPackedFeat bf(6, 4, 9, rows, cols);
+ 
+   REQUIRE( bf.col_words == 1 );
+ 
+   Eigen::MatrixXd AA(4, 4), BAA(4, 4);
+   smurff::linop::At_mul_A(AA, sf);
+   smurff::linop::At_mul_A(BAA, bf);
+   REQUIRE( (AA.triangularView<Eigen::Lower>().toDenseMatrix() - BAA.triangularView<Eigen::Lower>().toDenseMatrix()).norm() == Approx(0) );
+   REQUIRE( (smurff::linop::col_square_sum(sf) - smurff::linop::col_square_sum(bf)).norm() == Approx(0) );
+
+   Eigen::SparseMatrix<double> SAA, SBAA;
+   smurff::linop::At_mul_A(SAA, sf);
+   smurff::linop::At_mul_A(SBAA, bf);
+   REQUIRE( (Eigen::MatrixXd(SAA) - Eigen::MatrixXd(SBAA)).norm() == Approx(0) );
+
+   std::vector<std::vector<int> > colors, bcolors;
+   smurff::linop::color_cols(colors, sf);
+   smurff::linop::color_cols(bcolors, bf);
+   REQUIRE( colors == bcolors );
+}
+
+TEST_CASE( "BitPackedFeat/linop", "BitPackedFeat kernels match SparseFeat across word boundaries" ) 
+{
+   // 70 x 130 fingerprint, so rows and columns span several 64-bit words
+   std::vector<int> rows, cols;
+   for (int r = 0; r < 70; r++)
+      for (int c = 0; c < 130; c++)
+         if ((r * 7 + c * 3) % 11 == 0 || c == 129 || r == 69)
+         {
+            rows.push_back(r);
+            cols.push_back(c);
+         }
+   SparseFeat sf(70, 130, rows.size(), rows.data(), cols.data());
+   BitPackedFeat bf(70, 130, rows.size(), rows.data(), cols.data());
+ 
+   Eigen::MatrixXd B = Eigen::MatrixXd::Random(3, 130);
+   Eigen::MatrixXd X(3, 70), Xtr(3, 70), tmp(3, 70), out(3, 130), outtr(3, 130);
+ 
+   smurff::linop::A_mul_Bx<3>(Xtr, sf.M, B);
+   smurff::linop::A_mul_Bx<3>(X, bf, B);
+   REQUIRE( (X - Xtr).norm() == Approx(0) );
+ 
+   smurff::linop::AtA_mul_Bx<3>(outtr, sf, 0.5, B, tmp);
+   smurff::linop::AtA_mul_Bx<3>(out, bf, 0.5, B, tmp);
+   REQUIRE( (out - outtr).norm() == Approx(0) );
+ 
+   smurff::linop::compute_uhat(Xtr, sf, B);
+   smurff::linop::compute_uhat(X, bf, B);
+   REQUIRE( (X - Xtr).norm() == Approx(0) );
+ 
+   Eigen::MatrixXd A = Eigen::MatrixXd::Random(2, 70);
+   REQUIRE( (smurff::linop::A_mul_B(A, sf) - smurff::linop::A_mul_B(A, bf)).norm() == Approx(0) );
+ 
+   Eigen::VectorXd y(3), ytr(3);
+   smurff::linop::At_mul_Bt(ytr, sf, 129, tmp);
+   smurff::linop::At_mul_Bt(y, bf, 129, tmp);
+   REQUIRE( (y - ytr).norm() == Approx(0) );
+ 
+   Eigen::MatrixXd Z = Eigen::MatrixXd::Zero(3, 70), Ztr = Eigen::MatrixXd::Zero(3, 70);
+   smurff::linop::add_Acol_mul_bt(Ztr, sf, 66, y);
+   smurff::linop::add_Acol_mul_bt(Z, bf, 66, y);
+   REQUIRE( (Z - Ztr).norm() == Approx(0) );
+ 
+   Eigen::MatrixXd Xcg(3, 130), Xcgtr(3, 130);
+   smurff::linop::solve_blockcg(Xcgtr, sf, 0.5, B, 1e-6, 1, 0);
+   smurff::linop::solve_blockcg(Xcg, bf, 0.5, B, 1e-6, 1, 0);
+   REQUIRE( (Xcg - Xcgtr).norm() == Approx(0) );
+}
+
+TEST_CASE( "CompositeSideInfo/linop", "CompositeSideInfo matches the concatenated dense matrix" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   auto sf = std::make_shared<SparseFeat>(6, 4, 9, rows, cols);
+   auto dense = std::make_shared<Eigen::MatrixXd>(6, 2);
+   *dense << -0.83,  -0.26,
+              0.91,  -0.48,
+             -0.59,   1.94,
+             -0.08,   0.62,
+              1.44,   0.89,
+             -1.33,  -1.42;
+ 
+   CompositeSideInfo composite({ std::make_shared<SparseFeatSideInfo>(sf), std::make_shared<DenseDoubleFeatSideInfo>(dense) });
+ 
+   Eigen::MatrixXd F = Eigen::MatrixXd::Zero(6, 6);
+   for (int i = 0; i < 9; i++) F(rows[i], cols[i]) = 1.0;
+   F.rightCols(2) = *dense;
+ 
+   REQUIRE( composite.rows() == 6 );
+   REQUIRE( composite.cols() == 6 );
+   REQUIRE( composite.is_dense() );
+ 
+   Eigen::MatrixXd beta(2, 6), uhat(2, 6);
+   beta << 0.56,  0.55,  0.3 , -1.78,  0.12, -0.4,
+           1.63, -0.71,  0.8 , -0.28,  0.9 ,  0.3;
+   composite.compute_uhat(uhat, beta);
+   REQUIRE( (uhat - beta * F.transpose()).norm() == Approx(0) );
+ 
+   Eigen::MatrixXd A = uhat;
+   REQUIRE( (composite.A_mul_B(A) - A * F).norm() == Approx(0) );
+ 
+   Eigen::MatrixXd FtF = Eigen::MatrixXd::Zero(6, 6);
+   composite.At_mul_A(FtF);
+   Eigen::MatrixXd FtF_true = F.transpose() * F;
+   REQUIRE( (Eigen::MatrixXd(FtF.triangularView<Eigen::Lower>()) - Eigen::MatrixXd(FtF_true.triangularView<Eigen::Lower>())).norm() == Approx(0) );
+ 
+   REQUIRE( (composite.col_square_sum() - FtF_true.diagonal()).norm() == Approx(0) );
+ 
+   Eigen::VectorXd y(2);
+   composite.At_mul_Bt(y, 5, A);
+   REQUIRE( (y - A * F.col(5)).norm() == Approx(0) );
+ 
+   Eigen::MatrixXd Z = Eigen::MatrixXd::Zero(2, 6);
+   composite.add_Acol_mul_bt(Z, 1, y);
+   REQUIRE( (Z - y * F.col(1).transpose()).norm() == Approx(0) );
+ 
+   Eigen::MatrixXd X(2, 6);
+   composite.solve_blockcg(X, 0.5, beta, 1e-8, 1, 0);
+   Eigen::MatrixXd K = FtF_true + 0.5 * Eigen::MatrixXd::Identity(6, 6);
+   REQUIRE( (X * K - beta).norm() == Approx(0) );
+}
+
+TEST_CASE( "CompositeSideInfo/sparse", "CompositeSideInfo of sparse blocks has a sparse F'F and column coloring" ) 
+{
+   int rows[9] = { 0, 3, 3, 2, 5, 4, 1, 2, 4 };
+   int cols[9] = { 1, 0, 2, 1, 3, 0, 1, 3, 2 };
+   int rows2[4] = { 0, 1, 5, 5 };
+   int cols2[4] = { 0, 2, 1, 2 };
+   auto sf = std::make_shared<SparseFeat>(6, 4, 9, rows, cols);
+   auto sf2 = std::make_shared<SparseFeat>(6, 3, 4, rows2, cols2);
+ 
+   CompositeSideInfo composite({ std::make_shared<SparseFeatSideInfo>(sf), std::make_shared<SparseFeatSideInfo>(sf2) });
+   REQUIRE( !composite.is_dense() );
+ 
+   Eigen::MatrixXd F = Eigen::MatrixXd::Zero(6, 7);
+   for (int i = 0; i < 9; i++) F(rows[i], cols[i]) = 1.0;
+   for (int i = 0; i < 4; i++) F(rows2[i], 4 + cols2[i]) = 1.0;
+   Eigen::MatrixXd FtF_true = F.transpose() * F;
+ 
+   Eigen::SparseMatrix<double> FtF;
+   composite.At_mul_A(FtF);
+   REQUIRE( (Eigen::MatrixXd(FtF) - Eigen::MatrixXd(FtF_true.triangularView<Eigen::Lower>())).norm() == Approx(0) );
+ 
+   // every column gets exactly one color, and columns of one color have no row in common
+   std::vector<std::vector<int> > colors;
+   composite.color_cols(colors);
+   std::vector<int> ncolored(7, 0);
+   for (auto& c : colors)
+   {
+      for (int f : c) ncolored[f]++;
+      for (int f : c)
+         for (int g : c)
+            if (f != g) REQUIRE( FtF_true(f, g) == 0 );
+   }
+   REQUIRE( ncolored == std::vector<int>(7, 1) );
+}
+
+TEST_CASE( "DenseFloatFeatSideInfo/linop", "single precision side info matches double precision" ) 
+{
+   // more rows than one sgemm block, so partial sums are combined in double
+   auto Ff = std::make_shared<Eigen::MatrixXf>(2500, 5);
+   for (int i = 0; i < Ff->rows(); i++)
+      for (int j = 0; j < Ff->cols(); j++)
+         (*Ff)(i, j) = std::sin(7.0 * i + 3.0 * j);
+   auto Fd = std::make_shared<Eigen::MatrixXd>(Ff->cast<double>());
+
+   DenseFloatFeatSideInfo sf(Ff);
+   DenseDoubleFeatSideInfo sd(Fd);
+
+   Eigen::MatrixXd beta(2, 5), uhat(2, 2500), uhat_true(2, 2500);
+   beta << 0.56,  0.55,  0.3 , -1.78,  0.12,
+           1.63, -0.71,  0.8 , -0.28,  0.9 ;
+   sf.compute_uhat(uhat, beta);
+   sd.compute_uhat(uhat_true, beta);
+   REQUIRE( (uhat - uhat_true).norm() / uhat_true.norm() < 1e-5 );
+
+   Eigen::MatrixXd AF = sf.A_mul_B(uhat_true);
+   Eigen::MatrixXd AF_true = sd.A_mul_B(uhat_true);
+   REQUIRE( (AF - AF_true).norm() / AF_true.norm() < 1e-5 );
+
+   Eigen::MatrixXd FtF(5, 5), FtF_true(5, 5);
+   sf.At_mul_A(FtF);
+   sd.At_mul_A(FtF_true);
+   REQUIRE( (Eigen::MatrixXd(FtF.triangularView<Eigen::Lower>()) - Eigen::MatrixXd(FtF_true.triangularView<Eigen::Lower>())).norm() == Approx(0) );
+   REQUIRE( (sf.col_square_sum() - sd.col_square_sum()).norm() == Approx(0) );
+
+   Eigen::MatrixXd X(2, 5), X_true(2, 5);
+   sf.solve_blockcg(X, 0.5, beta, 1e-8, 1, 0);
+   sd.solve_blockcg(X_true, 0.5, beta, 1e-8, 1, 0);
+   REQUIRE( (X - X_true).norm() / X_true.norm() < 1e-5 );
+}
+
 TEST_CASE( "MatrixXd/compute_uhat", "compute_uhat for MatrixXd" ) {
    Eigen::MatrixXd beta(2, 4), feat(6, 4), uhat(2, 6), uhat_true(2, 6);
    beta << 0.56,  0.55,  0.3 , -1.78,
@@ -0,0 +1,381 @@
+#define CATCH_CONFIG_RUNNER  // main() initializes MPI around the tests
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+#include <mpi.h>
+
+#include <Eigen/Dense>
+
+#include <SmurffCpp/Model.h>
+#include <SmurffCpp/DataMatrices/Data.h>
+#include <SmurffCpp/Configs/Config.h>
+#include <SmurffCpp/Sessions/SessionFactory.h>
+#include <SmurffCpp/Utils/RootFile.h>
+#include <SmurffCpp/IO/MatrixIO.h>
+#include <SmurffCpp/SideInfo/DenseDoubleFeatSideInfo.h>
+
+#include <SmurffMPI/MPISession.h>
+#include <SmurffMPI/MPIRowSideInfo.h>
+
+// these tests run on two ranks (mpirun -np 2 mpi_tests), every rank runs every test case
+// and results are only compared on rank 0, where the single-process reference is computed
+
+using namespace smurff;
+
+static NoiseConfig fixed_ncfg(NoiseTypes::fixed);
+
+static int world_rank()
+{
+   int rank;
+   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+   return rank;
+}
+
+// nrow x ncol matrix with deterministic values
+static Eigen::MatrixXd make_matrix(int nrow, int ncol, double offset)
+{
+   Eigen::MatrixXd m(nrow, ncol);
+   for (int i = 0; i < m.size(); i++)
+      m.data()[i] = std::sin(offset + i);
+   return m;
+}
+
+static void REQUIRE_MATRIX_APPROX(const Eigen::MatrixXd& actual, const Eigen::MatrixXd& expected)
+{
+   REQUIRE(actual.rows() == expected.rows());
+   REQUIRE(actual.cols() == expected.cols());
+   for (int i = 0; i < actual.size(); i++)
+      REQUIRE(actual.data()[i] == Approx(expected.data()[i]));
+}
+
+// the latents of rank 0 are sent to the other ranks, which compare them with their own
+static void REQUIRE_SAME_LATENTS_ON_ALL_RANKS(MPISession& session)
+{
+   for (std::uint64_t mode = 0; mode < session.model().nmodes(); mode++)
+   {
+      const Eigen::MatrixXd& U = session.model().U(mode);
+      Eigen::MatrixXd U0 = U;
+      MPI_Bcast(U0.data(), U0.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+      REQUIRE(U == U0);
+   }
+}
+
+static std::shared_ptr<MatrixConfig> getTrainSparseMatrixConfig()
+{
+   std::vector<std::uint32_t> rows = { 0, 0, 0, 0, 2, 2, 2, 2 };
+   std::vector<std::uint32_t> cols = { 0, 1, 2, 3, 0, 1, 2, 3 };
+   std::vector<double> vals = { 1, 2, 3, 4, 9, 10, 11, 12 };
+   return std::make_shared<MatrixConfig>(3, 4, std::move(rows), std::move(cols), std::move(vals), fixed_ncfg, true);
+}
+
+// dense side info of the 3 rows of the train matrix, solved with BlockCG
+static std::shared_ptr<SideInfoConfig> getRowSideInfoConfig()
+{
+   Eigen::MatrixXd F = make_matrix(3, 5, 1.0);
+   std::vector<double> vals(F.data(), F.data() + F.size());
+
+   auto sideInfo = std::make_shared<SideInfoConfig>();
+   sideInfo->setSideInfo(std::make_shared<MatrixConfig>(3, 5, std::move(vals), fixed_ncfg));
+   sideInfo->setDirect(false);
+   sideInfo->setTol(1e-12);
+   return sideInfo;
+}
+
+TEST_CASE("mpi/row_side_info", "Row-partitioned side info computes the same beta as the full side info")
+{
+   const int nrow = 7, ncol = 3, num_latent = 2;
+   const double reg = 1.5;
+
+   auto F = std::make_shared<Eigen::MatrixXd>(make_matrix(nrow, ncol, 1.0));
+   int world_size;
+   MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+   int begin, end;
+   MPIRowSideInfo::row_range(nrow, world_rank(), world_size, begin, end);
+
+   auto slice = std::make_shared<Eigen::MatrixXd>(F->middleRows(begin, end - begin));
+   MPIRowSideInfo rowF(std::make_shared<DenseDoubleFeatSideInfo>(slice), nrow);
+
+   // the linops are collective, the arguments of the other ranks are ignored
+   Eigen::MatrixXd U = make_matrix(num_latent, nrow, 2.0);
+   Eigen::MatrixXd Ft_y = rowF.A_mul_B(U);
+
+   Eigen::MatrixXd beta = Eigen::MatrixXd::Zero(num_latent, ncol);
+   rowF.solve_blockcg(beta, reg, Ft_y, 1e-12, 32, 8);
+
+   Eigen::MatrixXd uhat(num_latent, nrow);
+   rowF.compute_uhat(uhat, beta);
+
+   if (world_rank() != 0)
+      return;
+
+   DenseDoubleFeatSideInfo fullF(F);
+   Eigen::MatrixXd expected_Ft_y = fullF.A_mul_B(U);
+   REQUIRE_MATRIX_APPROX(Ft_y, expected_Ft_y);
+
+   // beta = Ft_y * (F'F + reg * I)^-1
+   Eigen::MatrixXd FtF = F->transpose() * *F + reg * Eigen::MatrixXd::Identity(ncol, ncol);
+   Eigen::MatrixXd expected_beta = FtF.llt().solve(expected_Ft_y.transpose()).transpose();
+   REQUIRE_MATRIX_APPROX(beta, expected_beta);
+
+   REQUIRE_MATRIX_APPROX(uhat, expected_beta * F->transpose());
+}
+
+static Config getPartitionedMacauConfig(bool partition_rows)
+{
+   auto sideInfo = getRowSideInfoConfig();
+   sideInfo->setPartitionRows(partition_rows);
+
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTrainSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, sideInfo);
+   config.setNumLatent(4);
+   config.setBurnin(20);
+   config.setNSamples(20);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setSaveFreq(0);
+   return config;
+}
+
+// rank 0 samples the same chain without MPI, beta is solved with BlockCG in both runs
+static void REQUIRE_SAME_AS_SINGLE_PROCESS(const Config& mpiConfig)
+{
+   std::shared_ptr<ISession> singleSession;
+   if (world_rank() == 0)
+   {
+      Config singleConfig = getPartitionedMacauConfig(false);
+      singleSession = SessionFactory::create_session(singleConfig);
+      singleSession->run();
+   }
+
+   std::shared_ptr<ISession> mpiSession = create_mpi_session(mpiConfig);
+   mpiSession->run();
+
+   if (world_rank() != 0)
+      return;
+
+   auto expected = singleSession->getResult();
+   auto actual = mpiSession->getResult();
+   REQUIRE(actual->size() == expected->size());
+   for (std::size_t i = 0; i < actual->size(); i++)
+   {
+      REQUIRE(actual->at(i).pred_1sample == Approx(expected->at(i).pred_1sample));
+      REQUIRE(actual->at(i).pred_avg == Approx(expected->at(i).pred_avg));
+   }
+
+   REQUIRE(mpiSession->getRmseAvg() == Approx(singleSession->getRmseAvg()));
+}
+
+TEST_CASE("mpi/sample_beta_partitioned", "Macau sampling with row-partitioned side info matches a single process")
+{
+   REQUIRE_SAME_AS_SINGLE_PROCESS(getPartitionedMacauConfig(true));
+}
+
+TEST_CASE("mpi/partitioned_side_info_file", "Every rank only reads its own rows of row-partitioned side info")
+{
+   // rank 0 writes the data and the ini file
+   if (world_rank() == 0)
+   {
+      Config config = getPartitionedMacauConfig(true);
+      matrix_io::write_matrix("mpi_train.sdm", getTrainSparseMatrixConfig());
+      matrix_io::write_matrix("mpi_side_info.ddm", config.getSideInfoConfigs().at(0).front()->getSideInfo());
+
+      auto train = matrix_io::read_matrix("mpi_train.sdm", true);
+      train->setNoiseConfig(fixed_ncfg);
+      config.setTrain(train);
+      config.setTest(train);
+      auto sideInfo = matrix_io::read_matrix("mpi_side_info.ddm", false);
+      sideInfo->setNoiseConfig(fixed_ncfg);
+      config.getSideInfoConfigs().at(0).front()->setSideInfo(sideInfo);
+      config.save("mpi_partitioned.ini");
+   }
+   MPI_Barrier(MPI_COMM_WORLD);
+
+   Config config;
+   REQUIRE(config.restore("mpi_partitioned.ini"));
+
+   int world_size;
+   MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+   int begin, end;
+   MPIRowSideInfo::row_range(3, world_rank(), world_size, begin, end);
+
+   // the ini file stores the tolerance with 6 decimals
+   auto item = config.getSideInfoConfigs().at(0).front();
+   item->setTol(1e-12);
+
+   REQUIRE(item->isRowSlice());
+   REQUIRE(item->getNRow() == 3);
+   REQUIRE(item->getRowBegin() == (std::uint64_t)begin);
+   REQUIRE(item->getSideInfo()->getNRow() == (std::uint64_t)(end - begin));
+
+   REQUIRE_SAME_AS_SINGLE_PROCESS(config);
+
+   MPI_Barrier(MPI_COMM_WORLD);
+   if (world_rank() == 0)
+   {
+      std::remove("mpi_train.sdm");
+      std::remove("mpi_side_info.ddm");
+      std::remove("mpi_partitioned.ini");
+   }
+}
+
+static Config getDataParallelConfig()
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTrainSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+   config.setNumLatent(4);
+   config.setBurnin(20);
+   config.setNSamples(20);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setSaveFreq(0);
+   config.setDataParallel(true);
+   return config;
+}
+
+TEST_CASE("mpi/data_parallel_gather", "The column slices of all ranks add up to the latents and sums of a single rank")
+{
+   std::shared_ptr<ISession> session = create_mpi_session(getDataParallelConfig());
+   session->init();
+   auto mpiSession = std::dynamic_pointer_cast<MPISession>(session);
+
+   for (int mode = 0; mode < 2; mode++)
+   {
+      Eigen::MatrixXd& U = mpiSession->model().U(mode);
+      Eigen::MatrixXd expected = make_matrix(U.rows(), U.cols(), 3.0 + mode);
+
+      // every rank only writes its own columns and sums over them
+      int begin, end;
+      mpiSession->begin_sample_latents(mode, begin, end);
+      U.setZero();
+      U.middleCols(begin, end - begin) = expected.middleCols(begin, end - begin);
+      Eigen::VectorXd Usum = U.rowwise().sum();
+      Eigen::MatrixXd UUsum = U * U.transpose();
+      mpiSession->end_sample_latents(mode, Usum, UUsum);
+
+      REQUIRE_MATRIX_APPROX(U, expected);
+      REQUIRE_MATRIX_APPROX(Usum, expected.rowwise().sum());
+      REQUIRE_MATRIX_APPROX(UUsum, expected * expected.transpose());
+   }
+}
+
+TEST_CASE("mpi/data_parallel_run", "Data-parallel sampling keeps the same latents on every rank")
+{
+   // the columns of rank 1 are drawn from its own stream, so the chain is not the one
+   // of a single process, but all ranks have to agree on every sample
+   std::shared_ptr<ISession> session = create_mpi_session(getDataParallelConfig());
+   session->run();
+   REQUIRE_SAME_LATENTS_ON_ALL_RANKS(*std::dynamic_pointer_cast<MPISession>(session));
+
+   REQUIRE(std::isfinite(session->getRmseAvg()));
+}
+
+TEST_CASE("mpi/data_parallel_own_entries", "With data-parallel sampling rank 0 updates the noise and the other ranks only keep their train entries")
+{
+   Config config = getDataParallelConfig();
+   auto train = getTrainSparseMatrixConfig();
+   train->setNoiseConfig(NoiseConfig(NoiseTypes::adaptive));
+   config.setTrain(train);
+
+   std::shared_ptr<ISession> session = create_mpi_session(config);
+   session->run();
+   auto mpiSession = std::dynamic_pointer_cast<MPISession>(session);
+   REQUIRE_SAME_LATENTS_ON_ALL_RANKS(*mpiSession);
+
+   double alpha = mpiSession->data().noise().getAlpha();
+   double alpha0 = alpha;
+   MPI_Bcast(&alpha0, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+   REQUIRE(alpha == alpha0);
+
+   // rows 0 and 2 of the train matrix hold all entries, the columns are split as well
+   if (world_rank() == 0)
+      REQUIRE(mpiSession->data().nnz() == train->getNNZ());
+   else
+      REQUIRE(mpiSession->data().nnz() < train->getNNZ());
+}
+
+TEST_CASE("mpi/warm_start", "Warm start of a macau prior needs data-parallel sampling")
+{
+   auto make_config = []()
+   {
+      Config config = getDataParallelConfig();
+      config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+      config.addSideInfoConfig(0, getRowSideInfoConfig());
+      return config;
+   };
+
+   // the previous run is saved by rank 0 alone
+   if (world_rank() == 0)
+   {
+      Config config = make_config();
+      config.setDataParallel(false);
+      config.setSavePrefix("mpi_warm_start");
+      config.setSaveExtension(".ddm");
+      config.setSaveFreq(-1);
+      std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+      session->run();
+   }
+   MPI_Barrier(MPI_COMM_WORLD);
+
+   Config warmConfig = make_config();
+   warmConfig.setWarmStart("mpi_warm_start-root.ini");
+
+   // every rank starts from the saved model, rank 0 updates the priors
+   std::shared_ptr<ISession> session = create_mpi_session(warmConfig);
+   session->run();
+   REQUIRE_SAME_LATENTS_ON_ALL_RANKS(*std::dynamic_pointer_cast<MPISession>(session));
+
+   // the beta update of the MPI macau prior would run in init on rank 0 alone
+   warmConfig.setDataParallel(false);
+   REQUIRE_THROWS(create_mpi_session(warmConfig));
+
+   MPI_Barrier(MPI_COMM_WORLD);
+   if (world_rank() == 0)
+   {
+      RootFile rootFile("mpi_warm_start-root.ini");
+      rootFile.openLastStepFile()->remove(true, true, true);
+      std::remove(rootFile.getOptionsFileName().c_str());
+      std::remove(rootFile.getRootFileName().c_str());
+   }
+}
+
+TEST_CASE("mpi/als_init", "ALS init of a macau prior needs data-parallel sampling")
+{
+   Config config = getDataParallelConfig();
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoConfig());
+   config.setModelInitType(ModelInitTypes::als);
+
+   // the sweeps sample the column slices like the gibbs steps, the prior updates run on rank 0
+   std::shared_ptr<ISession> session = create_mpi_session(config);
+   session->run();
+   REQUIRE_SAME_LATENTS_ON_ALL_RANKS(*std::dynamic_pointer_cast<MPISession>(session));
+
+   // the beta update of the MPI macau prior would run in init on rank 0 alone
+   config.setDataParallel(false);
+   REQUIRE_THROWS(create_mpi_session(config));
+}
+
+int main(int argc, char* argv[])
+{
+   MPI_Init(&argc, &argv);
+
+   // as in mpi_smurff, restored configs only hold the rows of this rank of row-partitioned side info
+   MPIRowSideInfo::restore_own_rows();
+
+   int result = Catch::Session().run(argc, argv);
+
+   // a failure on one rank can leave the other ranks waiting in a collective
+   if (result)
+      MPI_Abort(MPI_COMM_WORLD, result);
+
+   MPI_Finalize();
+   return result;
+}
@@ -202,6 +202,45 @@ TEST_CASE("matrix_io/read_matrix | matrix_io/write_matrix | .sbm")
    REQUIRE(matrix_utils::equals(actualMatrix, expectedMatrix));
 }
 
+TEST_CASE("matrix_io/read_matrix_rows", "reading a row range matches slicing the whole matrix")
+{
+   std::vector<double> denseValues = { 1, 5, 9, 2, 6, 10, 3, 7, 11, 4, 8, 12 };
+   std::vector<std::uint32_t> rows = { 0, 0, 0, 0, 2, 1, 2, 2 };
+   std::vector<std::uint32_t> cols = { 0, 1, 2, 3, 0, 1, 2, 3 };
+   std::vector<double> values = { 1, 2, 3, 4, 9, 10, 11, 12 };
+
+   auto dense = std::make_shared<MatrixConfig>(3, 4, denseValues, fixed_ncfg);
+   auto sparse = std::make_shared<MatrixConfig>(3, 4, rows, cols, values, fixed_ncfg, false);
+   auto binary = std::make_shared<MatrixConfig>(3, 4, rows, cols, fixed_ncfg, false);
+
+   std::vector<std::pair<std::string, std::shared_ptr<MatrixConfig> > > files = {
+      { "matrixRows.ddm", dense }, { "matrixRows.sdm", sparse }, { "matrixRows.sbm", binary }, { "matrixRows.mtx", sparse } };
+
+   for (auto& f : files)
+   {
+      matrix_io::write_matrix(f.first, f.second);
+      REQUIRE(matrix_io::read_matrix_nrow(f.first) == 3);
+
+      for (std::uint64_t begin = 0; begin < 3; begin++)
+      {
+         for (std::uint64_t end = begin + 1; end <= 3; end++)
+         {
+            auto actual = matrix_io::read_matrix_rows(f.first, false, begin, end);
+            auto expected = matrix_utils::row_slice(*f.second, begin, end);
+            REQUIRE(actual->getNRow() == end - begin);
+            REQUIRE(actual->getNCol() == 4);
+            REQUIRE(actual->getFilename() == f.first);
+            if (f.second->isDense())
+               REQUIRE(matrix_utils::equals(matrix_utils::dense_to_eigen(*actual), matrix_utils::dense_to_eigen(*expected)));
+            else
+               REQUIRE(matrix_utils::equals(matrix_utils::sparse_to_eigen(*actual), matrix_utils::sparse_to_eigen(*expected)));
+         }
+      }
+
+      std::remove(f.first.c_str());
+   }
+}
+
 // ===
 
 TEST_CASE("matrix_io/read_matrix_market | matrix_io/write_matrix_market | dense")
@@ -241,3 +241,75 @@ TEST_CASE("matrix_utils::slice : 5D tensor")
       REQUIRE(matrix_utils::equals(actualTensorSlice, expectedTensorSlice));
    }
 }
+
+TEST_CASE("matrix_utils::keep_rows")
+{
+   Eigen::MatrixXd m(3, 3);
+   m << 1, 2, 3,
+        4, 5, 6,
+        7, 8, 9;
+   std::vector<int> keep = { 0, 2 };
+
+   Eigen::MatrixXd rows = m;
+   matrix_utils::keep_rows(rows, keep);
+
+   Eigen::MatrixXd expectedRows(2, 3);
+   expectedRows << 1, 2, 3,
+                   7, 8, 9;
+   REQUIRE(matrix_utils::equals(rows, expectedRows));
+
+   Eigen::MatrixXd rowsCols = m;
+   matrix_utils::keep_rows_cols(rowsCols, keep);
+
+   Eigen::MatrixXd expectedRowsCols(2, 2);
+   expectedRowsCols << 1, 3,
+                       7, 9;
+   REQUIRE(matrix_utils::equals(rowsCols, expectedRowsCols));
+
+   Eigen::VectorXd v(3);
+   v << 1, 2, 3;
+   matrix_utils::keep_rows(v, keep);
+
+   Eigen::VectorXd expectedV(2);
+   expectedV << 1, 3;
+   REQUIRE(matrix_utils::equals_vector(v, expectedV));
+}
+
+TEST_CASE("matrix_utils::hash_columns")
+{
+   const std::uint32_t nbuckets = 4;
+   const std::uint32_t seed = 7;
+
+   // 3 x 1000000 binary side info with raw feature ids
+   std::vector<std::uint32_t> rows = { 0, 0, 0, 1, 2, 2 };
+   std::vector<std::uint32_t> cols = { 12, 999999, 123456, 12, 5, 77777 };
+   MatrixConfig raw(3, 1000000, rows, cols, fixed_ncfg, false);
+
+   auto hashed = matrix_utils::hash_columns(raw, nbuckets, seed);
+   REQUIRE(hashed->getNRow() == 3);
+   REQUIRE(hashed->getNCol() == nbuckets);
+
+   // expected: every feature moved to its bucket with its sign, collisions summed
+   Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(3, nbuckets);
+   for (std::size_t i = 0; i < rows.size(); i++)
+   {
+      std::uint32_t bucket;
+      double sign;
+      matrix_utils::feature_hash(cols[i], nbuckets, seed, bucket, sign);
+      REQUIRE(bucket < nbuckets);
+      REQUIRE(std::abs(sign) == 1.0);
+      expected(rows[i], bucket) += sign;
+   }
+
+   Eigen::MatrixXd actual = Eigen::MatrixXd(matrix_utils::sparse_to_eigen(*hashed));
+   REQUIRE(matrix_utils::equals(actual, expected));
+
+   // same feature id maps to the same column in every row
+   REQUIRE(actual.row(0).cwiseAbs().sum() > 0);
+   std::uint32_t b0, b1;
+   double s0, s1;
+   matrix_utils::feature_hash(12, nbuckets, seed, b0, s0);
+   matrix_utils::feature_hash(12, nbuckets, seed, b1, s1);
+   REQUIRE(b0 == b1);
+   REQUIRE(s0 == s1);
+}
@@ -1,10 +1,23 @@
 #include "catch.hpp"
 
+#include <cmath>
+#include <random>
+
 #include <Eigen/Core>
 
 #include <SmurffCpp/Configs/Config.h>
 #include <SmurffCpp/Sessions/SessionFactory.h>
 #include <SmurffCpp/Utils/MatrixUtils.h>
+#include <SmurffCpp/Priors/MacauPrior.h>
+#include <SmurffCpp/Sessions/PredictSession.h>
+#include <SmurffCpp/Sessions/MultiChainSession.h>
+#include <SmurffCpp/Sessions/SweepSession.h>
+#include <SmurffCpp/Sessions/CrossValidationSession.h>
+#include <SmurffCpp/DataMatrices/FoldMatrixData.h>
+#include <SmurffCpp/DataMatrices/ScarceMatrixData.h>
+#include <SmurffCpp/IO/GenericIO.h>
+#include <SmurffCpp/IO/MatrixIO.h>
+#include <SmurffCpp/Utils/Diagnostics.h>
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // Code for printing test results that can then be copy-pasted into tests as expected results
@@ -296,6 +309,969 @@ void REQUIRE_RESULT_ITEMS(const std::vector<ResultItem>& actualResultItems, cons
    }
 }
 
+//
+//      train: sparse matrix
+//       test: sparse matrix
+//     priors: macau macau
+//  side-info: row_side_info_sparse_matrix col_side_info_sparse_matrix
+// num-latent: 4
+//     burnin: 50
+//   nsamples: 50
+//    verbose: 0
+//       seed: 1234
+//     direct: true, sparse_direct: false vs true
+//
+TEST_CASE(
+   "dense FtF vs sparse FtF"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau macau --side-info <row_side_info_sparse_matrix> <col_side_info_sparse_matrix> --num-latent 4 --burnin 50 --nsamples 50 --verbose 0 --seed 1234 --direct"
+   , HIDE_VS_TESTS)
+{
+   auto make_config = [](bool sparse_direct)
+   {
+      auto rowSideInfo = getRowSideInfoSparseConfig();
+      auto colSideInfo = getColSideInfoSparseConfig();
+      rowSideInfo->setSparseDirect(sparse_direct);
+      colSideInfo->setSparseDirect(sparse_direct);
+
+      Config config;
+      config.setTrain(getTrainSparseMatrixConfig());
+      config.setTest(getTestSparseMatrixConfig());
+      config.setPriorTypes({PriorTypes::macau, PriorTypes::macau});
+      config.addSideInfoConfig(0, rowSideInfo);
+      config.addSideInfoConfig(1, colSideInfo);
+      config.setNumLatent(4);
+      config.setBurnin(50);
+      config.setNSamples(50);
+      config.setVerbose(false);
+      config.setRandomSeed(1234);
+      // the runs are compared draw for draw, the per-thread streams differ with more threads
+      config.setNumThreads(1);
+      return config;
+   };
+
+   Config denseRunConfig = make_config(false);
+   std::shared_ptr<ISession> denseRunSession = SessionFactory::create_session(denseRunConfig);
+   denseRunSession->run();
+
+   Config sparseRunConfig = make_config(true);
+   std::shared_ptr<ISession> sparseRunSession = SessionFactory::create_session(sparseRunConfig);
+   sparseRunSession->run();
+
+   REQUIRE(sparseRunSession->getRmseAvg() == Approx(denseRunSession->getRmseAvg()).epsilon(APPROX_EPSILON));
+   REQUIRE_RESULT_ITEMS(*sparseRunSession->getResult(), *denseRunSession->getResult());
+}
+
+TEST_CASE(
+   "sequential vs pipelined prior update"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau macau --side-info <row_side_info_sparse_matrix> <col_side_info_sparse_matrix> --num-latent 4 --burnin 50 --nsamples 50 --verbose 0 --seed 1234 --pipeline"
+   , HIDE_VS_TESTS)
+{
+   auto make_config = [](bool pipeline)
+   {
+      Config config;
+      config.setTrain(getTrainSparseMatrixConfig());
+      config.setTest(getTestSparseMatrixConfig());
+      config.setPriorTypes({PriorTypes::macau, PriorTypes::macau});
+      config.addSideInfoConfig(0, getRowSideInfoSparseConfig());
+      config.addSideInfoConfig(1, getColSideInfoSparseConfig());
+      config.setNumLatent(4);
+      config.setBurnin(50);
+      config.setNSamples(50);
+      config.setVerbose(false);
+      config.setRandomSeed(1234);
+      config.setPipeline(pipeline);
+      // the random numbers are drawn in the same order, with more threads the
+      // per-thread streams and the guided schedule of the latents differ between runs
+      config.setNumThreads(1);
+      config.setPipelineThreads(1);
+      return config;
+   };
+
+   Config sequentialRunConfig = make_config(false);
+   std::shared_ptr<ISession> sequentialRunSession = SessionFactory::create_session(sequentialRunConfig);
+   sequentialRunSession->run();
+
+   Config pipelinedRunConfig = make_config(true);
+   std::shared_ptr<ISession> pipelinedRunSession = SessionFactory::create_session(pipelinedRunConfig);
+   pipelinedRunSession->run();
+
+   REQUIRE(pipelinedRunSession->getRmseAvg() == Approx(sequentialRunSession->getRmseAvg()).epsilon(APPROX_EPSILON));
+   REQUIRE_RESULT_ITEMS(*pipelinedRunSession->getResult(), *sequentialRunSession->getResult());
+}
+
+TEST_CASE(
+   "prune switched-off latent dimentions at the end of burnin"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau spikeandslab --side-info <row_side_info_dense_matrix> none --num-latent 8 --burnin 50 --nsamples 5 --verbose 0 --seed 1234 --prune-latents --save-prefix prune --save-freq -1"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::spikeandslab});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   config.setNumLatent(8);
+   config.setBurnin(50);
+   config.setNSamples(5);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setPruneLatents(true);
+   config.setSavePrefix("prune");
+   config.setSaveExtension(".ddm");
+   config.setSaveFreq(-1);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+   REQUIRE(!std::isnan(session->getRmseAvg()));
+
+   // the spike and slab prior switches dimentions off, the macau prior follows
+   const Model& model = std::dynamic_pointer_cast<BaseSession>(session)->model();
+   const int nlatent = model.nlatent();
+   REQUIRE(nlatent < 8);
+   REQUIRE(model.getActiveLatents().size() == nlatent);
+   REQUIRE(model.U(0).rows() == nlatent);
+   REQUIRE(model.U(1).rows() == nlatent);
+
+   RootFile rootFile("prune-root.ini");
+   auto stepFile = rootFile.openLastStepFile();
+   REQUIRE(stepFile->getActiveLatents() == model.getActiveLatents());
+
+   Eigen::MatrixXd beta;
+   matrix_io::eigen::read_matrix(stepFile->getLinkMatrixFileName(0), beta);
+   REQUIRE(beta.rows() == nlatent);
+
+   // restoring prunes the new session to the saved dimentions
+   std::shared_ptr<ISession> restoredSession = SessionFactory::create_session(config, rootFile.getRootFileName());
+   restoredSession->init();
+   const Model& restoredModel = std::dynamic_pointer_cast<BaseSession>(restoredSession)->model();
+   REQUIRE(restoredModel.getActiveLatents() == model.getActiveLatents());
+   REQUIRE(matrix_utils::equals(restoredModel.U(0), model.U(0)));
+   REQUIRE(matrix_utils::equals(restoredModel.U(1), model.U(1)));
+
+   stepFile->remove(true, true, true);
+   std::remove(rootFile.getOptionsFileName().c_str());
+   std::remove(rootFile.getRootFileName().c_str());
+}
+
+TEST_CASE(
+   "low-rank projection of dense side info"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau normal --side-info <row_side_info_dense_matrix> none --num-latent 4 --burnin 50 --nsamples 50 --verbose 0 --seed 1234"
+   , HIDE_VS_TESTS)
+{
+   // F = [0.6 f, 0.8 f] has rank one with right singular vector (0.6, 0.8),
+   // so its rank-1 projection F * v is f itself
+   auto make_config = [](std::shared_ptr<SideInfoConfig> sideInfo)
+   {
+      Config config;
+      config.setTrain(getTrainSparseMatrixConfig());
+      config.setTest(getTestSparseMatrixConfig());
+      config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+      config.addSideInfoConfig(0, sideInfo);
+      config.setNumLatent(4);
+      config.setBurnin(50);
+      config.setNSamples(50);
+      config.setVerbose(false);
+      config.setRandomSeed(1234);
+      // the runs are compared draw for draw, the per-thread streams differ with more threads
+      config.setNumThreads(1);
+      return config;
+   };
+
+   std::shared_ptr<SideInfoConfig> wideSideInfo = getRowSideInfoDenseConfig();
+   const std::vector<double>& f = wideSideInfo->getSideInfo()->getValues();
+   std::vector<double> wideValues;
+   for (double v : f) wideValues.push_back(0.6 * v);
+   for (double v : f) wideValues.push_back(0.8 * v);
+   wideSideInfo->setSideInfo(std::make_shared<MatrixConfig>(f.size(), 2, std::move(wideValues), wideSideInfo->getSideInfo()->getNoiseConfig()));
+   wideSideInfo->setProjectionRank(1);
+
+   Config fullRunConfig = make_config(getRowSideInfoDenseConfig());
+   std::shared_ptr<ISession> fullRunSession = SessionFactory::create_session(fullRunConfig);
+   fullRunSession->run();
+
+   Config projectedRunConfig = make_config(wideSideInfo);
+   std::shared_ptr<ISession> projectedRunSession = SessionFactory::create_session(projectedRunConfig);
+   projectedRunSession->run();
+
+   REQUIRE(projectedRunSession->getRmseAvg() == Approx(fullRunSession->getRmseAvg()).epsilon(APPROX_EPSILON));
+   REQUIRE_RESULT_ITEMS(*projectedRunSession->getResult(), *fullRunSession->getResult());
+}
+
+TEST_CASE(
+   "direct vs autotuned macau solver"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau macau --side-info <row_side_info_dense_3x5> <col_side_info_dense_4x3> --num-latent 4 --burnin 50 --nsamples 50 --verbose 0 --seed 1234 --save-prefix autotune --save-freq -1"
+   , HIDE_VS_TESTS)
+{
+   // several features, so CG and the direct method solve a real system and only agree up to tol
+   auto make_side_info = [](int nrow, int ncol, bool autotune)
+   {
+      std::vector<double> vals(nrow * ncol);
+      for (std::size_t i = 0; i < vals.size(); i++)
+         vals[i] = std::sin(1.0 + i);
+
+      auto sideInfo = std::make_shared<SideInfoConfig>();
+      sideInfo->setSideInfo(std::make_shared<MatrixConfig>(nrow, ncol, std::move(vals), fixed_ncfg));
+      sideInfo->setDirect(!autotune);
+      sideInfo->setTol(1e-12);
+      sideInfo->setAutotune(autotune);
+      return sideInfo;
+   };
+
+   auto make_config = [&make_side_info](bool autotune)
+   {
+      Config config;
+      config.setTrain(getTrainSparseMatrixConfig());
+      config.setTest(getTestSparseMatrixConfig());
+      config.setPriorTypes({PriorTypes::macau, PriorTypes::macau});
+      config.addSideInfoConfig(0, make_side_info(3, 5, autotune));
+      config.addSideInfoConfig(1, make_side_info(4, 3, autotune));
+      config.setNumLatent(4);
+      config.setBurnin(50);
+      config.setNSamples(50);
+      config.setVerbose(false);
+      config.setRandomSeed(1234);
+      // the runs are compared draw for draw, the per-thread streams differ with more threads
+      config.setNumThreads(1);
+      config.setSavePrefix(autotune ? "autotune" : "direct");
+      config.setSaveExtension(".ddm");
+      config.setSaveFreq(-1);
+      return config;
+   };
+
+   Config directRunConfig = make_config(false);
+   std::shared_ptr<ISession> directRunSession = SessionFactory::create_session(directRunConfig);
+   directRunSession->run();
+
+   Config autotunedRunConfig = make_config(true);
+   std::shared_ptr<ISession> autotunedRunSession = SessionFactory::create_session(autotunedRunConfig);
+   autotunedRunSession->run();
+
+   // every candidate solves the same system, whichever was timed or kept
+   REQUIRE(autotunedRunSession->getRmseAvg() == Approx(directRunSession->getRmseAvg()).epsilon(APPROX_EPSILON));
+   REQUIRE_RESULT_ITEMS(*autotunedRunSession->getResult(), *directRunSession->getResult());
+
+   // with num-latent 4 the candidates are BlockCG with blocksize 8 and then the direct method
+   for (auto prefix : { "autotune", "direct" })
+   {
+      RootFile rootFile(std::string(prefix) + "-root.ini");
+      auto stepFile = rootFile.openLastStepFile();
+      for (int mode = 0; mode < 2; mode++)
+      {
+         auto solver = stepFile->tryGetIniValueBase(stepFile->getSolverTag(mode));
+         REQUIRE(solver.first == (std::string(prefix) == "autotune"));
+         if (solver.first)
+            REQUIRE((solver.second == "direct" || solver.second == "cg 8 2"));
+      }
+
+      stepFile->remove(true, true, true);
+      std::remove(rootFile.getOptionsFileName().c_str());
+      std::remove(rootFile.getRootFileName().c_str());
+   }
+}
+
+TEST_CASE(
+   "cold-start prediction from saved link matrices"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau normal --side-info <row_side_info_dense_matrix> none --num-latent 4 --burnin 50 --nsamples 5 --verbose 0 --seed 1234 --save-prefix cold_start --save-freq 1"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   config.setNumLatent(4);
+   config.setBurnin(50);
+   config.setNSamples(5);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setSavePrefix("cold_start");
+   config.setSaveExtension(".ddm");
+   config.setSaveFreq(1);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+
+   // two new rows with feature values 0.5 and 4
+   std::vector<double> newValues = { 0.5, 4 };
+   auto newSideInfo = std::make_shared<MatrixConfig>(2, 1, std::move(newValues), fixed_ncfg);
+
+   RootFile rootFile("cold_start-root.ini");
+   auto stepFiles = rootFile.openSampleStepFiles();
+   REQUIRE(stepFiles.size() == 5);
+
+   // without --save-hyper only the macau prior saves its mu, for the cold start
+   REQUIRE(generic_io::file_exists(stepFiles.front()->getMuFileName(0)));
+   REQUIRE(!generic_io::file_exists(stepFiles.front()->getLambdaFileName(0)));
+   REQUIRE(!generic_io::file_exists(stepFiles.front()->getMuFileName(1)));
+
+   PredictSession predictSession("cold_start-root.ini");
+   REQUIRE(predictSession.getNumSamples() == 5);
+
+   Eigen::MatrixXd mean, std;
+   predictSession.predict(0, predictSession.createSideInfo(0, newSideInfo), mean, std);
+   REQUIRE(mean.rows() == 2);
+   REQUIRE(mean.cols() == 4);
+
+   // (mu + beta * f)' * U1 averaged over the saved samples
+   Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(2, 4);
+   Eigen::MatrixXd F(2, 1);
+   F << 0.5, 4;
+   for (auto sf : stepFiles)
+   {
+      Eigen::MatrixXd beta, mu, U1;
+      matrix_io::eigen::read_matrix(sf->getLinkMatrixFileName(0), beta);
+      matrix_io::eigen::read_matrix(sf->getMuFileName(0), mu);
+      matrix_io::eigen::read_matrix(sf->getModelFileName(1), U1);
+      Eigen::MatrixXd uhat = beta * F.transpose();
+      uhat.colwise() += mu.col(0);
+      expected += uhat.transpose() * U1 / stepFiles.size();
+   }
+
+   for (int i = 0; i < mean.rows(); i++)
+      for (int j = 0; j < mean.cols(); j++)
+         REQUIRE(mean(i, j) == Approx(expected(i, j)).epsilon(APPROX_EPSILON));
+   REQUIRE(std.minCoeff() >= 0);
+
+   Eigen::MatrixXi index;
+   Eigen::MatrixXd score;
+   PredictSession::topK(mean, 2, index, score);
+   for (int i = 0; i < mean.rows(); i++)
+   {
+      int best;
+      REQUIRE(score(i, 0) == mean.row(i).maxCoeff(&best));
+      REQUIRE(index(i, 0) == best);
+      REQUIRE(score(i, 0) >= score(i, 1));
+   }
+
+   for (auto sf : stepFiles)
+      sf->remove(true, true, true);
+   std::remove(rootFile.getOptionsFileName().c_str());
+   std::remove(rootFile.getRootFileName().c_str());
+}
+
+TEST_CASE(
+   "cold-start prediction hashes every side info item with its own options"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau normal --side-info <row_side_info_dense_matrix>,<row_side_info_sparse_matrix hashed> none --num-latent 4 --burnin 20 --nsamples 3 --verbose 0 --seed 1234 --save-prefix cold_start_hashed --save-freq 1"
+   , HIDE_VS_TESTS)
+{
+   // 6 raw features hashed into 3 buckets
+   std::vector<std::uint32_t> rows = { 0, 0, 1, 1, 2, 2 };
+   std::vector<std::uint32_t> cols = { 0, 3, 1, 4, 2, 5 };
+   std::vector<double> vals = { 1, 2, 3, 1, 2, 3 };
+   auto hashedSideInfo = std::make_shared<SideInfoConfig>();
+   hashedSideInfo->setSideInfo(std::make_shared<MatrixConfig>(3, 6, std::move(rows), std::move(cols), std::move(vals), fixed_ncfg, true));
+   hashedSideInfo->setHashBuckets(3);
+   hashedSideInfo->setHashSeed(7);
+
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   config.addSideInfoConfig(0, hashedSideInfo);
+   config.setNumLatent(4);
+   config.setBurnin(20);
+   config.setNSamples(3);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setSavePrefix("cold_start_hashed");
+   config.setSaveExtension(".ddm");
+   config.setSaveFreq(1);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+
+   // two new rows, only the second item is hashed
+   std::vector<double> newDenseValues = { 0.5, 4 };
+   auto newDense = std::make_shared<MatrixConfig>(2, 1, std::move(newDenseValues), fixed_ncfg);
+   std::vector<std::uint32_t> newRows = { 0, 1, 1 };
+   std::vector<std::uint32_t> newCols = { 2, 0, 5 };
+   std::vector<double> newVals = { 1, 2, 1 };
+   auto newSparse = std::make_shared<MatrixConfig>(2, 6, std::move(newRows), std::move(newCols), std::move(newVals), fixed_ncfg, true);
+
+   PredictSession predictSession("cold_start_hashed-root.ini");
+
+   // the items are hashed separately, so they can not be passed as one matrix
+   REQUIRE_THROWS(predictSession.createSideInfo(0, newDense));
+
+   Eigen::MatrixXd mean, std;
+   predictSession.predict(0, predictSession.createSideInfo(0, { newDense, newSparse }), mean, std);
+
+   Eigen::MatrixXd F(2, 4);
+   F.leftCols(1) = matrix_utils::dense_to_eigen(*newDense);
+   F.rightCols(3) = Eigen::MatrixXd(matrix_utils::sparse_to_eigen(*matrix_utils::hash_columns(*newSparse, 3, 7)));
+
+   RootFile rootFile("cold_start_hashed-root.ini");
+   auto stepFiles = rootFile.openSampleStepFiles();
+   Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(2, 4);
+   for (auto sf : stepFiles)
+   {
+      Eigen::MatrixXd beta, mu, U1;
+      matrix_io::eigen::read_matrix(sf->getLinkMatrixFileName(0), beta);
+      matrix_io::eigen::read_matrix(sf->getMuFileName(0), mu);
+      matrix_io::eigen::read_matrix(sf->getModelFileName(1), U1);
+      REQUIRE(beta.cols() == 4);
+      Eigen::MatrixXd uhat = beta * F.transpose();
+      uhat.colwise() += mu.col(0);
+      expected += uhat.transpose() * U1 / stepFiles.size();
+   }
+
+   for (int i = 0; i < mean.rows(); i++)
+      for (int j = 0; j < mean.cols(); j++)
+         REQUIRE(mean(i, j) == Approx(expected(i, j)).epsilon(APPROX_EPSILON));
+
+   for (auto sf : stepFiles)
+      sf->remove(true, true, true);
+   std::remove(rootFile.getOptionsFileName().c_str());
+   std::remove(rootFile.getRootFileName().c_str());
+}
+
+TEST_CASE(
+   "fold-in of new rows against the saved samples"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior normal normal --num-latent 4 --burnin 50 --nsamples 5 --verbose 0 --seed 1234 --save-prefix fold_in --save-freq 1 --save-hyper"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+   config.setNumLatent(4);
+   config.setBurnin(50);
+   config.setNSamples(5);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setSavePrefix("fold_in");
+   config.setSaveExtension(".ddm");
+   config.setSaveFreq(1);
+   config.setSaveHyper(true);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+
+   // first new row is observed in all columns, second one only in column 0
+   Eigen::SparseMatrix<double> Y(2, 4);
+   std::vector<Eigen::Triplet<double> > triplets = { {0, 0, 1}, {0, 1, 2}, {0, 2, 3}, {0, 3, 4}, {1, 0, 9} };
+   Y.setFromTriplets(triplets.begin(), triplets.end());
+
+   RootFile rootFile("fold_in-root.ini");
+   auto stepFiles = rootFile.openSampleStepFiles();
+   REQUIRE(stepFiles.size() == 5);
+
+   PredictSession predictSession("fold_in-root.ini");
+
+   Eigen::MatrixXd mean, var;
+   predictSession.foldIn(0, Y, std::shared_ptr<ISideInfo>(), 1, mean, var);
+   REQUIRE(mean.rows() == 2);
+   REQUIRE(mean.cols() == 4);
+
+   // conditional mean (Lambda + alpha * V * V')^-1 * (Lambda * mu + alpha * V * y) averaged over the saved samples
+   const double alpha = fixed_ncfg.getPrecision();
+   Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(2, 4);
+   for (auto sf : stepFiles)
+   {
+      Eigen::MatrixXd mu, Lambda, V;
+      matrix_io::eigen::read_matrix(sf->getMuFileName(0), mu);
+      matrix_io::eigen::read_matrix(sf->getLambdaFileName(0), Lambda);
+      matrix_io::eigen::read_matrix(sf->getModelFileName(1), V);
+
+      for (int i = 0; i < Y.rows(); i++)
+      {
+         Eigen::MatrixXd MM = Lambda;
+         Eigen::VectorXd rr = Lambda * mu.col(0);
+         for (int j = 0; j < Y.cols(); j++)
+         {
+            if (Y.coeff(i, j) == 0)
+               continue;
+            MM += alpha * V.col(j) * V.col(j).transpose();
+            rr += alpha * Y.coeff(i, j) * V.col(j);
+         }
+         Eigen::VectorXd u = MM.llt().solve(rr);
+         expected.row(i) += u.transpose() * V / stepFiles.size();
+      }
+   }
+
+   // predictive variance includes the noise variance, the sampled means are within a few of its deviations
+   REQUIRE(var.minCoeff() >= 1.0 / alpha);
+   for (int i = 0; i < mean.rows(); i++)
+      for (int j = 0; j < mean.cols(); j++)
+         REQUIRE(std::abs(mean(i, j) - expected(i, j)) <= 3 * std::sqrt(var(i, j)));
+
+   // the noise precision of every sample is saved with the hyperparameters
+   for (auto sf : stepFiles)
+      REQUIRE(sf->getNoisePrecision() == Approx(alpha));
+
+   // without the saved Lambda of the mode there is no fold-in
+   std::remove(stepFiles.front()->getLambdaFileName(0).c_str());
+   REQUIRE_THROWS(predictSession.foldIn(0, Y, std::shared_ptr<ISideInfo>(), 1, mean, var));
+
+   for (auto sf : stepFiles)
+      sf->remove(true, true, true);
+   std::remove(rootFile.getOptionsFileName().c_str());
+   std::remove(rootFile.getRootFileName().c_str());
+}
+
+TEST_CASE(
+   "warm start with appended rows and columns"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau normal --side-info <row_side_info_dense_matrix> none --num-latent 4 --burnin 50 --nsamples 5 --verbose 0 --seed 1234 --save-prefix warm_start --save-freq -1"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   config.setNumLatent(4);
+   config.setBurnin(50);
+   config.setNSamples(5);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setSavePrefix("warm_start");
+   config.setSaveExtension(".ddm");
+   config.setSaveFreq(-1);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+
+   // the grown data set has one more row, with side info 2, and one more column
+   std::vector<std::uint32_t> rows = { 0, 0, 0, 0, 2, 2, 2, 2, 3, 3 };
+   std::vector<std::uint32_t> cols = { 0, 1, 2, 3, 0, 1, 2, 3, 0, 4 };
+   std::vector<double> vals = { 1, 2, 3, 4, 9, 10, 11, 12, 5, 6 };
+   std::vector<double> features = getRowSideInfoDenseMatrixConfig()->getValues();
+   features.push_back(2);
+
+   auto sideInfo = getRowSideInfoDenseConfig();
+   sideInfo->setSideInfo(std::make_shared<MatrixConfig>(4, 1, std::move(features), fixed_ncfg));
+
+   Config grownConfig;
+   grownConfig.setTrain(std::make_shared<MatrixConfig>(4, 5, std::move(rows), std::move(cols), std::move(vals), fixed_ncfg, true));
+   grownConfig.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   grownConfig.addSideInfoConfig(0, sideInfo);
+   grownConfig.setNumLatent(4);
+   grownConfig.setBurnin(2);
+   grownConfig.setNSamples(2);
+   grownConfig.setVerbose(false);
+   grownConfig.setRandomSeed(1234);
+   grownConfig.setWarmStart("warm_start-root.ini");
+
+   std::shared_ptr<ISession> grownSession = SessionFactory::create_session(grownConfig);
+   grownSession->init();
+
+   RootFile rootFile("warm_start-root.ini");
+   auto stepFile = rootFile.openLastStepFile();
+   Eigen::MatrixXd U0, U1, beta, mu;
+   matrix_io::eigen::read_matrix(stepFile->getModelFileName(0), U0);
+   matrix_io::eigen::read_matrix(stepFile->getModelFileName(1), U1);
+   matrix_io::eigen::read_matrix(stepFile->getLinkMatrixFileName(0), beta);
+   matrix_io::eigen::read_matrix(stepFile->getMuFileName(0), mu);
+
+   const Model& model = std::dynamic_pointer_cast<BaseSession>(grownSession)->model();
+
+   // known entities keep their latent vectors
+   REQUIRE(matrix_utils::equals(Eigen::MatrixXd(model.U(0).leftCols(3)), U0));
+   REQUIRE(matrix_utils::equals(Eigen::MatrixXd(model.U(1).leftCols(4)), U1));
+
+   // the new row starts at mu + beta * f, the new column at the mean of the others without a saved mu
+   Eigen::VectorXd newRow = mu.col(0) + beta.col(0) * 2;
+   Eigen::VectorXd newCol = U1.rowwise().mean();
+   for (int k = 0; k < 4; k++)
+   {
+      REQUIRE(model.U(0)(k, 3) == Approx(newRow(k)).epsilon(APPROX_EPSILON));
+      REQUIRE(model.U(1)(k, 4) == Approx(newCol(k)).epsilon(APPROX_EPSILON));
+   }
+
+   while (grownSession->step());
+
+   // with the hyperparameters of mode 1 saved, the new column starts at their mu
+   Eigen::MatrixXd mu1 = Eigen::MatrixXd::Constant(4, 1, 0.5);
+   matrix_io::eigen::write_matrix(stepFile->getMuFileName(1), mu1);
+   std::shared_ptr<ISession> hyperSession = SessionFactory::create_session(grownConfig);
+   hyperSession->init();
+   const Model& hyperModel = std::dynamic_pointer_cast<BaseSession>(hyperSession)->model();
+   for (int k = 0; k < 4; k++)
+      REQUIRE(hyperModel.U(1)(k, 4) == Approx(0.5).epsilon(APPROX_EPSILON));
+   std::remove(stepFile->getMuFileName(1).c_str());
+
+   // a model of another size can not be used
+   grownConfig.setNumLatent(8);
+   std::shared_ptr<ISession> wrongSession = SessionFactory::create_session(grownConfig);
+   REQUIRE_THROWS(wrongSession->init());
+
+   stepFile->remove(true, true, true);
+   std::remove(rootFile.getOptionsFileName().c_str());
+   std::remove(rootFile.getRootFileName().c_str());
+}
+
+TEST_CASE(
+   "als init fits the train data before sampling"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau normal --side-info <row_side_info_dense_matrix> none --num-latent 4 --burnin 10 --nsamples 10 --verbose 0 --seed 1234 --init-model als --als-sweeps 50 --als-reg 0.01"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   config.setNumLatent(4);
+   config.setBurnin(10);
+   config.setNSamples(10);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setModelInitType(ModelInitTypes::als);
+   config.setAlsSweeps(50);
+   config.setAlsReg(0.01);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->init();
+
+   // with little regularization the rank 4 model reproduces the train values
+   const Model& model = std::dynamic_pointer_cast<BaseSession>(session)->model();
+   auto train = getTrainSparseMatrixConfig();
+   for (std::uint64_t i = 0; i < train->getNNZ(); i++)
+   {
+      double pred = model.U(0).col(train->getRows()[i]).dot(model.U(1).col(train->getCols()[i]));
+      REQUIRE(pred == Approx(train->getValues()[i]).epsilon(0.01));
+   }
+
+   while (session->step());
+
+   // a zero regularization is rejected
+   config.setAlsReg(0);
+   REQUIRE_THROWS(SessionFactory::create_session(config));
+}
+
+TEST_CASE(
+   "coarse burnin on a subsample of the train data"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior normal normal --num-latent 4 --burnin 10 --nsamples 10 --verbose 0 --seed 1234 --coarse-burnin 5 --coarse-fraction 0.5"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+   config.setNumLatent(4);
+   config.setBurnin(10);
+   config.setNSamples(10);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setCoarseBurnin(5);
+   config.setCoarseFraction(0.5);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->init();
+
+   // the subsample masks the train matrix, its entries weigh for all of them
+   auto baseSession = std::dynamic_pointer_cast<BaseSession>(session);
+   auto& subsample = dynamic_cast<FoldMatrixData&>(baseSession->data());
+   const std::uint64_t nnz = config.getTrain()->getNNZ();
+   REQUIRE(subsample.nnz() > 0);
+   REQUIRE(subsample.nnz() <= nnz);
+   REQUIRE(subsample.nnz() * subsample.getWeight() == Approx(nnz));
+   const auto* Y = &subsample.Y();
+
+   for (int i = 0; i < 5; i++)
+   {
+      REQUIRE(dynamic_cast<FoldMatrixData*>(&baseSession->data()));
+      session->step();
+   }
+
+   // the rest of the run is on all train entries
+   REQUIRE(!dynamic_cast<FoldMatrixData*>(&baseSession->data()));
+   REQUIRE(baseSession->data().nnz() == nnz);
+   REQUIRE(&dynamic_cast<ScarceMatrixData&>(baseSession->data()).Y() == Y);
+
+   while (session->step());
+   REQUIRE(!std::isnan(session->getRmseAvg()));
+
+   // more coarse iterations than burnin are rejected
+   config.setCoarseBurnin(11);
+   REQUIRE_THROWS(SessionFactory::create_session(config));
+}
+
+TEST_CASE(
+   "sgld sampler on minibatches of the train data"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior normal normal --num-latent 2 --burnin 500 --nsamples 4000 --verbose 0 --seed 1234 --sampler sgld --sgld-batch-size 4"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+   config.setNumLatent(2);
+   config.setBurnin(500);
+   config.setNSamples(4000);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+
+   std::shared_ptr<ISession> gibbsSession = SessionFactory::create_session(config);
+   gibbsSession->run();
+
+   config.setSamplerType(SamplerTypes::sgld);
+   config.setSgldBatchSize(4);
+
+   std::shared_ptr<ISession> sgldSession = SessionFactory::create_session(config);
+   sgldSession->run();
+
+   // a noisier chain of the same posterior: the posterior means of the predictions agree
+   const auto& gibbsItems = *gibbsSession->getResult();
+   const auto& sgldItems = *sgldSession->getResult();
+   REQUIRE(sgldItems.size() == gibbsItems.size());
+   for (std::size_t i = 0; i < sgldItems.size(); i++)
+   {
+      REQUIRE(sgldItems[i].coords == gibbsItems[i].coords);
+      REQUIRE(std::abs(sgldItems[i].pred_avg - gibbsItems[i].pred_avg) < 0.2);
+   }
+
+   // only the normal priors have a gradient
+   config.setPriorTypes({PriorTypes::spikeandslab, PriorTypes::normal});
+   REQUIRE_THROWS(SessionFactory::create_session(config));
+
+   config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+   config.setSgldStep(1.5);
+   REQUIRE_THROWS(SessionFactory::create_session(config));
+
+   config.setSgldStep(0.5);
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   REQUIRE_THROWS(SessionFactory::create_session(config));
+}
+
+TEST_CASE(
+   "diagnostics end burnin and sampling early"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior normal normal --num-latent 4 --burnin 500 --nsamples 500 --verbose 0 --seed 1234 --auto-burnin --max-rhat 1.5 --target-ess 5"
+   , HIDE_VS_TESTS)
+{
+   // iid values are fully effective and both halves agree, a trend does not mix
+   std::mt19937 gen(1234);
+   std::normal_distribution<double> normal;
+   Diagnostics iid, trend;
+   for (int i = 0; i < 1000; i++)
+   {
+      iid.add(i, { normal(gen) });
+      trend.add(i, { normal(gen) + i * 0.01 });
+   }
+
+   REQUIRE(iid.ess(0, 1000) == Approx(1000).epsilon(0.2));
+   REQUIRE(iid.rhat(0, 1000) < 1.01);
+   REQUIRE(trend.ess(0, 1000) < 100);
+   REQUIRE(trend.rhat(0, 1000) > 1.5);
+   REQUIRE(std::isnan(iid.rhat(0, 2 * Diagnostics::MIN_HALF_LENGTH - 1)));
+
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+   config.setNumLatent(4);
+   config.setBurnin(500);
+   config.setNSamples(500);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setAutoBurnin(true);
+   config.setMaxRhat(1.5);
+   config.setTargetEss(5);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+
+   auto status = session->getStatus();
+   REQUIRE(status->phase == "Sample");
+   REQUIRE(status->phase_iter < 500);
+   REQUIRE(status->ess >= 5);
+
+   const auto& diagnostics = std::dynamic_pointer_cast<Session>(session)->getDiagnostics();
+   REQUIRE(diagnostics.getNumTraces() == 3);
+
+   // without the automatic modes or a csv status the traces are not recorded
+   Config plainConfig = config;
+   plainConfig.setAutoBurnin(false);
+   plainConfig.setTargetEss(0);
+   plainConfig.setBurnin(20);
+   plainConfig.setNSamples(20);
+   std::shared_ptr<ISession> plainSession = SessionFactory::create_session(plainConfig);
+   plainSession->run();
+   REQUIRE(std::dynamic_pointer_cast<Session>(plainSession)->getDiagnostics().getNumTraces() == 0);
+   REQUIRE(std::isnan(plainSession->getStatus()->ess));
+
+   // the automatic modes are rejected with checkpoints
+   config.setCheckpointFreq(10);
+   REQUIRE_THROWS(SessionFactory::create_session(config));
+}
+
+TEST_CASE(
+   "multiple chains in one process"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau normal --side-info <row_side_info_dense_matrix> none --num-latent 4 --burnin 50 --nsamples 50 --verbose 0 --seed 1234 --num-chains 3"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   config.setNumLatent(4);
+   config.setBurnin(50);
+   config.setNSamples(50);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   // chain 0 is compared draw for draw with a single session, the per-thread streams differ with more threads
+   config.setNumThreads(1);
+
+   std::shared_ptr<ISession> singleSession = SessionFactory::create_session(config);
+   singleSession->run();
+
+   config.setNumChains(3);
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+
+   auto multiSession = std::dynamic_pointer_cast<MultiChainSession>(session);
+   REQUIRE(multiSession);
+   REQUIRE(multiSession->getNumChains() == 3);
+
+   // the first chain uses the seed of the config, just like a single chain
+   REQUIRE(multiSession->getChain(0)->getRmseAvg() == Approx(singleSession->getRmseAvg()).epsilon(APPROX_EPSILON));
+   REQUIRE_RESULT_ITEMS(*multiSession->getChain(0)->getResult(), *singleSession->getResult());
+   REQUIRE(multiSession->getChain(1)->getRmseAvg() != multiSession->getChain(0)->getRmseAvg());
+
+   // the chains share the train matrix, not the noise model
+   auto& data0 = dynamic_cast<ScarceMatrixData&>(std::dynamic_pointer_cast<BaseSession>(multiSession->getChain(0))->data());
+   auto& data1 = dynamic_cast<ScarceMatrixData&>(std::dynamic_pointer_cast<BaseSession>(multiSession->getChain(1))->data());
+   REQUIRE(&data0.Y() == &data1.Y());
+   REQUIRE(&data0.noise() != &data1.noise());
+
+   // pooled predictions average the chains
+   auto pooled = multiSession->getResult();
+   REQUIRE(pooled->size() == singleSession->getResult()->size());
+   for (std::size_t k = 0; k < pooled->size(); k++)
+   {
+      double pred_avg = .0;
+      for (int c = 0; c < multiSession->getNumChains(); c++)
+         pred_avg += multiSession->getChain(c)->getResult()->at(k).pred_avg / multiSession->getNumChains();
+      REQUIRE(pooled->at(k).pred_avg == Approx(pred_avg).epsilon(APPROX_EPSILON));
+      REQUIRE(pooled->at(k).stds >= 0);
+   }
+}
+
+TEST_CASE(
+   "sweep over num_latent and beta_precision"
+   "--train <train_sparse_matrix> --test <test_sparse_matrix> --prior macau normal --side-info <row_side_info_dense_matrix> none --burnin 50 --nsamples 50 --verbose 0 --seed 1234"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setTest(getTestSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::macau, PriorTypes::normal});
+   config.addSideInfoConfig(0, getRowSideInfoDenseConfig());
+   config.setNumLatent(4);
+   config.setBurnin(50);
+   config.setNSamples(50);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   // the first point is compared draw for draw with a single session, the per-thread streams differ with more threads
+   config.setNumThreads(1);
+
+   SweepSession::Axes axes;
+   axes.push_back(std::make_pair(std::string("num_latent"), std::vector<std::string>({"4", "8"})));
+   axes.push_back(std::make_pair(std::string("beta_precision"), std::vector<std::string>({"10", "1"})));
+   SweepSession sweep(config, axes);
+
+   REQUIRE(sweep.getNumPoints() == 4);
+   REQUIRE(sweep.getPointValues(1) == std::vector<std::string>({"4", "1"}));
+   REQUIRE(sweep.getPointValues(2) == std::vector<std::string>({"8", "10"}));
+
+   // points share the side info matrix, not its noise
+   Config point = sweep.getPointConfig(3);
+   REQUIRE(point.getNumLatent() == 8);
+   auto baseSideInfo = config.getSideInfoConfigs(0).front()->getSideInfo();
+   auto pointSideInfo = point.getSideInfoConfigs(0).front()->getSideInfo();
+   REQUIRE(pointSideInfo->getDimsPtr() == baseSideInfo->getDimsPtr());
+   REQUIRE(pointSideInfo->getNoiseConfig().getPrecision() == Approx(1.0));
+   REQUIRE(baseSideInfo->getNoiseConfig().getPrecision() == Approx(SideInfoConfig::BETA_PRECISION_DEFAULT_VALUE));
+
+   std::stringstream table;
+   sweep.run(table);
+
+   REQUIRE(sweep.getResults().size() == 4);
+   std::string line;
+   int lines = 0;
+   while (std::getline(table, line))
+      lines++;
+   REQUIRE(lines == 5);
+
+   // the first point is the base config
+   std::shared_ptr<ISession> singleSession = SessionFactory::create_session(config);
+   singleSession->run();
+   REQUIRE(sweep.getResults().front().rmse_avg == Approx(singleSession->getRmseAvg()).epsilon(APPROX_EPSILON));
+
+   REQUIRE_THROWS(SweepSession(config, {std::make_pair(std::string("no_such_option"), std::vector<std::string>({"1"}))}));
+}
+
+TEST_CASE(
+   "cross-validation with masked folds"
+   "--train <train_sparse_matrix> --prior normal normal --num-latent 4 --burnin 50 --nsamples 50 --verbose 0 --seed 1234 --cv-folds 2"
+   , HIDE_VS_TESTS)
+{
+   Config config;
+   config.setTrain(getTrainSparseMatrixConfig());
+   config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+   config.setNumLatent(4);
+   config.setBurnin(50);
+   config.setNSamples(50);
+   config.setVerbose(false);
+   config.setRandomSeed(1234);
+   config.setCVFolds(2);
+   // fold 0 is compared draw for draw with a single session, the per-thread streams differ with more threads
+   config.setNumThreads(1);
+
+   std::shared_ptr<ISession> session = SessionFactory::create_session(config);
+   session->run();
+
+   auto cvSession = std::dynamic_pointer_cast<CrossValidationSession>(session);
+   REQUIRE(cvSession);
+   REQUIRE(cvSession->getNumFolds() == 2);
+
+   // every train entry is held out by exactly one fold
+   auto heldOut0 = cvSession->getFold(0)->getResult();
+   auto heldOut1 = cvSession->getFold(1)->getResult();
+   REQUIRE(heldOut0->size() + heldOut1->size() == config.getTrain()->getNNZ());
+   REQUIRE(cvSession->getResult()->size() == config.getTrain()->getNNZ());
+
+   // the folds mask the same train matrix
+   auto& data0 = dynamic_cast<FoldMatrixData&>(std::dynamic_pointer_cast<BaseSession>(cvSession->getFold(0))->data());
+   auto& data1 = dynamic_cast<FoldMatrixData&>(std::dynamic_pointer_cast<BaseSession>(cvSession->getFold(1))->data());
+   REQUIRE(&data0.Y() == &data1.Y());
+   REQUIRE(data0.nnz() == heldOut1->size());
+
+   // a fold samples the same model as a session on copies of its train and test entries
+   std::vector<std::uint32_t> trainRows, trainCols, testRows, testCols;
+   std::vector<double> trainVals, testVals;
+   auto train = std::dynamic_pointer_cast<MatrixConfig>(config.getTrain());
+   for (std::size_t i = 0; i < train->getNNZ(); i++)
+   {
+      std::uint32_t r = train->getRows()[i], c = train->getCols()[i];
+      bool held = std::any_of(heldOut0->begin(), heldOut0->end(), [r, c](const ResultItem& t) { return t.coords[0] == (int)r && t.coords[1] == (int)c; });
+      (held ? testRows : trainRows).push_back(r);
+      (held ? testCols : trainCols).push_back(c);
+      (held ? testVals : trainVals).push_back(train->getValues()[i]);
+   }
+
+   Config foldConfig = config;
+   foldConfig.setCVFolds(0);
+   foldConfig.setTrain(std::make_shared<MatrixConfig>(3, 4, std::move(trainRows), std::move(trainCols), std::move(trainVals), fixed_ncfg, true));
+   foldConfig.setTest(std::make_shared<MatrixConfig>(3, 4, std::move(testRows), std::move(testCols), std::move(testVals), fixed_ncfg, true));
+   foldConfig.setRandomSeed(1234 + 1000003);
+
+   std::shared_ptr<ISession> foldSession = SessionFactory::create_session(foldConfig);
+   foldSession->run();
+
+   REQUIRE(cvSession->getFold(0)->getRmseAvg() == Approx(foldSession->getRmseAvg()).epsilon(APPROX_EPSILON));
+
+   // aggregate metrics cover both folds
+   double se = .0;
+   for (const auto& t : *cvSession->getResult())
+      se += std::pow(t.val - t.pred_avg, 2);
+   REQUIRE(cvSession->getRmseAvg() == Approx(std::sqrt(se / config.getTrain()->getNNZ())).epsilon(APPROX_EPSILON));
+
+   config.setTest(getTestSparseMatrixConfig());
+   REQUIRE_THROWS(SessionFactory::create_session(config));
+}
+
 #ifdef TEST_RANDOM
 //
 //      train: dense matrix
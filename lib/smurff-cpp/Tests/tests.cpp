@@ -75,6 +75,19 @@ TEST_CASE( "mvnormal/rgamma", "generaring random gamma variable" ) {
   REQUIRE( g > 0 );
 }
 
+TEST_CASE( "mvnormal/private_bmrng", "private draws leave the shared stream untouched" ) {
+  init_bmrng(1234);
+  double expected = rand_unif();
+
+  init_bmrng(1234);
+  init_private_bmrng(4321);
+  use_private_bmrng(true);
+  double private_draw = rand_unif();
+  use_private_bmrng(false);
+  REQUIRE( rand_unif() == expected );
+  REQUIRE( private_draw != expected );
+}
+
 TEST_CASE( "latentprior/sample_beta_precision", "sampling beta precision from gamma distribution" ) {
   init_bmrng(1234);
   Eigen::MatrixXd beta(2, 3), Lambda_u(2, 2);
@@ -9,3 +9,5 @@ cdef extern from "<SmurffCpp/Configs/SideInfoConfig.h>" namespace "smurff":
         void setSideInfo(shared_ptr[MatrixConfig] value)
         void setTol(double value)
         void setDirect(bool value)
+        void setHashBuckets(int value)
+        void setHashSeed(int value)
@@ -34,6 +34,25 @@ def read_file(cp, file_name):
         except AttributeError:
             cp.readfp(f, file_name)
 
+def feature_hash(cols, nbuckets, seed):
+    """Bucket and sign of feature ids, the same mapping as smurff::matrix_utils::feature_hash"""
+    with np.errstate(over='ignore'):
+        h = (np.uint64(seed) << np.uint64(32)) | np.asarray(cols).astype(np.uint64)
+        h = h + np.uint64(0x9E3779B97F4A7C15)
+        h = (h ^ (h >> np.uint64(30))) * np.uint64(0xBF58476D1CE4E5B9)
+        h = (h ^ (h >> np.uint64(27))) * np.uint64(0x94D049BB133111EB)
+        h = h ^ (h >> np.uint64(31))
+
+    bucket = (h & np.uint64(0xFFFFFFFF)) % np.uint64(nbuckets)
+    sign = np.where(h >> np.uint64(63), -1.0, 1.0)
+    return bucket.astype(np.int64), sign
+
+def hash_columns(X, nbuckets, seed):
+    """Hashes the columns of side info X into nbuckets columns, colliding entries are summed"""
+    X = sparse.coo_matrix(X)
+    bucket, sign = feature_hash(X.col, nbuckets, seed)
+    return sparse.csr_matrix((X.data * sign, (X.row, bucket)), shape=(X.shape[0], nbuckets))
+
 class OptionsFile(ConfigParser):
     def __init__(self, file_name):
         ConfigParser.__init__(self) 
@@ -138,6 +157,21 @@ class PredictSession:
         options = OptionsFile(cp["options"])
 
         session = cls(options.getint("global", "num_priors"))
+
+        # side info that was hashed during training, is hashed the same way for prediction,
+        # every side info item of a mode with its own options
+        for mode in range(session.nmodes):
+            item = 0
+            while options.has_section("macau_prior_config_item_%d_%d" % (mode, item)):
+                section = "macau_prior_config_item_%d_%d" % (mode, item)
+                hashing = None
+                if options.has_option(section, "hash_buckets"):
+                    nbuckets = options.getint(section, "hash_buckets")
+                    if nbuckets > 0:
+                        hashing = (nbuckets, options.getint(section, "hash_seed"))
+                session.feature_hashing[mode].append(hashing)
+                item += 1
+
         for step_name, step_file in cp.items():
             if (step_name.startswith("sample_step")):
                 iter = int(step_name[len("sample_step_"):])
@@ -151,6 +185,7 @@ class PredictSession:
         assert nmodes == 2
         self.nmodes = nmodes
         self.samples = []
+        self.feature_hashing = [ [] for _ in range(nmodes) ]
 
     def add_sample(self, sample):
         self.samples.append(sample)
@@ -165,8 +200,42 @@ class PredictSession:
         return self.samples[0].beta_shape()
 
     def predict(self, coords_or_sideinfo = None):
+        if coords_or_sideinfo is not None:
+            coords_or_sideinfo = [ self.hash_sideinfo(c, m) for c, m in zip(coords_or_sideinfo, range(self.nmodes)) ]
+
         return np.stack([ sample.predict(coords_or_sideinfo) for sample in self.samples ])
 
+    def hash_sideinfo(self, c, mode):
+        """Side info c of mode is either one matrix, or a list with one matrix per side info item.
+           Every item is hashed with its own options, the result is their horizontal concatenation."""
+        items = self.feature_hashing[mode]
+        hashed = any(h is not None for h in items)
+
+        if isinstance(c, (list, tuple)):
+            if len(c) != max(len(items), 1):
+                raise ValueError("The model has %d side info items in mode %d, got %d side info matrices" % (len(items), mode, len(c)))
+            blocks = [ self.hash_item(x, h) for x, h in zip(c, items if items else [None]) ]
+            if len(blocks) == 1:
+                return blocks[0]
+            return sparse.hstack([ sparse.csr_matrix(b) for b in blocks ]).tocsr()
+
+        if not hashed or not hasattr(c, "shape"):
+            return c
+
+        # one matrix can only stand for the concatenation of the items when none of them is hashed
+        if len(items) > 1:
+            raise ValueError("The side info items of mode %d are hashed separately, pass a list with one matrix per item" % mode)
+
+        return self.hash_item(c, items[0])
+
+    @staticmethod
+    def hash_item(c, hashing):
+        if hashing is None:
+            return c
+
+        nbuckets, seed = hashing
+        return hash_columns(c if len(c.shape) == 2 else c.reshape(1, -1), nbuckets, seed)
+
     def predict_all(self):
         return self.predict()
     
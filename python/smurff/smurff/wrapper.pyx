@@ -100,7 +100,7 @@ cdef MatrixConfig* prepare_dense_matrix(X, NoiseConfig noise_config) except +:
     cdef MatrixConfig* matrix_config_ptr = new MatrixConfig(<uint64_t>(X.shape[0]), <uint64_t>(X.shape[1]), vals_vector_shared_ptr, noise_config)
     return matrix_config_ptr
 
-cdef shared_ptr[SideInfoConfig] prepare_sideinfo(side_info, NoiseConfig noise_config, tol, direct) except +:
+cdef shared_ptr[SideInfoConfig] prepare_sideinfo(side_info, NoiseConfig noise_config, tol, direct, hash_buckets, hash_seed) except +:
     if isinstance(side_info, SPARSE_MATRIX_TYPES):
         side_info_config_matrix = prepare_sparse_matrix(side_info, noise_config, False)
     elif isinstance(side_info, DENSE_MATRIX_TYPES) and len(side_info.shape) == 2:
@@ -113,6 +113,8 @@ cdef shared_ptr[SideInfoConfig] prepare_sideinfo(side_info, NoiseConfig noise_co
     side_info_config_ptr.get().setSideInfo(shared_ptr[MatrixConfig](side_info_config_matrix))
     side_info_config_ptr.get().setTol(tol)
     side_info_config_ptr.get().setDirect(direct)
+    side_info_config_ptr.get().setHashBuckets(hash_buckets)
+    side_info_config_ptr.get().setHashSeed(hash_seed)
     return side_info_config_ptr
 
 cdef TensorConfig* prepare_dense_tensor(tensor, NoiseConfig noise_config) except +:
@@ -301,9 +303,9 @@ cdef class TrainSession:
         if Ytest is not None:
             self.config.setTest(test)
 
-    def addSideInfo(self, mode, Y, noise = PyNoiseConfig(), tol = 1e-6, direct = False):
+    def addSideInfo(self, mode, Y, noise = PyNoiseConfig(), tol = 1e-6, direct = False, hash_buckets = 0, hash_seed = 0):
         self.noise_config = prepare_noise_config(noise)
-        self.config.addSideInfoConfig(mode, prepare_sideinfo(Y, self.noise_config, tol, direct))
+        self.config.addSideInfoConfig(mode, prepare_sideinfo(Y, self.noise_config, tol, direct, hash_buckets, hash_seed))
 
     def addData(self, pos, ad, is_scarce = False, noise = PyNoiseConfig()):
         self.noise_config = prepare_noise_config(noise)